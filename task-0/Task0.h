@@ -1,5 +1,21 @@
 #include "rational/ClassRationalNumber.h"
 #include "complex/ClassComplex.h"
+#include "complex/Complex_array.hpp"
 #include "matrix/ClassMatrix.h"
+#include "matrix/Matrix_power.hpp"
+#include "matrix/Matrix_reordering.hpp"
+#include "matrix/Matrix_structured.hpp"
+#include "matrix/Matrix_bsr.hpp"
+#include "matrix/Matrix_assembly.hpp"
+#include "matrix/Matrix_builder.hpp"
 #include "parsers/Parser.h"
-#include "vector/ClassVector.hpp"
\ No newline at end of file
+#include "parsers/Matrix_market.hpp"
+#include "parallel/Parallel.hpp"
+#include "stats/Stats.hpp"
+#include "vector/ClassVector.hpp"
+#include "vector/Vector_kernels.hpp"
+#include "solvers/Iterative_solvers.hpp"
+#include "solvers/Eigen_solvers.hpp"
+#include "decompositions/Bareiss.hpp"
+#include "decompositions/Sparse_LU.hpp"
+#include "modular/Modular_engine.hpp"
\ No newline at end of file
@@ -0,0 +1,240 @@
+/**
+ * @file Task0_benchmarks.cpp
+ * @brief Google Benchmark suite for numeric types and sparse matrices
+ *
+ * Run with JSON output (target run_benchmarks does it) and compare two commits with
+ * compare.py from Google Benchmark tools:
+ *   Task0_benchmarks --benchmark_out=new.json --benchmark_out_format=json
+ *   compare.py benchmarks old.json new.json
+ * Inputs are generated with fixed seeds, so runs of different commits measure the same work.
+ */
+
+#include <string>
+#include <random>
+#include <cstdio>
+#include <filesystem>
+
+#include <benchmark/benchmark.h>
+
+#include "../rational/ClassRationalNumber.h"
+#include "../complex/ClassComplex.h"
+#include "../matrix/ClassMatrix.h"
+
+// Inputs
+//////////////////////////////////
+
+// decimal number of given length without leading zero
+std::string random_digits(size_t length, std::mt19937& gen){
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::string res(1, char('1' + digit(gen) % 9));
+    while (res.size() < length){
+        res.push_back(char('0' + digit(gen)));
+    }
+    return res;
+}
+
+Rational_number random_rational(size_t digits, std::mt19937& gen){
+    return Rational_number(random_digits(digits, gen), random_digits(digits, gen));
+}
+
+// rows x columns matrix with density * rows * columns values at random positions
+template<class T, class Gen>
+Matrix<T> random_matrix(int rows, int columns, double density, Gen value, unsigned seed = 42){
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> row(0, rows - 1), column(0, columns - 1);
+    matr_vals<T> vals;
+    size_t count = static_cast<size_t>(density * rows * columns);
+    vals.reserve(count);
+    while (vals.size() < count){
+        vals[{row(gen), column(gen)}] = value(gen);
+    }
+    return Matrix<T>(rows, columns, vals);
+}
+
+Matrix<double> random_double_matrix(int n, double density, unsigned seed = 42){
+    std::uniform_real_distribution<double> dist(0.5, 2.0);
+    return random_matrix<double>(n, n, density, [&dist](std::mt19937& gen){ return dist(gen); }, seed);
+}
+
+Matrix<Rational_number> random_rational_matrix(int n, double density){
+    std::uniform_int_distribution<long> dist(1, 1000);
+    return random_matrix<Rational_number>(n, n, density, [&dist](std::mt19937& gen){
+        return Rational_number(dist(gen), dist(gen));
+    });
+}
+
+// density in per mille is benchmark argument (integer)
+double density_arg(const benchmark::State& state){
+    return state.range(1) / 1000.0;
+}
+
+//////////////////////////////////
+
+// Rational_number (argument: number of digits of numerator and denominator)
+//////////////////////////////////
+
+static void BM_Rational_add(benchmark::State& state){
+    std::mt19937 gen(1);
+    Rational_number a = random_rational(state.range(0), gen), b = random_rational(state.range(0), gen);
+    for (auto _ : state){
+        benchmark::DoNotOptimize(a + b);
+    }
+}
+BENCHMARK(BM_Rational_add)->RangeMultiplier(4)->Range(4, 64);
+
+static void BM_Rational_mul(benchmark::State& state){
+    std::mt19937 gen(2);
+    Rational_number a = random_rational(state.range(0), gen), b = random_rational(state.range(0), gen);
+    for (auto _ : state){
+        benchmark::DoNotOptimize(a * b);
+    }
+}
+BENCHMARK(BM_Rational_mul)->RangeMultiplier(4)->Range(4, 64);
+
+// reduction of fraction with large common factor: gcd of numerator and denominator
+static void BM_Rational_gcd(benchmark::State& state){
+    std::mt19937 gen(3);
+    std::string common = random_digits(state.range(0), gen);
+    std::string num = (Rational_number(common) * Rational_number(random_digits(state.range(0), gen))).get_numerator().to_string();
+    std::string den = (Rational_number(common) * Rational_number(random_digits(state.range(0), gen))).get_numerator().to_string();
+    // "<digits/1>" -> digits
+    num = num.substr(1, num.find('/') - 1);
+    den = den.substr(1, den.find('/') - 1);
+    for (auto _ : state){
+        benchmark::DoNotOptimize(Rational_number(num, den));
+    }
+}
+BENCHMARK(BM_Rational_gcd)->RangeMultiplier(4)->Range(4, 64);
+
+//////////////////////////////////
+
+// Complex_number
+//////////////////////////////////
+
+template<class Op>
+static void BM_Complex_double(benchmark::State& state, Op op){
+    Complex_number<> a(1.25, -0.5), b(0.75, 2.0);
+    for (auto _ : state){
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(op(a, b));
+    }
+}
+BENCHMARK_CAPTURE(BM_Complex_double, add, [](const auto& a, const auto& b){ return a + b; });
+BENCHMARK_CAPTURE(BM_Complex_double, mul, [](const auto& a, const auto& b){ return a * b; });
+BENCHMARK_CAPTURE(BM_Complex_double, div, [](const auto& a, const auto& b){ return a / b; });
+
+template<class Op>
+static void BM_Complex_rational(benchmark::State& state, Op op){
+    Complex_number<Rational_number> a(Rational_number(5, 3), Rational_number(-7, 2));
+    Complex_number<Rational_number> b(Rational_number(11, 13), Rational_number(2, 9));
+    for (auto _ : state){
+        benchmark::DoNotOptimize(op(a, b));
+    }
+}
+BENCHMARK_CAPTURE(BM_Complex_rational, add, [](const auto& a, const auto& b){ return a + b; });
+BENCHMARK_CAPTURE(BM_Complex_rational, mul, [](const auto& a, const auto& b){ return a * b; });
+BENCHMARK_CAPTURE(BM_Complex_rational, div, [](const auto& a, const auto& b){ return a / b; });
+
+//////////////////////////////////
+
+// Matrix<double> (arguments: size, density in per mille)
+//////////////////////////////////
+
+// 5% of 1000 x 1000 is skipped: product alone takes more than a minute
+static void matrix_args(benchmark::internal::Benchmark* bench){
+    for (int n : {100, 400, 1000}){
+        for (int density : {1, 10, 50}){
+            if (n * density <= 400 * 50) bench->Args({n, density});
+        }
+    }
+}
+
+static void BM_Matrix_add(benchmark::State& state){
+    Matrix<double> a = random_double_matrix(state.range(0), density_arg(state), 1);
+    Matrix<double> b = random_double_matrix(state.range(0), density_arg(state), 2);
+    for (auto _ : state){
+        Matrix<double> c(a + b);
+        benchmark::DoNotOptimize(c);
+    }
+    state.counters["nnz"] = a.get_size();
+}
+BENCHMARK(BM_Matrix_add)->Apply(matrix_args)->Unit(benchmark::kMicrosecond);
+
+static void BM_Matrix_mul(benchmark::State& state){
+    Matrix<double> a = random_double_matrix(state.range(0), density_arg(state), 1);
+    Matrix<double> b = random_double_matrix(state.range(0), density_arg(state), 2);
+    for (auto _ : state){
+        Matrix<double> c(a * b);
+        benchmark::DoNotOptimize(c);
+    }
+    state.counters["nnz"] = a.get_size();
+}
+BENCHMARK(BM_Matrix_mul)->Apply(matrix_args)->Unit(benchmark::kMicrosecond);
+
+static void BM_Matrix_transpose(benchmark::State& state){
+    Matrix<double> a = random_double_matrix(state.range(0), density_arg(state));
+    for (auto _ : state){
+        benchmark::DoNotOptimize(~a);
+    }
+    state.counters["nnz"] = a.get_size();
+}
+BENCHMARK(BM_Matrix_transpose)->Apply(matrix_args)->Unit(benchmark::kMicrosecond);
+
+// row, column and top-left quarter of matrix
+static void BM_Matrix_slice(benchmark::State& state){
+    int n = state.range(0);
+    Matrix<double> a = random_double_matrix(n, density_arg(state));
+    for (auto _ : state){
+        Matrix<double> row(a[Matrix_row_coord(n / 2)]);
+        Matrix<double> column(a[Matrix_column_coord(n / 2)]);
+        Matrix<double> quarter(a[Matrix_coords({0, 0}, {n / 2 - 1, n / 2 - 1})]);
+        benchmark::DoNotOptimize(row);
+        benchmark::DoNotOptimize(column);
+        benchmark::DoNotOptimize(quarter);
+    }
+}
+BENCHMARK(BM_Matrix_slice)->Apply(matrix_args)->Unit(benchmark::kMicrosecond);
+
+//////////////////////////////////
+
+// Files (Matrix<Rational_number>, arguments: size, density in per mille)
+//////////////////////////////////
+
+static void file_args(benchmark::internal::Benchmark* bench){
+    for (int n : {100, 400}){
+        bench->Args({n, 10});
+        bench->Args({n, 100});
+    }
+}
+
+std::string bench_file_path(){
+    return (std::filesystem::temp_directory_path() / "task0_benchmark_matrix.txt").string();
+}
+
+static void BM_Matrix_to_file(benchmark::State& state){
+    Matrix<Rational_number> a = random_rational_matrix(state.range(0), density_arg(state));
+    std::string path = bench_file_path();
+    for (auto _ : state){
+        a.to_file(path.c_str());
+    }
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_Matrix_to_file)->Apply(file_args)->Unit(benchmark::kMillisecond);
+
+static void BM_Matrix_parse(benchmark::State& state){
+    std::string path = bench_file_path();
+    random_rational_matrix(state.range(0), density_arg(state)).to_file(path.c_str());
+    for (auto _ : state){
+        Matrix<Rational_number> a(path.c_str());
+        benchmark::DoNotOptimize(a);
+    }
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_Matrix_parse)->Apply(file_args)->Unit(benchmark::kMillisecond);
+
+//////////////////////////////////
+
+BENCHMARK_MAIN();
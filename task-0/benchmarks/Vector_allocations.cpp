@@ -0,0 +1,91 @@
+/**
+ * @file Vector_allocations.cpp
+ * @brief Heap allocations and time of copying vs in-place Vector arithmetic
+ *
+ * Vector<double> of size 1M with 10% of non-zeros (TREE storage) and filled vector
+ * (DENSE storage). Every operation is run once, allocations are counted by global operator new.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <chrono>
+#include <utility>
+
+#include "../vector/ClassVector.hpp"
+
+static size_t allocations = 0;
+
+// Replacements are kept out of line: GCC would inline free() into delete expressions
+// and report it as mismatched with operator new (-Wmismatched-new-delete).
+// Array and sized forms are replaced as well, so every new has its own delete.
+#if defined(__GNUC__)
+#define _NOINLINE __attribute__((noinline))
+#else
+#define _NOINLINE
+#endif
+
+_NOINLINE void* operator new(size_t size){
+    allocations++;
+    if (void* ptr = std::malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+_NOINLINE void* operator new[](size_t size){
+    return operator new(size);
+}
+
+_NOINLINE void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+
+_NOINLINE void operator delete(void* ptr, size_t) noexcept{
+    operator delete(ptr);
+}
+
+_NOINLINE void operator delete[](void* ptr) noexcept{
+    operator delete(ptr);
+}
+
+_NOINLINE void operator delete[](void* ptr, size_t) noexcept{
+    operator delete(ptr);
+}
+
+template<class Op>
+void measure(const char* name, Op op){
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    op();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-36s %10zu allocations %10.2f ms\n", name, allocations - before, ms);
+}
+
+Vector<double> make_vector(int size, int step, double shift){
+    vect_vals<double> vals;
+    for (int i = 0; i < size; i += step){
+        vals.emplace_hint(vals.end(), i, 1.0 + shift + i % 7);
+    }
+    return Vector<double>(size, vals);
+}
+
+int main(){
+    const int size = 1000000;
+    for (int step : {10, 1}){
+        Vector<double> v = make_vector(size, step, 0);
+        Vector<double> w = make_vector(size, step, 0.5);
+        std::printf("\nsize %d, non-zeros %d, storage %s\n", size, v.get_size(),
+                    v.get_storage() == Vector_storage::DENSE ? "DENSE" : "TREE");
+
+        measure("v = v + w", [&]{ v = v + w; });
+        measure("v += w", [&]{ v += w; });
+        measure("v = v - w * 0.5", [&]{ v = v - w * 0.5; });
+        measure("v -= w * 0.5", [&]{ v -= w * 0.5; });
+        measure("v = v * 2.0", [&]{ v = v * 2.0; });
+        measure("v *= 2.0", [&]{ v *= 2.0; });
+        measure("v = v / 2.0", [&]{ v = v / 2.0; });
+        measure("v /= 2.0", [&]{ v /= 2.0; });
+        measure("Vector u(v + 1.0)", [&]{ Vector<double> u(v + 1.0); });
+        measure("Vector u(std::move(v) + 1.0)", [&]{ Vector<double> u(std::move(v) + 1.0); v = std::move(u); });
+    }
+    return 0;
+}
@@ -7,6 +7,8 @@
 #define __ClassComplex_H__
 
 #include <ostream>
+#include <cmath>
+#include <type_traits>
 #include "../rational/ClassRationalNumber.h"
 
 template <class R = double, class T = R>
@@ -18,10 +20,64 @@ class Complex_number;
 template <class R = double, class T = R>
 std::ostream& operator<<(std::ostream &os, const Complex_number<R, T>& n);
 
+// Helpers of constexpr Complex_number
+///////////////////////////////////////////////////////////////////////
+
+// U(x) with exceptions of non-arithmetic types reported as Bad_construct
+template<class U, class V>
+U _complex_cast_checked(const V& x, const char* error){
+    try{
+        return static_cast<U>(x);
+    } catch(...){
+        throw Bad_construct(error);
+    }
+}
+
+// try-block is not allowed in constexpr function (C++17), so arithmetic types are cast directly
+template<class U, class V>
+constexpr U _complex_cast(const V& x, const char* error){
+    if constexpr (std::is_arithmetic<U>::value && std::is_arithmetic<V>::value){
+        return static_cast<U>(x);
+    } else {
+        return _complex_cast_checked<U>(x, error);
+    }
+}
+
+// a * b + c, rounded once for float and double if FMA instruction is available
+// (GCC folds __builtin_fma and __builtin_fmaf in constexpr), long double is not fused
+template<class U>
+constexpr U _fused_mul_add(const U& a, const U& b, const U& c){
+#if defined(__GNUC__) && !defined(__clang__)
+#ifdef __FP_FAST_FMA
+    if constexpr (std::is_same<U, double>::value){
+        return __builtin_fma(a, b, c);
+    }
+#endif
+#ifdef __FP_FAST_FMAF
+    if constexpr (std::is_same<U, float>::value){
+        return __builtin_fmaf(a, b, c);
+    }
+#endif
+#endif
+    return a * b + c;
+}
+
+template<class U>
+constexpr U _complex_abs(const U& x){
+    return x < U(0) ? -x : x;
+}
+
+///////////////////////////////////////////////////////////////////////
+
 /**
  * @brief Class to store complex numbers and perform operation with them.
  * 
  * R and T must support constructors with parameter 0.
+ * Arithmetic and comparisons are constexpr for arithmetic R and T, Complex_number<double>
+ * is trivially copyable pair of doubles (no user-defined copy or destructor), so arrays of it
+ * are copied by memcpy and read by SIMD kernels as interleaved doubles.
+ * For floating R == T multiplication uses FMA (if available) and division uses Smith's algorithm
+ * (no overflow of |rhs|^2), without -ffast-math.
  * Comparison is carried out on the basis of the squares of the modules of numbers.
  * Operations where left operand in not Complex_number are forbiden.
  * 
@@ -40,7 +96,7 @@ public:
      * R(0) and T(0) are called
      * @return 0 as complex number
      */
-    Complex_number();
+    constexpr Complex_number();
 
     /**
      * @brief Construct a new Complex_number object
@@ -48,7 +104,7 @@ public:
      * "Make complex number out of real": denominator is 0
      * @param x - real part
      */
-    Complex_number(R x);
+    constexpr Complex_number(R x);
 
     /**
      * @brief Construct a new Complex_number object
@@ -56,7 +112,7 @@ public:
      * @param x - real part
      * @param y - imaginary part
      */
-    Complex_number(R x, T y);
+    constexpr Complex_number(R x, T y);
 
     /**
      * @brief Copy constructor for Complex_number
@@ -66,7 +122,7 @@ public:
      * @tparam V - type of other.imag, casted to T
      */
     template<class U, class V>
-    Complex_number(const Complex_number<U, V>& other);
+    constexpr Complex_number(const Complex_number<U, V>& other);
 
 
     /**
@@ -75,7 +131,7 @@ public:
      * Return type is R in assumption that type R is "wider" than type T
      * @return R - square of module
      */
-    R module_square() const;   // compute module (radius-vector) 
+    constexpr R module_square() const;   // compute module (radius-vector) 
 
 
     /**
@@ -87,7 +143,7 @@ public:
      * @return Complex_number& 
      */
     template<class U, class V>
-    Complex_number& operator=(const Complex_number<U, V>& other);
+    constexpr Complex_number& operator=(const Complex_number<U, V>& other);
 
 
     /**
@@ -95,14 +151,14 @@ public:
      * 
      * @return R - real part
      */
-    R get_real() const;
+    constexpr R get_real() const;
 
     /**
      * @brief Get the imaginagy imag
      * 
      * @return T - imag part
      */
-    T get_imag() const;
+    constexpr T get_imag() const;
 
 
     /**
@@ -129,7 +185,7 @@ public:
      * @param rhs - right operand
      * @return bool
      */
-    bool operator==(const Complex_number& rhs) const;
+    constexpr bool operator==(const Complex_number& rhs) const;
 
     /**
      * @brief Check if this object is less than rhs (in term of modules)
@@ -138,7 +194,7 @@ public:
      * @param rhs - right operand
      * @return bool
      */
-    bool operator<(const Complex_number& rhs) const;
+    constexpr bool operator<(const Complex_number& rhs) const;
 
     /**
      * @brief Check if this object is not equal to rhs
@@ -147,7 +203,7 @@ public:
      * @param rhs - right operand
      * @return bool
      */
-    bool operator!=(const Complex_number& rhs) const;
+    constexpr bool operator!=(const Complex_number& rhs) const;
 
     /**
      * @brief Check if this object is less or equal than rhs (in term of modules)
@@ -156,7 +212,7 @@ public:
      * @param rhs - right operand
      * @return bool
      */
-    bool operator<=(const Complex_number& rhs) const;
+    constexpr bool operator<=(const Complex_number& rhs) const;
 
     /**
      * @brief Check if this object is greater than rhs (in term of modules)
@@ -165,7 +221,7 @@ public:
      * @param rhs - right operand
      * @return bool
      */
-    bool operator>(const Complex_number& rhs) const;
+    constexpr bool operator>(const Complex_number& rhs) const;
 
     /**
      * @brief Check if this object is greater or equal to rhs (in term of modules)
@@ -174,7 +230,7 @@ public:
      * @param rhs - right operand
      * @return bool
      */
-    bool operator>=(const Complex_number& rhs) const;
+    constexpr bool operator>=(const Complex_number& rhs) const;
 
 
     /**
@@ -184,7 +240,7 @@ public:
      * @param rhs right operand
      * @return return type of left operand
      */
-    Complex_number operator+(const Complex_number& rhs) const;
+    constexpr Complex_number operator+(const Complex_number& rhs) const;
 
     /**
      * @brief Substraction of two complex numbers (this - rhs)
@@ -193,7 +249,7 @@ public:
      * @param rhs right operand
      * @return return type of left operand
      */
-    Complex_number operator-(const Complex_number& rhs) const;
+    constexpr Complex_number operator-(const Complex_number& rhs) const;
 
     /**
      * @brief Product of two complex numbers (this * rhs)
@@ -202,7 +258,7 @@ public:
      * @param rhs right operand
      * @return return type of left operand
      */
-    Complex_number operator*(const Complex_number& rhs) const;
+    constexpr Complex_number operator*(const Complex_number& rhs) const;
 
     /**
      * @brief Division two complex numbers (this / rhs)
@@ -212,7 +268,7 @@ public:
      * @return return type of left operand
      * @throw int Zero_division if rhs is zero
      */
-    Complex_number operator/(const Complex_number& rhs) const;
+    constexpr Complex_number operator/(const Complex_number& rhs) const;
 
     
     /**
@@ -221,7 +277,7 @@ public:
      * @param rhs value to add
      * @return Complex_number& 
      */
-    Complex_number& operator+=(const Complex_number& rhs);
+    constexpr Complex_number& operator+=(const Complex_number& rhs);
 
     /**
      * @brief Assignment operator -
@@ -229,7 +285,7 @@ public:
      * @param rhs value to substract
      * @return Complex_number& 
      */
-    Complex_number& operator-=(const Complex_number& rhs);
+    constexpr Complex_number& operator-=(const Complex_number& rhs);
 
     /**
      * @brief Assignment operator *
@@ -237,7 +293,7 @@ public:
      * @param rhs value to product on
      * @return Complex_number& 
      */
-    Complex_number& operator*=(const Complex_number& rhs);
+    constexpr Complex_number& operator*=(const Complex_number& rhs);
 
     /**
      * @brief Assignment operator /
@@ -247,26 +303,26 @@ public:
      * 
      * @throw Zero_division if rhs is zero;
      */
-    Complex_number& operator/=(const Complex_number& rhs);
+    constexpr Complex_number& operator/=(const Complex_number& rhs);
 
 
     /// @brief unar +
-    Complex_number operator+() const;
+    constexpr Complex_number operator+() const;
     
     /// @brief unar -
-    Complex_number operator-() const;
+    constexpr Complex_number operator-() const;
 
     /// @brief prefix increment (+(1,0))
-    Complex_number operator++();
+    constexpr Complex_number operator++();
 
     /// @brief  postfix increment(+(1,0))
-    Complex_number operator++(int);
+    constexpr Complex_number operator++(int);
 
     /// @brief prefix decrement (-(1,0))
-    Complex_number operator--();
+    constexpr Complex_number operator--();
 
     /// @brief postfix decrement (-(1,0)) 
-    Complex_number operator--(int);
+    constexpr Complex_number operator--(int);
 
 
     /**
@@ -315,32 +371,22 @@ public:
 ///////////////////////////////////////////////////////////////////////
 
 template <class R, class T>
-Complex_number<R, T>::Complex_number(){
-    try{
-        real = R((long) 0);
-        imag = T((long) 0);
-    } catch(...){
-        throw Bad_construct("Bad_construct: error during processing real(0) or imag(0), check types");
-    }
-}
+constexpr Complex_number<R, T>::Complex_number():
+    real(_complex_cast<R>((long) 0, "Bad_construct: error during processing real(0) or imag(0), check types")),
+    imag(_complex_cast<T>((long) 0, "Bad_construct: error during processing real(0) or imag(0), check types")){}
 
 template <class R, class T>
-Complex_number<R, T>::Complex_number(R x): real(x), imag((long) 0){};
+constexpr Complex_number<R, T>::Complex_number(R x): real(x), imag((long) 0){};
 
 template <class R, class T>
-Complex_number<R, T>::Complex_number(R x, T y): real(x), imag(y){};
+constexpr Complex_number<R, T>::Complex_number(R x, T y): real(x), imag(y){};
 
 
 template <class R, class T>
 template <class U, class V>
-Complex_number<R, T>::Complex_number(const Complex_number<U, V>& other){
-    try{
-        real = static_cast<R>(other.get_real());
-        imag = static_cast<T>(other.get_imag());
-    } catch (...){
-        throw Bad_construct("Bad_construct: error during casting fields of other to types R and T");
-    }
-}
+constexpr Complex_number<R, T>::Complex_number(const Complex_number<U, V>& other):
+    real(_complex_cast<R>(other.get_real(), "Bad_construct: error during casting fields of other to types R and T")),
+    imag(_complex_cast<T>(other.get_imag(), "Bad_construct: error during casting fields of other to types R and T")){}
 ///////////////////////////////////////////////////////////////////////
 
 // Methods
@@ -352,18 +398,18 @@ std::ostream& operator<<(std::ostream &os, const Complex_number<R, T>& n){
 }
 
 template <class R, class T>
-R Complex_number<R, T>::get_real() const{
+constexpr R Complex_number<R, T>::get_real() const{
     return real;
 }    
 
 template <class R, class T>
-T Complex_number<R, T>::get_imag() const{
+constexpr T Complex_number<R, T>::get_imag() const{
     return imag;
 }
 
 // compute module (radius-vector) 
 template <class R, class T>
-R Complex_number<R, T>::module_square() const{
+constexpr R Complex_number<R, T>::module_square() const{
     R res = real * real + imag * imag;
     return res;
 }
@@ -387,32 +433,32 @@ inline std::string Complex_number<Rational_number, Rational_number>::to_string()
 ///////////////////////////////////////////////////////////////////////
 
 template <class R, class T>
-bool Complex_number<R, T>::operator==(const Complex_number& rhs) const{
+constexpr bool Complex_number<R, T>::operator==(const Complex_number& rhs) const{
     return (real == rhs.get_real() && imag == rhs.get_imag());
 }
 
 template <class R, class T>
-bool Complex_number<R, T>::operator<(const Complex_number& rhs) const{
+constexpr bool Complex_number<R, T>::operator<(const Complex_number& rhs) const{
     return module_square() < rhs.module_square();
 }
 
 template <class R, class T>
-bool Complex_number<R, T>::operator<=(const Complex_number& rhs) const{
+constexpr bool Complex_number<R, T>::operator<=(const Complex_number& rhs) const{
     return (*this == rhs || *this < rhs);
 }
 
 template <class R, class T>
-bool Complex_number<R, T>::operator!=(const Complex_number& rhs) const{
+constexpr bool Complex_number<R, T>::operator!=(const Complex_number& rhs) const{
     return !(*this == rhs);
 }
 
 template <class R, class T>
-bool Complex_number<R, T>::operator>(const Complex_number& rhs) const{
+constexpr bool Complex_number<R, T>::operator>(const Complex_number& rhs) const{
     return !(*this <= rhs);
 }
 
 template <class R, class T>
-bool Complex_number<R, T>::operator>=(const Complex_number& rhs) const{
+constexpr bool Complex_number<R, T>::operator>=(const Complex_number& rhs) const{
     return !(*this < rhs);
 }
 ///////////////////////////////////////////////////////////////////////
@@ -422,29 +468,46 @@ bool Complex_number<R, T>::operator>=(const Complex_number& rhs) const{
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator+(const Complex_number& rhs) const{
+constexpr Complex_number<R, T> Complex_number<R, T>::operator+(const Complex_number& rhs) const{
     return Complex_number<R, T>(real + rhs.real, imag + rhs.imag);
 }
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator-(const Complex_number& rhs) const{
+constexpr Complex_number<R, T> Complex_number<R, T>::operator-(const Complex_number& rhs) const{
     return Complex_number<R, T>(real - rhs.real, imag - rhs.imag);
 }
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator*(const Complex_number& rhs) const{
+constexpr Complex_number<R, T> Complex_number<R, T>::operator*(const Complex_number& rhs) const{
+    if constexpr (std::is_floating_point<R>::value && std::is_same<R, T>::value){
+        return Complex_number<R, T>(_fused_mul_add(real, rhs.real, -(imag * rhs.imag)),
+                                    _fused_mul_add(real, rhs.imag, imag * rhs.real));
+    }
     return Complex_number<R, T>(real * rhs.real - imag * rhs.imag, 
                                 real * rhs.imag + imag * rhs.real);
 }
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator/(const Complex_number& rhs) const{
-    if (rhs == Complex_number<R, T>(0)){
+constexpr Complex_number<R, T> Complex_number<R, T>::operator/(const Complex_number& rhs) const{
+    if (rhs == Complex_number<R, T>()){
         throw Zero_division("zero division: ", rhs.to_string(), this->to_string());
     }
+    if constexpr (std::is_floating_point<R>::value && std::is_same<R, T>::value){
+        // Smith's algorithm: divide by the larger part of rhs first
+        if (_complex_abs(rhs.imag) <= _complex_abs(rhs.real)){
+            R ratio = rhs.imag / rhs.real;
+            R denom = _fused_mul_add(rhs.imag, ratio, rhs.real);
+            return Complex_number<R, T>(_fused_mul_add(imag, ratio, real) / denom,
+                                        _fused_mul_add(-real, ratio, imag) / denom);
+        }
+        R ratio = rhs.real / rhs.imag;
+        R denom = _fused_mul_add(rhs.real, ratio, rhs.imag);
+        return Complex_number<R, T>(_fused_mul_add(real, ratio, imag) / denom,
+                                    _fused_mul_add(imag, ratio, -real) / denom);
+    }
     return Complex_number<R, T>((real * rhs.real + imag * rhs.imag) / rhs.module_square(), 
                                 (imag * rhs.real - real * rhs.imag) / rhs.module_square());
 }
@@ -457,40 +520,36 @@ Complex_number<R, T> Complex_number<R, T>::operator/(const Complex_number& rhs)
 
 template <class R, class T>
 template <class U, class V>
-Complex_number<R, T>& Complex_number<R, T>::operator=(const Complex_number<U, V>& other){
-    try{
-        real = static_cast<R>(other.get_real());
-        imag = static_cast<T>(other.get_imag());
-    } catch (...){
-        throw Bad_construct("Error during copy constructor");
-    }
+constexpr Complex_number<R, T>& Complex_number<R, T>::operator=(const Complex_number<U, V>& other){
+    real = _complex_cast<R>(other.get_real(), "Error during copy constructor");
+    imag = _complex_cast<T>(other.get_imag(), "Error during copy constructor");
     return *this;
 }
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T>& Complex_number<R, T>::operator+=(const Complex_number& rhs){
+constexpr Complex_number<R, T>& Complex_number<R, T>::operator+=(const Complex_number& rhs){
     return *this = (*this + rhs);
 }
 
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T>& Complex_number<R, T>::operator-=(const Complex_number& rhs){
+constexpr Complex_number<R, T>& Complex_number<R, T>::operator-=(const Complex_number& rhs){
     return *this = (*this - rhs);
 }
 
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T>& Complex_number<R, T>::operator*=(const Complex_number& rhs){
+constexpr Complex_number<R, T>& Complex_number<R, T>::operator*=(const Complex_number& rhs){
     return *this = (*this * rhs);
 }
 
 
 // return type of left operand
 template <class R, class T>
-Complex_number<R, T>& Complex_number<R, T>::operator/=(const Complex_number& rhs){
+constexpr Complex_number<R, T>& Complex_number<R, T>::operator/=(const Complex_number& rhs){
     return *this = (*this / rhs);
 }
 ///////////////////////////////////////////////////////////////////////
@@ -501,39 +560,39 @@ Complex_number<R, T>& Complex_number<R, T>::operator/=(const Complex_number& rhs
 
 //unar +
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator+() const{
+constexpr Complex_number<R, T> Complex_number<R, T>::operator+() const{
     return Complex_number(*this);
 } 
 
 //unar -
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator-() const{
+constexpr Complex_number<R, T> Complex_number<R, T>::operator-() const{
     Complex_number copy(*this);
     return copy * Complex_number(-1, 0);
 }
 
 //prefix incr
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator++(){
+constexpr Complex_number<R, T> Complex_number<R, T>::operator++(){
     return (*this += Complex_number(1, 0));
 }        
 
 //postfix incr
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator++(int){
+constexpr Complex_number<R, T> Complex_number<R, T>::operator++(int){
     *this += Complex_number(1, 0);
     return *this - Complex_number(1, 0);
 }   
 
 //prefix decr
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator--(){
+constexpr Complex_number<R, T> Complex_number<R, T>::operator--(){
     return (*this -= Complex_number(1, 0));
 }      
 
 //postfix decr
 template <class R, class T>
-Complex_number<R, T> Complex_number<R, T>::operator--(int){
+constexpr Complex_number<R, T> Complex_number<R, T>::operator--(int){
     *this -= Complex_number(1, 0);
     return *this + Complex_number(1, 0);
 }
@@ -606,4 +665,11 @@ Complex_number<R, T>::operator double() const{
 
 ///////////////////////////////////////////////////////////////////////
 
+static_assert(std::is_trivially_copyable<Complex_number<double>>::value &&
+              std::is_standard_layout<Complex_number<double>>::value &&
+              sizeof(Complex_number<double>) == 2 * sizeof(double),
+              "Complex_number<double> must be trivially copyable pair of doubles");
+static_assert(std::is_trivially_copyable<Complex_number<float>>::value,
+              "Complex_number<float> must be trivially copyable");
+
 #endif // __ClassComplex_H__
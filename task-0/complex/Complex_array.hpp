@@ -0,0 +1,262 @@
+/**
+ * @file Complex_array.hpp
+ * @brief Array of complex numbers with separate arrays of real and imaginary parts
+ */
+
+#ifndef __ComplexArray_H__
+#define __ComplexArray_H__
+
+#include <vector>
+
+#include "ClassComplex.h"
+#include "Complex_simd.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+/**
+ * @brief Structure-of-arrays storage of Complex_number<R>.
+ *
+ * Array of Complex_number (AoS) interleaves real and imaginary parts, so vectorized
+ * kernels have to shuffle them. Here they are two contiguous arrays: bulk operations
+ * (+, elementwise *, fma, dot, module_square) load parts directly into SIMD registers
+ * (AVX2/AVX-512 kernels of Complex_simd.hpp for R = double, plain loops otherwise).
+ * Conversion from/to std::vector<Complex_number<R>> is one pass.
+ *
+ * @tparam R - type of real and imaginary parts (default value: double)
+ */
+template<class R = double>
+class Complex_array{
+private:
+    std::vector<R> re;
+    std::vector<R> im;
+public:
+    using value_type = Complex_number<R>;
+
+    Complex_array() = default;
+
+    // n zeros
+    explicit Complex_array(size_t n);
+
+    // split of interleaved values
+    explicit Complex_array(const std::vector<Complex_number<R>>& values);
+
+    size_t size() const;
+
+    Complex_number<R> operator[](size_t k) const;
+    void set(size_t k, const Complex_number<R>& val);
+
+    R* real_data();
+    R* imag_data();
+    const R* real_data() const;
+    const R* imag_data() const;
+
+    // interleaved values
+    std::vector<Complex_number<R>> to_vector() const;
+};
+
+template<class R>
+Complex_array<R>::Complex_array(size_t n): re(n, R((long) 0)), im(n, R((long) 0)){}
+
+template<class R>
+Complex_array<R>::Complex_array(const std::vector<Complex_number<R>>& values):
+    re(values.size()), im(values.size()){
+    for (size_t k = 0; k < values.size(); k++){
+        re[k] = values[k].get_real();
+        im[k] = values[k].get_imag();
+    }
+}
+
+template<class R>
+size_t Complex_array<R>::size() const{
+    return re.size();
+}
+
+template<class R>
+Complex_number<R> Complex_array<R>::operator[](size_t k) const{
+    return Complex_number<R>(re[k], im[k]);
+}
+
+template<class R>
+void Complex_array<R>::set(size_t k, const Complex_number<R>& val){
+    re[k] = val.get_real();
+    im[k] = val.get_imag();
+}
+
+template<class R>
+R* Complex_array<R>::real_data(){
+    return re.data();
+}
+
+template<class R>
+R* Complex_array<R>::imag_data(){
+    return im.data();
+}
+
+template<class R>
+const R* Complex_array<R>::real_data() const{
+    return re.data();
+}
+
+template<class R>
+const R* Complex_array<R>::imag_data() const{
+    return im.data();
+}
+
+template<class R>
+std::vector<Complex_number<R>> Complex_array<R>::to_vector() const{
+    std::vector<Complex_number<R>> res;
+    res.reserve(size());
+    for (size_t k = 0; k < size(); k++){
+        res.emplace_back(re[k], im[k]);
+    }
+    return res;
+}
+
+// Kernels on split arrays (double overloads are vectorized)
+//////////////////////////////////
+
+template<class R>
+void _complex_add(const R* ar, const R* ai, const R* br, const R* bi, R* cr, R* ci, size_t n){
+    for (size_t k = 0; k < n; k++){
+        cr[k] = ar[k] + br[k];
+        ci[k] = ai[k] + bi[k];
+    }
+}
+
+inline void _complex_add(const double* ar, const double* ai, const double* br, const double* bi,
+                         double* cr, double* ci, size_t n){
+    simd_complex_add(ar, ai, br, bi, cr, ci, n);
+}
+
+template<class R>
+void _complex_mul(const R* ar, const R* ai, const R* br, const R* bi, R* cr, R* ci, size_t n){
+    for (size_t k = 0; k < n; k++){
+        R re = ar[k] * br[k] - ai[k] * bi[k];
+        R im = ar[k] * bi[k] + ai[k] * br[k];
+        cr[k] = re;
+        ci[k] = im;
+    }
+}
+
+inline void _complex_mul(const double* ar, const double* ai, const double* br, const double* bi,
+                         double* cr, double* ci, size_t n){
+    simd_complex_mul(ar, ai, br, bi, cr, ci, n);
+}
+
+template<class R>
+void _complex_fma(const R* ar, const R* ai, const R* br, const R* bi, R* cr, R* ci, size_t n){
+    for (size_t k = 0; k < n; k++){
+        R re = cr[k] + ar[k] * br[k] - ai[k] * bi[k];
+        R im = ci[k] + ar[k] * bi[k] + ai[k] * br[k];
+        cr[k] = re;
+        ci[k] = im;
+    }
+}
+
+inline void _complex_fma(const double* ar, const double* ai, const double* br, const double* bi,
+                         double* cr, double* ci, size_t n){
+    simd_complex_fma(ar, ai, br, bi, cr, ci, n);
+}
+
+template<class R>
+Complex_number<R> _complex_dot(const R* ar, const R* ai, const R* br, const R* bi, size_t n){
+    R re((long) 0), im((long) 0);
+    for (size_t k = 0; k < n; k++){
+        re += ar[k] * br[k] + ai[k] * bi[k];
+        im += ar[k] * bi[k] - ai[k] * br[k];
+    }
+    return Complex_number<R>(re, im);
+}
+
+inline Complex_number<double> _complex_dot(const double* ar, const double* ai, const double* br,
+                                           const double* bi, size_t n){
+    double re, im;
+    simd_complex_dot(ar, ai, br, bi, n, re, im);
+    return Complex_number<double>(re, im);
+}
+
+template<class R>
+Complex_number<R> _complex_gather_dot(const int* idx, const R* ar, const R* ai, const R* br, const R* bi, size_t n){
+    R re((long) 0), im((long) 0);
+    for (size_t k = 0; k < n; k++){
+        re += ar[k] * br[idx[k]] - ai[k] * bi[idx[k]];
+        im += ar[k] * bi[idx[k]] + ai[k] * br[idx[k]];
+    }
+    return Complex_number<R>(re, im);
+}
+
+inline Complex_number<double> _complex_gather_dot(const int* idx, const double* ar, const double* ai,
+                                                  const double* br, const double* bi, size_t n){
+    double re, im;
+    simd_complex_gather_dot(idx, ar, ai, br, bi, n, re, im);
+    return Complex_number<double>(re, im);
+}
+
+template<class R>
+void _complex_module_square(const R* ar, const R* ai, R* out, size_t n){
+    for (size_t k = 0; k < n; k++){
+        out[k] = ar[k] * ar[k] + ai[k] * ai[k];
+    }
+}
+
+inline void _complex_module_square(const double* ar, const double* ai, double* out, size_t n){
+    simd_complex_module_square(ar, ai, out, n);
+}
+
+//////////////////////////////////
+
+// Bulk operations
+// All of them throw Shape_error if sizes of arrays differ
+//////////////////////////////////
+
+template<class R>
+void _check_sizes(const char* op, const Complex_array<R>& a, const Complex_array<R>& b){
+    if (a.size() != b.size()){
+        throw Shape_error(std::string("Wrong shapes for complex arrays ") + op + ": ", (int) a.size(), (int) b.size());
+    }
+}
+
+// elementwise a + b
+template<class R>
+Complex_array<R> operator+(const Complex_array<R>& a, const Complex_array<R>& b){
+    _check_sizes("'+'", a, b);
+    Complex_array<R> res(a.size());
+    _complex_add(a.real_data(), a.imag_data(), b.real_data(), b.imag_data(), res.real_data(), res.imag_data(), a.size());
+    return res;
+}
+
+// elementwise a * b
+template<class R>
+Complex_array<R> operator*(const Complex_array<R>& a, const Complex_array<R>& b){
+    _check_sizes("'*'", a, b);
+    Complex_array<R> res(a.size());
+    _complex_mul(a.real_data(), a.imag_data(), b.real_data(), b.imag_data(), res.real_data(), res.imag_data(), a.size());
+    return res;
+}
+
+// c += a * b elementwise
+template<class R>
+void fma(const Complex_array<R>& a, const Complex_array<R>& b, Complex_array<R>& c){
+    _check_sizes("(fma)", a, b);
+    _check_sizes("(fma)", a, c);
+    _complex_fma(a.real_data(), a.imag_data(), b.real_data(), b.imag_data(), c.real_data(), c.imag_data(), a.size());
+}
+
+// sum of conj(a[k]) * b[k]
+template<class R>
+Complex_number<R> dot(const Complex_array<R>& a, const Complex_array<R>& b){
+    _check_sizes("(dot)", a, b);
+    return _complex_dot(a.real_data(), a.imag_data(), b.real_data(), b.imag_data(), a.size());
+}
+
+// |a[k]|^2 for all k
+template<class R>
+std::vector<R> module_square(const Complex_array<R>& a){
+    std::vector<R> res(a.size());
+    _complex_module_square(a.real_data(), a.imag_data(), res.data(), a.size());
+    return res;
+}
+
+//////////////////////////////////
+
+#endif // __ComplexArray_H__
@@ -0,0 +1,210 @@
+/**
+ * @file Complex_simd.hpp
+ * @brief Vectorized kernels on complex arrays with split real and imaginary parts
+ */
+
+#ifndef __ComplexSimd_H__
+#define __ComplexSimd_H__
+
+#include <cstddef>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#ifndef TASK0_AVX2
+#define TASK0_AVX2 1
+#endif
+#endif
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#ifndef TASK0_AVX512
+#define TASK0_AVX512 1
+#endif
+#endif
+
+// Kernels used by Complex_array.hpp. Arrays of real and imaginary parts are separate (SoA),
+// so one register holds 8 (AVX-512) or 4 (AVX2) real parts and complex multiplication is
+// two FMAs per part without shuffles of interleaved layout. AVX-512 loop (if available) is
+// followed by AVX2 loop and scalar tail. Build with -DTASK0_NATIVE=ON (or -mavx2 -mfma,
+// -mavx512f) to enable them, otherwise plain loops are auto-vectorized by compiler.
+
+#ifdef TASK0_AVX2
+inline double _complex_simd_hsum(__m256d x){
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+#endif
+
+// c = a + b
+inline void simd_complex_add(const double* ar, const double* ai, const double* br, const double* bi,
+                             double* cr, double* ci, size_t n){
+    size_t k = 0;
+#ifdef TASK0_AVX512
+    for (; k + 8 <= n; k += 8){
+        _mm512_storeu_pd(cr + k, _mm512_add_pd(_mm512_loadu_pd(ar + k), _mm512_loadu_pd(br + k)));
+        _mm512_storeu_pd(ci + k, _mm512_add_pd(_mm512_loadu_pd(ai + k), _mm512_loadu_pd(bi + k)));
+    }
+#endif
+#ifdef TASK0_AVX2
+    for (; k + 4 <= n; k += 4){
+        _mm256_storeu_pd(cr + k, _mm256_add_pd(_mm256_loadu_pd(ar + k), _mm256_loadu_pd(br + k)));
+        _mm256_storeu_pd(ci + k, _mm256_add_pd(_mm256_loadu_pd(ai + k), _mm256_loadu_pd(bi + k)));
+    }
+#endif
+    for (; k < n; k++){
+        cr[k] = ar[k] + br[k];
+        ci[k] = ai[k] + bi[k];
+    }
+}
+
+// c = a * b (c may be the same array as a or b)
+inline void simd_complex_mul(const double* ar, const double* ai, const double* br, const double* bi,
+                             double* cr, double* ci, size_t n){
+    size_t k = 0;
+#ifdef TASK0_AVX512
+    for (; k + 8 <= n; k += 8){
+        __m512d xr = _mm512_loadu_pd(ar + k), xi = _mm512_loadu_pd(ai + k);
+        __m512d yr = _mm512_loadu_pd(br + k), yi = _mm512_loadu_pd(bi + k);
+        _mm512_storeu_pd(cr + k, _mm512_fmsub_pd(xr, yr, _mm512_mul_pd(xi, yi)));
+        _mm512_storeu_pd(ci + k, _mm512_fmadd_pd(xr, yi, _mm512_mul_pd(xi, yr)));
+    }
+#endif
+#ifdef TASK0_AVX2
+    for (; k + 4 <= n; k += 4){
+        __m256d xr = _mm256_loadu_pd(ar + k), xi = _mm256_loadu_pd(ai + k);
+        __m256d yr = _mm256_loadu_pd(br + k), yi = _mm256_loadu_pd(bi + k);
+        _mm256_storeu_pd(cr + k, _mm256_fmsub_pd(xr, yr, _mm256_mul_pd(xi, yi)));
+        _mm256_storeu_pd(ci + k, _mm256_fmadd_pd(xr, yi, _mm256_mul_pd(xi, yr)));
+    }
+#endif
+    for (; k < n; k++){
+        double re = ar[k] * br[k] - ai[k] * bi[k];
+        double im = ar[k] * bi[k] + ai[k] * br[k];
+        cr[k] = re;
+        ci[k] = im;
+    }
+}
+
+// c += a * b
+inline void simd_complex_fma(const double* ar, const double* ai, const double* br, const double* bi,
+                             double* cr, double* ci, size_t n){
+    size_t k = 0;
+#ifdef TASK0_AVX512
+    for (; k + 8 <= n; k += 8){
+        __m512d xr = _mm512_loadu_pd(ar + k), xi = _mm512_loadu_pd(ai + k);
+        __m512d yr = _mm512_loadu_pd(br + k), yi = _mm512_loadu_pd(bi + k);
+        __m512d re = _mm512_fnmadd_pd(xi, yi, _mm512_fmadd_pd(xr, yr, _mm512_loadu_pd(cr + k)));
+        __m512d im = _mm512_fmadd_pd(xi, yr, _mm512_fmadd_pd(xr, yi, _mm512_loadu_pd(ci + k)));
+        _mm512_storeu_pd(cr + k, re);
+        _mm512_storeu_pd(ci + k, im);
+    }
+#endif
+#ifdef TASK0_AVX2
+    for (; k + 4 <= n; k += 4){
+        __m256d xr = _mm256_loadu_pd(ar + k), xi = _mm256_loadu_pd(ai + k);
+        __m256d yr = _mm256_loadu_pd(br + k), yi = _mm256_loadu_pd(bi + k);
+        __m256d re = _mm256_fnmadd_pd(xi, yi, _mm256_fmadd_pd(xr, yr, _mm256_loadu_pd(cr + k)));
+        __m256d im = _mm256_fmadd_pd(xi, yr, _mm256_fmadd_pd(xr, yi, _mm256_loadu_pd(ci + k)));
+        _mm256_storeu_pd(cr + k, re);
+        _mm256_storeu_pd(ci + k, im);
+    }
+#endif
+    for (; k < n; k++){
+        double re = cr[k] + ar[k] * br[k] - ai[k] * bi[k];
+        double im = ci[k] + ar[k] * bi[k] + ai[k] * br[k];
+        cr[k] = re;
+        ci[k] = im;
+    }
+}
+
+// re + i * im = sum of conj(a[k]) * b[k]
+inline void simd_complex_dot(const double* ar, const double* ai, const double* br, const double* bi,
+                             size_t n, double& re, double& im){
+    size_t k = 0;
+    re = 0;
+    im = 0;
+#ifdef TASK0_AVX512
+    __m512d re8 = _mm512_setzero_pd(), im8 = _mm512_setzero_pd();
+    for (; k + 8 <= n; k += 8){
+        __m512d xr = _mm512_loadu_pd(ar + k), xi = _mm512_loadu_pd(ai + k);
+        __m512d yr = _mm512_loadu_pd(br + k), yi = _mm512_loadu_pd(bi + k);
+        re8 = _mm512_fmadd_pd(xi, yi, _mm512_fmadd_pd(xr, yr, re8));
+        im8 = _mm512_fnmadd_pd(xi, yr, _mm512_fmadd_pd(xr, yi, im8));
+    }
+    re += _mm512_reduce_add_pd(re8);
+    im += _mm512_reduce_add_pd(im8);
+#endif
+#ifdef TASK0_AVX2
+    __m256d re4 = _mm256_setzero_pd(), im4 = _mm256_setzero_pd();
+    for (; k + 4 <= n; k += 4){
+        __m256d xr = _mm256_loadu_pd(ar + k), xi = _mm256_loadu_pd(ai + k);
+        __m256d yr = _mm256_loadu_pd(br + k), yi = _mm256_loadu_pd(bi + k);
+        re4 = _mm256_fmadd_pd(xi, yi, _mm256_fmadd_pd(xr, yr, re4));
+        im4 = _mm256_fnmadd_pd(xi, yr, _mm256_fmadd_pd(xr, yi, im4));
+    }
+    re += _complex_simd_hsum(re4);
+    im += _complex_simd_hsum(im4);
+#endif
+    for (; k < n; k++){
+        re += ar[k] * br[k] + ai[k] * bi[k];
+        im += ar[k] * bi[k] - ai[k] * br[k];
+    }
+}
+
+// re + i * im = sum of a[k] * b[idx[k]] (row of complex CSR matrix times vector)
+inline void simd_complex_gather_dot(const int* idx, const double* ar, const double* ai,
+                                    const double* br, const double* bi, size_t n, double& re, double& im){
+    size_t k = 0;
+    re = 0;
+    im = 0;
+#ifdef TASK0_AVX512
+    __m512d re8 = _mm512_setzero_pd(), im8 = _mm512_setzero_pd();
+    for (; k + 8 <= n; k += 8){
+        __m256i pos = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+        __m512d xr = _mm512_loadu_pd(ar + k), xi = _mm512_loadu_pd(ai + k);
+        __m512d yr = _mm512_i32gather_pd(pos, br, 8), yi = _mm512_i32gather_pd(pos, bi, 8);
+        re8 = _mm512_fnmadd_pd(xi, yi, _mm512_fmadd_pd(xr, yr, re8));
+        im8 = _mm512_fmadd_pd(xi, yr, _mm512_fmadd_pd(xr, yi, im8));
+    }
+    re += _mm512_reduce_add_pd(re8);
+    im += _mm512_reduce_add_pd(im8);
+#endif
+#ifdef TASK0_AVX2
+    __m256d re4 = _mm256_setzero_pd(), im4 = _mm256_setzero_pd();
+    for (; k + 4 <= n; k += 4){
+        __m128i pos = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + k));
+        __m256d xr = _mm256_loadu_pd(ar + k), xi = _mm256_loadu_pd(ai + k);
+        __m256d yr = _mm256_i32gather_pd(br, pos, 8), yi = _mm256_i32gather_pd(bi, pos, 8);
+        re4 = _mm256_fnmadd_pd(xi, yi, _mm256_fmadd_pd(xr, yr, re4));
+        im4 = _mm256_fmadd_pd(xi, yr, _mm256_fmadd_pd(xr, yi, im4));
+    }
+    re += _complex_simd_hsum(re4);
+    im += _complex_simd_hsum(im4);
+#endif
+    for (; k < n; k++){
+        re += ar[k] * br[idx[k]] - ai[k] * bi[idx[k]];
+        im += ar[k] * bi[idx[k]] + ai[k] * br[idx[k]];
+    }
+}
+
+// out[k] = |a[k]|^2
+inline void simd_complex_module_square(const double* ar, const double* ai, double* out, size_t n){
+    size_t k = 0;
+#ifdef TASK0_AVX512
+    for (; k + 8 <= n; k += 8){
+        __m512d xr = _mm512_loadu_pd(ar + k), xi = _mm512_loadu_pd(ai + k);
+        _mm512_storeu_pd(out + k, _mm512_fmadd_pd(xr, xr, _mm512_mul_pd(xi, xi)));
+    }
+#endif
+#ifdef TASK0_AVX2
+    for (; k + 4 <= n; k += 4){
+        __m256d xr = _mm256_loadu_pd(ar + k), xi = _mm256_loadu_pd(ai + k);
+        _mm256_storeu_pd(out + k, _mm256_fmadd_pd(xr, xr, _mm256_mul_pd(xi, xi)));
+    }
+#endif
+    for (; k < n; k++){
+        out[k] = ar[k] * ar[k] + ai[k] * ai[k];
+    }
+}
+
+#endif // __ComplexSimd_H__
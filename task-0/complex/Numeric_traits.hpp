@@ -0,0 +1,119 @@
+/**
+ * @file Numeric_traits.hpp
+ * @brief Compile-time description of value types of Matrix and Vector
+ */
+
+#ifndef __NumericTraits_H__
+#define __NumericTraits_H__
+
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+#include <string>
+#include <algorithm>
+
+#include "../rational/ClassRationalNumber.h"
+#include "ClassComplex.h"
+
+/**
+ * @brief Numeric traits of value type T.
+ *
+ * exact        - arithmetic has no rounding errors (integers, Rational_number): zero test
+ *                is comparison with zero, eps is not used
+ * zero(), one()
+ * magnitude(x) - |x| (module for complex numbers) as double
+ * is_zero(x, eps) - x is exact zero for exact types, |x| < eps (or x == 0) otherwise
+ *
+ * Default implementation is for arithmetic types, Rational_number and Complex_number
+ * are specialized below. New value type of Matrix/Vector needs only its specialization.
+ */
+template<class T>
+struct Numeric_traits{
+    static constexpr bool exact = std::is_integral<T>::value;
+
+    static constexpr T zero(){
+        return T(0);
+    }
+
+    static constexpr T one(){
+        return T(1);
+    }
+
+    static double magnitude(const T& x){
+        return std::abs(static_cast<double>(x));
+    }
+
+    // for floating types: comparisons without branch, so filtering loops are vectorized;
+    // exact zero is zero for eps = 0 too
+    static constexpr bool is_zero(const T& x, double eps){
+        if constexpr (exact){
+            return x == T(0);
+        } else {
+            return ((x < T(0) ? -x : x) < eps) | (x == T(0));
+        }
+    }
+};
+
+template<>
+struct Numeric_traits<Rational_number>{
+    static constexpr bool exact = true;
+
+    static Rational_number zero(){
+        return Rational_number((long) 0);
+    }
+
+    static Rational_number one(){
+        return Rational_number((long) 1);
+    }
+
+    // |x| = mantissa * 10^exponent for integer x: leading 17 digits of "<[-]digits/1>" string
+    static double _integer_mantissa(const Rational_number& x, long& exponent){
+        std::string str = x.to_string();
+        size_t begin = str.find_first_of("0123456789"), end = str.find('/');
+        size_t digits = std::min<size_t>(end - begin, 17);
+        exponent = static_cast<long>(end - begin - digits);
+        return std::strtod(str.substr(begin, digits).c_str(), nullptr);
+    }
+
+    // numerator and denominator may be longer than range of double: leading digits are
+    // divided and scaled by difference of lengths, so ratio of huge numbers stays finite
+    static double magnitude(const Rational_number& x){
+        long num_exp, den_exp;
+        double ratio = _integer_mantissa(x.get_numerator(), num_exp) / _integer_mantissa(x.get_denominator(), den_exp);
+        long exponent = num_exp - den_exp;
+        return ratio * std::pow(10.0, exponent / 2) * std::pow(10.0, exponent - exponent / 2);
+    }
+
+    static bool is_zero(const Rational_number& x, double){
+        return x == Rational_number((long) 0);
+    }
+};
+
+template<class R, class T>
+struct Numeric_traits<Complex_number<R, T>>{
+    static constexpr bool exact = Numeric_traits<R>::exact && Numeric_traits<T>::exact;
+
+    static Complex_number<R, T> zero(){
+        return Complex_number<R, T>();
+    }
+
+    static Complex_number<R, T> one(){
+        return Complex_number<R, T>(Numeric_traits<R>::one(), Numeric_traits<T>::zero());
+    }
+
+    static double magnitude(const Complex_number<R, T>& x){
+        return std::sqrt(Numeric_traits<R>::magnitude(x.module_square()));
+    }
+
+    // |x|^2 < eps^2: no square root
+    static bool is_zero(const Complex_number<R, T>& x, double eps){
+        if constexpr (exact){
+            return x == zero();
+        } else {
+            R square = x.module_square();
+            return (square < eps * eps) | (square == R((long) 0));
+        }
+    }
+};
+
+#endif // __NumericTraits_H__
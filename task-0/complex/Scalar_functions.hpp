@@ -0,0 +1,31 @@
+/**
+ * @file Scalar_functions.hpp
+ * @brief Conjugate and magnitude of scalar values (real or complex)
+ */
+
+#ifndef __ScalarFunctions_H__
+#define __ScalarFunctions_H__
+
+#include <cmath>
+
+#include "ClassComplex.h"
+#include "Numeric_traits.hpp"
+
+// complex conjugate, identity for real types
+template<class T>
+T conjugate(const T& x){
+    return x;
+}
+
+template<class R, class T>
+Complex_number<R, T> conjugate(const Complex_number<R, T>& x){
+    return Complex_number<R, T>(x.get_real(), -x.get_imag());
+}
+
+// absolute value (module for complex numbers) as double
+template<class T>
+double magnitude(const T& x){
+    return Numeric_traits<T>::magnitude(x);
+}
+
+#endif // __ScalarFunctions_H__
@@ -0,0 +1,205 @@
+/**
+ * @file Bareiss.hpp
+ * @brief Fraction-free (Bareiss) gaussian elimination for Matrix<Rational_number>
+ */
+
+#ifndef __Bareiss_H__
+#define __Bareiss_H__
+
+#include <vector>
+#include <map>
+#include <utility>
+
+#include "../matrix/ClassMatrix.h"
+#include "../matrix/Matrix_csr.hpp"
+#include "../vector/ClassVector.hpp"
+#include "../rational/ClassRationalNumber.h"
+
+#include "../exceptions/CommonExceptions.hpp"
+#include "../exceptions/MatrixExceptions.hpp"
+
+/**
+ * @brief Echelon form produced by fraction-free elimination.
+ *
+ * Every row of source matrix is multiplied by lcm of its denominators, so elimination
+ * works with integers only. Bareiss step divides by previous pivot exactly, every
+ * element stays a minor of integer matrix and its length grows linearly (not exponentially).
+ * Rows are kept sparse: map {column, value}.
+ */
+struct Bareiss_echelon{
+    std::vector<std::map<int, Rational_number>> rows;
+    std::vector<int> pivot_columns;     // pivot of row k is in column pivot_columns[k]
+    Rational_number scale;              // product of row multipliers
+    bool odd_permutation = false;       // parity of row swaps
+};
+
+// lcm of two positive integers stored as Rational_number
+inline Rational_number _integer_lcm(const Rational_number& a, const Rational_number& b){
+    return a * (a / b).get_denominator();
+}
+
+/**
+ * @brief Fraction-free elimination of rows (columns >= elim_columns are only transformed)
+ *
+ * @param rows sparse rows, changed in place
+ * @param elim_columns number of columns where pivots are searched
+ */
+inline Bareiss_echelon _bareiss_eliminate(std::vector<std::map<int, Rational_number>> rows, int elim_columns){
+    Bareiss_echelon res;
+    const Rational_number zero, one((long) 1);
+    res.scale = one;
+
+    for (auto& row : rows){
+        Rational_number multiplier = one;
+        for (const auto& elem : row){
+            multiplier = _integer_lcm(multiplier, elem.second.get_denominator());
+        }
+        if (multiplier != one){
+            for (auto& elem : row){
+                elem.second *= multiplier;
+            }
+            res.scale *= multiplier;
+        }
+    }
+
+    int n = rows.size();
+    int rank = 0;
+    Rational_number prev = one;
+    for (int c = 0; c < elim_columns && rank < n; c++){
+        // sparsest row with non-zero in column c
+        int pivot_row = -1;
+        for (int i = rank; i < n; i++){
+            if (rows[i].count(c) && (pivot_row == -1 || rows[i].size() < rows[pivot_row].size())){
+                pivot_row = i;
+            }
+        }
+        if (pivot_row == -1) continue;
+        if (pivot_row != rank){
+            std::swap(rows[pivot_row], rows[rank]);
+            res.odd_permutation = !res.odd_permutation;
+        }
+
+        const auto& pivot_vals = rows[rank];
+        Rational_number pivot = pivot_vals.at(c);
+        for (int i = rank + 1; i < n; i++){
+            auto& row = rows[i];
+            auto it = row.find(c);
+            if (it == row.end()){
+                // a[i][j] = pivot * a[i][j] / prev
+                if (pivot != prev){
+                    for (auto& elem : row){
+                        elem.second = pivot * elem.second / prev;
+                    }
+                }
+                continue;
+            }
+            // a[i][j] = (pivot * a[i][j] - a[i][c] * a[rank][j]) / prev
+            Rational_number factor = it->second;
+            row.erase(it);
+            if (pivot != one){
+                for (auto& elem : row){
+                    elem.second *= pivot;
+                }
+            }
+            for (const auto& elem : pivot_vals){
+                if (elem.first == c) continue;
+                row[elem.first] -= factor * elem.second;
+            }
+            for (auto elem = row.begin(); elem != row.end(); ){
+                if (elem->second == zero){
+                    elem = row.erase(elem);
+                } else {
+                    if (prev != one) elem->second /= prev;
+                    elem++;
+                }
+            }
+        }
+        res.pivot_columns.push_back(c);
+        prev = pivot;
+        rank++;
+    }
+    res.rows = std::move(rows);
+    return res;
+}
+
+inline std::vector<std::map<int, Rational_number>> _matrix_rows(const Matrix<Rational_number>& matrix){
+    Matrix_csr<Rational_number> csr(matrix);
+    std::vector<std::map<int, Rational_number>> rows(csr.get_rows_number());
+    const std::vector<int>& row_ptr = csr.get_row_ptr();
+    for (int i = 0; i < csr.get_rows_number(); i++){
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            rows[i].emplace_hint(rows[i].end(), csr.get_col_idx()[k], csr.get_vals()[k]);
+        }
+    }
+    return rows;
+}
+
+/**
+ * @brief Exact rank of rational matrix
+ */
+inline int bareiss_rank(const Matrix<Rational_number>& matrix){
+    return _bareiss_eliminate(_matrix_rows(matrix), matrix.get_columns_number()).pivot_columns.size();
+}
+
+/**
+ * @brief Exact determinant of square rational matrix
+ *
+ * @throw Shape_error if matrix is not square
+ */
+inline Rational_number bareiss_determinant(const Matrix<Rational_number>& matrix){
+    int n = matrix.get_rows_number();
+    if (n != matrix.get_columns_number()){
+        throw Shape_error("Determinant is defined only for square matrix, got: ", n, matrix.get_columns_number());
+    }
+    Bareiss_echelon echelon = _bareiss_eliminate(_matrix_rows(matrix), n);
+    if ((int) echelon.pivot_columns.size() < n){
+        return Rational_number();
+    }
+    // last pivot of Bareiss elimination is determinant of scaled matrix
+    Rational_number det = echelon.rows[n - 1].at(n - 1) / echelon.scale;
+    return echelon.odd_permutation ? -det : det;
+}
+
+/**
+ * @brief Exact solution of A * x = b for square nonsingular rational matrix
+ *
+ * b is eliminated as extra column of A, then back substitution is performed.
+ *
+ * @throw Shape_error if shapes are wrong
+ * @throw Singular_matrix if matrix is singular
+ */
+inline Vector<Rational_number> bareiss_solve(const Matrix<Rational_number>& matrix, const Vector<Rational_number>& b){
+    int n = matrix.get_rows_number();
+    if (n != matrix.get_columns_number() || n != b.get_max_size()){
+        throw Shape_error("Wrong shapes for linear system (A, b): ",
+                          {n, matrix.get_columns_number()}, {b.get_max_size(), 1});
+    }
+    std::vector<std::map<int, Rational_number>> rows = _matrix_rows(matrix);
+    std::vector<Rational_number> b_vals = b.to_dense();
+    const Rational_number zero;
+    for (int i = 0; i < n; i++){
+        if (b_vals[i] != zero) rows[i][n] = b_vals[i];
+    }
+
+    Bareiss_echelon echelon = _bareiss_eliminate(std::move(rows), n);
+    if ((int) echelon.pivot_columns.size() < n){
+        throw Singular_matrix("Can't solve linear system: matrix is singular");
+    }
+
+    std::vector<Rational_number> x(n);
+    for (int i = n - 1; i >= 0; i--){
+        const auto& row = echelon.rows[i];
+        Rational_number sum = zero;
+        for (const auto& elem : row){
+            if (elem.first == n){
+                sum += elem.second;
+            } else if (elem.first > i){
+                sum -= elem.second * x[elem.first];
+            }
+        }
+        x[i] = sum / row.at(i);
+    }
+    return Vector<Rational_number>(x);
+}
+
+#endif // __Bareiss_H__
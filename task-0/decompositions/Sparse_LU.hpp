@@ -0,0 +1,277 @@
+/**
+ * @file Sparse_LU.hpp
+ * @brief Sparse LU decomposition with Markowitz pivot order for exact value types
+ */
+
+#ifndef __SparseLU_H__
+#define __SparseLU_H__
+
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <limits>
+
+#include "../matrix/ClassMatrix.h"
+#include "../matrix/Matrix_csr.hpp"
+#include "../vector/ClassVector.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+#include "../exceptions/MatrixExceptions.hpp"
+
+// size of value used to break ties between pivots with same Markowitz cost
+template<class T>
+size_t _pivot_size(const T& val){
+    return 1;
+}
+
+inline size_t _pivot_size(const Rational_number& val){
+    return val.to_string().size();  // digits of numerator and denominator
+}
+
+/**
+ * @brief Sparse LU decomposition P * A * Q = L * U.
+ *
+ * Designed for exact types (Rational_number): any non-zero element is a valid pivot,
+ * so pivots are chosen only to keep factors sparse. At every step pivot (r, c) minimizes
+ * Markowitz cost (row_count(r) - 1) * (column_count(c) - 1) of active submatrix, ties are
+ * broken by the shortest value (bounds growth of numerators). As in Zlatev's strategy, only
+ * search_limit sparsest rows and columns are examined, so step cost doesn't depend on nnz.
+ * Rectangular and singular matrices are decomposed too: rank is number of pivots.
+ *
+ * @tparam T - type of matrix's elements (exact: Rational_number, integral types)
+ */
+template<class T>
+class Sparse_LU{
+private:
+    int rows;
+    int columns;
+    int nnz_source;
+    std::vector<int> row_order;     // pivot of step k is (row_order[k], column_order[k])
+    std::vector<int> column_order;
+    std::vector<std::vector<std::pair<int, T>>> L;  // step k: {row, multiplier} of pivot row
+    std::vector<std::vector<std::pair<int, T>>> U;  // step k: pivot row {column, value}, pivot is first
+    static int permutation_parity(const std::vector<int>& perm);
+public:
+    explicit Sparse_LU(const Matrix<T>& matrix, int search_limit = 4);
+
+    int get_rank() const;
+    // number of stored elements of L and U minus number of non-zero elements of A
+    int get_fill_in() const;
+    const std::vector<int>& get_row_order() const;
+    const std::vector<int>& get_column_order() const;
+
+    // determinant of square matrix (zero if singular)
+    T determinant() const;
+    // solution of A * x = b for square nonsingular matrix
+    Vector<T> solve(const Vector<T>& b) const;
+};
+
+// Constructors
+//////////////////////////////////
+
+template<class T>
+Sparse_LU<T>::Sparse_LU(const Matrix<T>& matrix, int search_limit):
+    rows(matrix.get_rows_number()), columns(matrix.get_columns_number()){
+    Matrix_csr<T> csr(matrix);
+    nnz_source = csr.get_nnz();
+    const T zero((long) 0);
+
+    // active submatrix is stored by rows (values) and by columns (only pattern)
+    std::vector<std::map<int, T>> active_rows(rows);
+    std::vector<std::set<int>> active_columns(columns);
+    const std::vector<int>& row_ptr = csr.get_row_ptr();
+    for (int i = 0; i < rows; i++){
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            active_rows[i].emplace_hint(active_rows[i].end(), csr.get_col_idx()[k], csr.get_vals()[k]);
+            active_columns[csr.get_col_idx()[k]].insert(i);
+        }
+    }
+
+    // {count, index}, empty rows and columns are not stored
+    std::set<std::pair<int, int>> row_queue, column_queue;
+    std::vector<int> row_count(rows), column_count(columns);
+    for (int i = 0; i < rows; i++){
+        row_count[i] = active_rows[i].size();
+        if (row_count[i] > 0) row_queue.insert({row_count[i], i});
+    }
+    for (int j = 0; j < columns; j++){
+        column_count[j] = active_columns[j].size();
+        if (column_count[j] > 0) column_queue.insert({column_count[j], j});
+    }
+    auto update_count = [](std::set<std::pair<int, int>>& queue, std::vector<int>& count, int idx, int new_count){
+        queue.erase({count[idx], idx});
+        count[idx] = new_count;
+        if (new_count > 0) queue.insert({new_count, idx});
+    };
+
+    while (!row_queue.empty() && !column_queue.empty()){
+        int pivot_row = -1, pivot_column = -1;
+        long long best_cost = std::numeric_limits<long long>::max();
+        size_t best_size = 0;
+        auto consider = [&](int i, int j, const T& val){
+            long long cost = (long long) (row_count[i] - 1) * (column_count[j] - 1);
+            if (cost > best_cost) return;
+            size_t size = _pivot_size(val);
+            if (cost < best_cost || size < best_size){
+                best_cost = cost;
+                best_size = size;
+                pivot_row = i;
+                pivot_column = j;
+            }
+        };
+
+        int examined = 0;
+        for (auto it = column_queue.begin(); it != column_queue.end() && examined < search_limit; it++, examined++){
+            for (int i : active_columns[it->second]){
+                consider(i, it->second, active_rows[i].at(it->second));
+            }
+        }
+        examined = 0;
+        for (auto it = row_queue.begin(); it != row_queue.end() && examined < search_limit; it++, examined++){
+            for (const auto& elem : active_rows[it->second]){
+                consider(it->second, elem.first, elem.second);
+            }
+        }
+
+        // detach pivot row
+        T pivot = active_rows[pivot_row].at(pivot_column);
+        std::vector<std::pair<int, T>> u_row{{pivot_column, pivot}};
+        for (auto& elem : active_rows[pivot_row]){
+            active_columns[elem.first].erase(pivot_row);
+            if (elem.first != pivot_column) u_row.push_back(std::move(elem));
+        }
+        active_rows[pivot_row].clear();
+        update_count(row_queue, row_count, pivot_row, 0);
+
+        // eliminate pivot column from other rows
+        std::vector<std::pair<int, T>> l_column;
+        for (int i : active_columns[pivot_column]){
+            auto& row = active_rows[i];
+            T multiplier = row.at(pivot_column) / pivot;
+            row.erase(pivot_column);
+            for (size_t k = 1; k < u_row.size(); k++){
+                int j = u_row[k].first;
+                auto it = row.find(j);
+                if (it == row.end()){
+                    row.emplace(j, -(multiplier * u_row[k].second));    // fill-in
+                    active_columns[j].insert(i);
+                } else {
+                    it->second -= multiplier * u_row[k].second;
+                    if (it->second == zero){
+                        row.erase(it);
+                        active_columns[j].erase(i);
+                    }
+                }
+            }
+            l_column.push_back({i, std::move(multiplier)});
+            update_count(row_queue, row_count, i, row.size());
+        }
+        active_columns[pivot_column].clear();
+        update_count(column_queue, column_count, pivot_column, 0);
+        for (size_t k = 1; k < u_row.size(); k++){
+            int j = u_row[k].first;
+            update_count(column_queue, column_count, j, active_columns[j].size());
+        }
+
+        row_order.push_back(pivot_row);
+        column_order.push_back(pivot_column);
+        L.push_back(std::move(l_column));
+        U.push_back(std::move(u_row));
+    }
+}
+
+//////////////////////////////////
+
+// Methods
+//////////////////////////////////
+
+template<class T>
+int Sparse_LU<T>::get_rank() const{
+    return row_order.size();
+}
+
+template<class T>
+int Sparse_LU<T>::get_fill_in() const{
+    int nnz = 0;
+    for (size_t k = 0; k < L.size(); k++){
+        nnz += L[k].size() + U[k].size();
+    }
+    return nnz - nnz_source;
+}
+
+template<class T>
+const std::vector<int>& Sparse_LU<T>::get_row_order() const{
+    return row_order;
+}
+
+template<class T>
+const std::vector<int>& Sparse_LU<T>::get_column_order() const{
+    return column_order;
+}
+
+// 0 for even permutation, 1 for odd
+template<class T>
+int Sparse_LU<T>::permutation_parity(const std::vector<int>& perm){
+    std::vector<bool> visited(perm.size(), false);
+    int parity = 0;
+    for (size_t i = 0; i < perm.size(); i++){
+        if (visited[i]) continue;
+        int cycle_len = 0;
+        for (size_t j = i; !visited[j]; j = perm[j]){
+            visited[j] = true;
+            cycle_len++;
+        }
+        parity ^= (cycle_len - 1) & 1;
+    }
+    return parity;
+}
+
+template<class T>
+T Sparse_LU<T>::determinant() const{
+    if (rows != columns){
+        throw Shape_error("Determinant is defined only for square matrix, got: ", rows, columns);
+    }
+    if (get_rank() < rows){
+        return T((long) 0);
+    }
+    T det((long) 1);
+    for (const auto& u_row : U){
+        det *= u_row[0].second;
+    }
+    if (permutation_parity(row_order) != permutation_parity(column_order)){
+        det = -det;
+    }
+    return det;
+}
+
+template<class T>
+Vector<T> Sparse_LU<T>::solve(const Vector<T>& b) const{
+    if (rows != columns || rows != b.get_max_size()){
+        throw Shape_error("Wrong shapes for linear system (A, b): ", {rows, columns}, {b.get_max_size(), 1});
+    }
+    if (get_rank() < rows){
+        throw Singular_matrix("Can't solve linear system: matrix is singular");
+    }
+    std::vector<T> y = b.to_dense();
+    for (int k = 0; k < get_rank(); k++){
+        const T& y_pivot = y[row_order[k]];
+        for (const auto& elem : L[k]){
+            y[elem.first] -= elem.second * y_pivot;
+        }
+    }
+
+    std::vector<T> x(columns, T((long) 0));
+    for (int k = get_rank() - 1; k >= 0; k--){
+        T sum = y[row_order[k]];
+        for (size_t idx = 1; idx < U[k].size(); idx++){
+            sum -= U[k][idx].second * x[U[k][idx].first];
+        }
+        x[column_order[k]] = sum / U[k][0].second;
+    }
+    return Vector<T>(x);
+}
+
+//////////////////////////////////
+
+#endif // __SparseLU_H__
@@ -80,6 +80,32 @@ public:
     }
 };
 
+// Element access operators of Matrix and Vector check bounds in debug builds only
+// (release builds keep bare lookup), at() always checks. -DTASK0_BOUNDS_CHECK=0/1 overrides.
+#ifndef TASK0_BOUNDS_CHECK
+#ifdef NDEBUG
+#define TASK0_BOUNDS_CHECK 0
+#else
+#define TASK0_BOUNDS_CHECK 1
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define TASK0_COLD __attribute__((noinline, cold))
+#else
+#define TASK0_COLD
+#endif
+
+// messages are built out of line, so inline accessors keep only compare and call
+[[noreturn]] TASK0_COLD inline void _throw_out_of_range(int i){
+    throw Out_of_range("Trying to access element by out of range index: ", std::to_string(i));
+}
+
+[[noreturn]] TASK0_COLD inline void _throw_out_of_range(int i, int j){
+    throw Out_of_range("Trying to access element by out of range coordinates: ",
+                       std::to_string(i) + " " + std::to_string(j));
+}
+
 class Init_error: public std::exception{
 private:
     std::string m_error;
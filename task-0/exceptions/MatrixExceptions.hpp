@@ -36,5 +36,18 @@ public:
     }
 };
 
+class Singular_matrix: public std::exception{
+private:
+    std::string m_error;
+public:
+    Singular_matrix(const std::string& error){
+        m_error = error;
+    }
+
+    const char* what() const noexcept override {  
+        return m_error.c_str(); 
+    }
+};
+
 
 #endif //__MatrExceptions
\ No newline at end of file
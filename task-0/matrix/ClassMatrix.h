@@ -8,10 +8,14 @@
 #include <fstream>
 #include <string>
 #include <utility>
+#include <vector>
+#include <algorithm>
 #include <cmath>
+#include <optional>
 
 #include "Matrix_coords.h"
 #include "Matrix_proxy.hpp"
+#include "Matrix_expressions.hpp"
 
 #include "../parsers/Parser.h"
 
@@ -20,12 +24,15 @@
 
 #include "../rational/ClassRationalNumber.h"
 #include "../complex/ClassComplex.h"
+#include "../complex/Numeric_traits.hpp"
+#include "../stats/Stats.hpp"
 
 #ifndef __Matr_vals__
 #define __Matr_vals__
 struct pair_hash{
     template <class T1, class T2>
     std::size_t operator() (const std::pair<T1, T2>& pair) const {
+        TASK0_STAT(HASH_PROBES, 1);
         return std::hash<T1>()(pair.first) ^ std::hash<T2>()(pair.second);
     }
 };
@@ -36,12 +43,20 @@ template<class T>
 using matr_vals = std::unordered_map<coords, T, pair_hash>;
 #endif  //__Matr_vals__
 
+template<class T>
+class Matrix_csr;
+
 /**
  * @brief Class for sparse matrices.
  * 
- * Has eps parameter: all values less than eps are considered zero.
+ * Has eps parameter (drop tolerance of this matrix, default_eps if not set): all values less than eps
+ * are considered zero (for floating value types, exact types - integers, Rational_number - are filtered
+ * by comparison with zero, see Numeric_traits). eps = 0 keeps all non-zero values.
+ * keep_top_k and drop_relative prune small values in bulk (sparsification).
  * There is an opportunity to make slices of matrix.
  * Possible operations: +, -, *, unar -, ^ is transposing.
+ * +, -, * (and * by scalar) are lazy: they build expressions (Matrix_expressions.hpp)
+ * evaluated in one pass on construction of / assignment to Matrix.
  * Matrix can be parsed out of file and written to file.
  * 
  * @tparam T - type of matrix's elements (designed for standard types, Rational_number, Complex_number)
@@ -51,10 +66,11 @@ class Matrix{
 private:
     int rows;
     int columns;
-    constexpr static double eps = 0.01;
+    double eps = default_eps;
     matr_vals<T> values;
 
     friend class Matrix_proxy<T>;
+    friend class Matrix_csr<T>;
     std::unordered_set<Matrix_proxy<T>*> proxies; // all related proxies for a certain matrix
     void add_proxy(Matrix_proxy<T>* proxy);
     void remove_proxy(Matrix_proxy<T>* proxy);
@@ -64,8 +80,13 @@ private:
     matr_vals<T> key_union(const Matrix& other) const;
     std::ofstream _open_write_file(const char* filename, bool append = false) const;
 public:
+    using value_type = T;
+    constexpr static double default_eps = 0.01;
+
     Matrix(int _rows, int _columns, bool unar = false, bool fill_one = false);
-    Matrix(int _rows, int _columns, const matr_vals<T>&  _values);
+    Matrix(int _rows, int _columns, const matr_vals<T>&  _values, double _eps = default_eps);
+    // takes _values without copying (small values are erased in place)
+    Matrix(int _rows, int _columns, matr_vals<T>&& _values, double _eps = default_eps);
     Matrix(const Matrix& other);
     Matrix(Matrix&& other);
     ~Matrix();
@@ -76,16 +97,24 @@ public:
     // Constructor from proxy
     Matrix(const Matrix_proxy<T>& proxy);
 
+    // Evaluation of lazy expression (a + b, a * b, ...)
+    template<class E, class = std::enable_if_t<is_matrix_expression<E>::value>>
+    Matrix(const E& expr);
+
     Matrix& operator=(const Matrix& other);
     Matrix& operator=(Matrix&& other);
-    Matrix operator+(Matrix& other); // return type of left operand
-    Matrix operator-(Matrix& other); // return type of left operand
-    Matrix operator*(Matrix& other); // return type of left operand
+    template<class E, class = std::enable_if_t<is_matrix_expression<E>::value>>
+    Matrix& operator=(const E& expr);
     Matrix operator-();   //unar -
     Matrix operator~();   // transposion
 
+    // missing element is inserted as fake zero value; bounds are checked if TASK0_BOUNDS_CHECK
     T& operator()(int i, int j);
     T& operator()(const coords& pos);
+    // same as operator(), always throws Out_of_range for wrong coordinates
+    T& at(int i, int j);
+    // value (zero if missing) or nullopt if out of range: no insertion, no exceptions
+    std::optional<T> try_get(int i, int j) const;
     Matrix_proxy<T> operator[](const Matrix_coords& coords);
     Matrix_proxy<T> operator[](const Matrix_row_coord& row);
     Matrix_proxy<T> operator[](const Matrix_column_coord& row);
@@ -93,11 +122,18 @@ public:
     // number of non-zero elems in values
     int get_size();   
     std::string to_string();
-    static void set_eps(double new_eps);
-    static double get_eps();
+    // values less than new_eps are removed at once
+    void set_eps(double new_eps);
+    double get_eps() const;
+
+    // Sparsification: return number of removed values
+    int keep_top_k(int k);              // at most k values of largest magnitude in every row
+    int drop_relative(double tol);      // values with |a_ij| < tol * ||row i||_2
 
     int get_rows_number() const;
     int get_columns_number() const;
+    // stored values (may contain fake zero values created by operator())
+    const matr_vals<T>& get_values() const;
 
     matr_vals<T> get_submatrix_vals(const Matrix_coords& range);    // for matrix
     std::map<int, T> get_row_vals(int idx);   // for vector
@@ -126,31 +162,33 @@ Matrix<T>::Matrix(int _rows, int _columns, bool unar, bool fill_one):
 
 
 template<class T>
-Matrix<T>::Matrix(int _rows, int _columns, const matr_vals<T>&  _values):
-    rows(_rows), columns(_columns){
+Matrix<T>::Matrix(int _rows, int _columns, const matr_vals<T>&  _values, double _eps):
+    rows(_rows), columns(_columns), eps(_eps){
     for (const auto& elem : _values){
         coords tmp = elem.first;
         if (!(tmp.first < rows && tmp.second < columns)){
             std::string tmp_pos = std::to_string(tmp.first) + ", " + std::to_string(tmp.second);
             throw Init_error("Elements coordinates must be less then dimensions, but got: ", tmp_pos);
         }
-        if (!(abs(elem.second) < eps)){
+        if (!Numeric_traits<T>::is_zero(elem.second, eps)){
             values[elem.first] = elem.second;
         }
     }
 }
 
-template<>
-Matrix<Complex_number<>>::Matrix(int _rows, int _columns, const matr_vals<Complex_number<>>&  _values):
-    rows(_rows), columns(_columns){
-    for (const auto& elem : _values){
-        coords tmp = elem.first;
+template<class T>
+Matrix<T>::Matrix(int _rows, int _columns, matr_vals<T>&& _values, double _eps):
+    rows(_rows), columns(_columns), eps(_eps), values(std::move(_values)){
+    for (auto it = values.begin(); it != values.end();){
+        coords tmp = it->first;
         if (!(tmp.first < rows && tmp.second < columns)){
             std::string tmp_pos = std::to_string(tmp.first) + ", " + std::to_string(tmp.second);
             throw Init_error("Elements coordinates must be less then dimensions, but got: ", tmp_pos);
         }
-        if (!(elem.second.module_square() < eps * eps)){
-            values[elem.first] = elem.second;
+        if (Numeric_traits<T>::is_zero(it->second, eps)){
+            it = values.erase(it);
+        } else {
+            ++it;
         }
     }
 }
@@ -159,6 +197,7 @@ template<class T>
 Matrix<T>::Matrix(const Matrix& other){
     rows = other.rows;
     columns = other.columns;
+    eps = other.eps;
     values = other.values;
 }
 
@@ -166,6 +205,7 @@ template<class T>
 Matrix<T>::Matrix(Matrix&& other){
     rows = std::move(other.rows);
     columns = std::move(other.columns);
+    eps = other.eps;
     std::swap(values, other.values);
 }
 
@@ -174,9 +214,18 @@ Matrix<T>::Matrix(const Matrix_proxy<T>& proxy){
     std::pair<int, int> dims = proxy.get_dim();
     rows = dims.first;
     columns = dims.second;
+    eps = proxy.get_eps();
     values = proxy.get_values_as_hash_map();
 }
 
+template<class T>
+template<class E, class>
+Matrix<T>::Matrix(const E& expr):
+    rows(expr.get_rows_number()), columns(expr.get_columns_number()), eps(expr.get_eps()){
+    values = _evaluate_matrix_expression<T>(expr);
+    _clear_fake_vals();
+}
+
 template<class T>
 Matrix<T>::~Matrix(){
     for (auto proxy: proxies) {
@@ -208,7 +257,7 @@ Matrix<Rational_number>::Matrix(const char* file_path){
             throw Init_error("Elements coordinates must be less then dimensions, but got: ", tmp_pos);
         }
         Rational_number val(elem.second.first, elem.second.second);
-        if (!(abs(val) < eps)){
+        if (!Numeric_traits<Rational_number>::is_zero(val, eps)){
             values[pos] = val;
         }
     }
@@ -233,7 +282,7 @@ Matrix<Complex_number<>>::Matrix(const char* file_path){
             throw Init_error("Elements coordinates must be less then dimensions, but got: ", tmp_pos);
         }
         Complex_number<> val(std::stod(elem.second.first), std::stod(elem.second.second));
-        if (!(val.module_square() < eps * eps)){
+        if (!Numeric_traits<Complex_number<>>::is_zero(val, eps)){
             values[pos] = val;
         }
     }
@@ -249,11 +298,15 @@ Matrix<Complex_number<>>::Matrix(const char* file_path){
 // They are cleared internally with call of some methods.
 template<class T>
 T& Matrix<T>::operator()(int i, int j){
-    if (!(0 <= i < rows && 0 <= j < columns )){
-        std::string tmp = std::to_string(i) + " " + std::to_string(j);
-        Out_of_range("Trying to access element by out of range coordinates: ", tmp);
+#if TASK0_BOUNDS_CHECK
+    if (static_cast<unsigned>(i) >= static_cast<unsigned>(rows) ||
+        static_cast<unsigned>(j) >= static_cast<unsigned>(columns)){
+        _throw_out_of_range(i, j);
     }
-    return values[{i, j}];
+#endif
+    auto res = values.try_emplace(coords(i, j));
+    TASK0_STAT(FAKE_INSERTS, res.second);
+    return res.first->second;
 }
 
 //call operator(pos.first, pos.second)
@@ -262,11 +315,31 @@ T& Matrix<T>::operator()(const coords& pos){
     return this->operator()(pos.first, pos.second);
 }
 
+template<class T>
+T& Matrix<T>::at(int i, int j){
+    if (static_cast<unsigned>(i) >= static_cast<unsigned>(rows) ||
+        static_cast<unsigned>(j) >= static_cast<unsigned>(columns)){
+        _throw_out_of_range(i, j);
+    }
+    return this->operator()(i, j);
+}
+
+template<class T>
+std::optional<T> Matrix<T>::try_get(int i, int j) const{
+    if (static_cast<unsigned>(i) >= static_cast<unsigned>(rows) ||
+        static_cast<unsigned>(j) >= static_cast<unsigned>(columns)){
+        return std::nullopt;
+    }
+    auto it = values.find(coords(i, j));
+    return it == values.end() ? T((long) 0) : it->second;
+}
+
 template<class T>
 Matrix<T>& Matrix<T>::operator=(const Matrix& other){
     if (!same_shape(other)){
         throw Shape_error("Wrong shape for operation '=': ", {rows, columns}, {other.rows, other.columns});
     }
+    eps = other.eps;
     values = other.values;
     return *this;
 }
@@ -276,65 +349,22 @@ Matrix<T>& Matrix<T>::operator=(Matrix&& other){
     if (!same_shape(other)){
         throw Shape_error("Wrong shape for operation '=': ", {rows, columns}, {other.rows, other.columns});
     }
+    eps = other.eps;
     values = std::move(other.values);
     return *this;
 }
 
 template<class T>
-Matrix<T> Matrix<T>::operator+(Matrix& other){
-    if (!same_shape(other)){
-        throw Shape_error("Wrong shape for operation '+': ", {rows, columns}, {other.rows, other.columns});
-    }
-    decltype(values) tmp_vals = key_union(other);
-    for (const auto& elem : tmp_vals){
-        tmp_vals[elem.first] = values[elem.first] + other.values[elem.first];
-    }
-    Matrix<T> res(rows, columns, tmp_vals);
-
-    _clear_fake_vals();
-    other._clear_fake_vals();
-    return res;
-}
-
-template<class T>
-Matrix<T> Matrix<T>::operator-(Matrix& other){
-    if (!same_shape(other)) {
-        throw Shape_error("Wrong shape for operation '-': ", {rows, columns}, {other.rows, other.columns});
-    }
-    decltype(values) tmp_vals = key_union(other);
-    for (const auto& elem : tmp_vals){
-        tmp_vals[elem.first] = values[elem.first] - other.values[elem.first];
-    }
-    Matrix<T> res(rows, columns, tmp_vals);
-
-    _clear_fake_vals();
-    other._clear_fake_vals();
-    return res;
-}
-
-template<class T>
-Matrix<T> Matrix<T>::operator*(Matrix& other){
-    if (columns != other.rows){
-        throw Shape_error("Wrong shape for operation '*': ", {rows, columns}, {other.rows, other.columns});
-    }
-    decltype(values) tmp_vals;
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < other.columns; j++) {
-            T tmp((long) 0), tmp1((long) 0);
-            for (int k = 0; k < columns; k++)
-                if (values.find({i, k}) != values.end() && 
-                    other.values.find({k, j}) != other.values.end()){
-                    tmp += values[{i, k}] * other.values[{k, j}];
-                }
-            if (tmp != tmp1) tmp_vals[{i, j}] = tmp;    // if changed
-        }
+template<class E, class>
+Matrix<T>& Matrix<T>::operator=(const E& expr){
+    if (rows != expr.get_rows_number() || columns != expr.get_columns_number()){
+        throw Shape_error("Wrong shape for operation '=': ", {rows, columns},
+                          {expr.get_rows_number(), expr.get_columns_number()});
     }
-    
-    Matrix<T> res(rows, other.columns, tmp_vals);
-
+    values = _evaluate_matrix_expression<T>(expr);     // operands may alias *this, so values are replaced at once
+    eps = expr.get_eps();
     _clear_fake_vals();
-    other._clear_fake_vals();
-    return res;
+    return *this;
 }
 
 // unar -
@@ -434,47 +464,15 @@ int Matrix<T>::get_size(){
 // This function removes them.
 template<class T>
 void Matrix<T>::_clear_fake_vals(){
-    //for(const auto& elem: values){
-    //    if (abs(elem.second) < eps)
-    //        values.erase(elem.first);
-    //}
-    std::unordered_set<coords, pair_hash> to_delete;
-    for(auto it = values.begin(); it != values.end(); it++){
-        if (abs(it->second) < eps)
-            to_delete.insert(it->first);
-    }
-
-    for (auto& key : to_delete) {
-        values.erase(key);
-    }
-}
-
-template<>
-void Matrix<Complex_number<>>::_clear_fake_vals(){
-    std::unordered_set<coords, pair_hash> to_delete;
-    for(auto it = values.begin(); it != values.end(); it++){
-        if (it->second.module_square() < eps * eps)
-            to_delete.insert(it->first);
-    }
-
-    for (auto& key : to_delete) {
-        values.erase(key);
-    }
-}
-
-
-template<>
-void Matrix<Rational_number>::_clear_fake_vals(){
-    std::unordered_set<coords, pair_hash> to_delete;
-    Rational_number rat_eps = Rational_number::from_double(eps);
-    for(auto it = values.begin(); it != values.end(); it++){
-        if (abs(it->second) < eps)
-            to_delete.insert(it->first);
-    }
-
-    for (auto& key : to_delete) {
-        values.erase(key);
+    [[maybe_unused]] size_t before = values.size();
+    for(auto it = values.begin(); it != values.end(); ){
+        if (Numeric_traits<T>::is_zero(it->second, eps)){
+            it = values.erase(it);
+        } else {
+            it++;
+        }
     }
+    TASK0_STAT(FAKE_REMOVALS, before - values.size());
 }
 
 template<class T>
@@ -633,13 +631,69 @@ void Matrix<T>::remove_proxy(Matrix_proxy<T>* proxy) {
 template<class T>
 void Matrix<T>::set_eps(double new_eps){
     eps = new_eps;
+    _clear_fake_vals();
 }
 
 template<class T>
-double Matrix<T>::get_eps(){
+double Matrix<T>::get_eps() const{
     return eps;
 }
 
+// values of every row with their magnitudes, indices are rows
+template<class T>
+std::vector<std::vector<std::pair<double, int>>> _row_magnitudes(const matr_vals<T>& values, int rows){
+    std::vector<std::vector<std::pair<double, int>>> res(rows);
+    for (const auto& elem : values){
+        res[elem.first.first].emplace_back(Numeric_traits<T>::magnitude(elem.second), elem.first.second);
+    }
+    return res;
+}
+
+template<class T>
+int Matrix<T>::keep_top_k(int k){
+    if (k < 0){
+        throw Init_error("Number of kept values must be non-negative, got: ", std::to_string(k));
+    }
+    _clear_fake_vals();     // fake zeros must not take slots or be counted as removed
+    int removed = 0;
+    auto row_vals = _row_magnitudes(values, rows);
+    for (int i = 0; i < rows; i++){
+        auto& row = row_vals[i];
+        if (row.size() <= static_cast<size_t>(k)) continue;
+        // larger magnitude first, smaller column on ties
+        auto greater = [](const std::pair<double, int>& lhs, const std::pair<double, int>& rhs){
+            return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+        };
+        std::nth_element(row.begin(), row.begin() + k, row.end(), greater);
+        for (auto it = row.begin() + k; it != row.end(); it++){
+            values.erase({i, it->second});
+            removed++;
+        }
+    }
+    return removed;
+}
+
+template<class T>
+int Matrix<T>::drop_relative(double tol){
+    _clear_fake_vals();
+    int removed = 0;
+    auto row_vals = _row_magnitudes(values, rows);
+    for (int i = 0; i < rows; i++){
+        double norm = 0;
+        for (const auto& elem : row_vals[i]){
+            norm += elem.first * elem.first;
+        }
+        double threshold = tol * std::sqrt(norm);
+        for (const auto& elem : row_vals[i]){
+            if (elem.first < threshold){
+                values.erase({i, elem.second});
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
 template<class T>
 int Matrix<T>::get_rows_number() const{
     return rows;
@@ -650,6 +704,14 @@ int Matrix<T>::get_columns_number() const{
     return columns;
 }
 
+template<class T>
+const matr_vals<T>& Matrix<T>::get_values() const{
+    return values;
+}
+
 //////////////////////////////////
 
+// Matrix_csr is used by lazy product
+#include "Matrix_csr.hpp"
+
 #endif // __ClassMatrix_H__
@@ -0,0 +1,275 @@
+/**
+ * @file Matrix_assembly.hpp
+ * @brief Kronecker and Hadamard products and block assembly (hstack, vstack, block_diag) of CSR matrices
+ */
+
+#ifndef __MatrixAssembly_H__
+#define __MatrixAssembly_H__
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "ClassMatrix.h"
+#include "../parallel/Parallel.hpp"
+#include "../stats/Stats.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+/**
+ * Results are built directly in compressed arrays: row pointers are computed first (from
+ * numbers of elements of rows of operands), so col_idx and vals are allocated once with
+ * exact size and rows are filled independently (in parallel for long results).
+ * Small pieces are converted with Matrix_csr(matrix), result goes back with to_matrix(eps)
+ * (eps of operands to keep small products, CSR arrays don't store it).
+ */
+
+template<class T>
+using Csr_blocks = std::vector<std::reference_wrapper<const Matrix_csr<T>>>;
+
+// Helpers
+//////////////////////////////////
+
+// row_ptr from numbers of elements of rows (counts[i] is moved to row_ptr[i + 1]),
+// throws Out_of_range if number of elements doesn't fit in int
+inline std::vector<int> _row_ptr_from_counts(const std::vector<long long>& counts, const char* what){
+    std::vector<int> row_ptr(counts.size() + 1, 0);
+    long long total = 0;
+    for (size_t i = 0; i < counts.size(); i++){
+        total += counts[i];
+        if (total > std::numeric_limits<int>::max()){
+            throw Out_of_range(std::string("Too many elements in result of ") + what);
+        }
+        row_ptr[i + 1] = static_cast<int>(total);
+    }
+    return row_ptr;
+}
+
+// checked sum of dimensions
+inline int _sum_dims(long long lhs, long long rhs, const char* what){
+    if (lhs + rhs > std::numeric_limits<int>::max()){
+        throw Out_of_range(std::string("Too large dimension of result of ") + what);
+    }
+    return static_cast<int>(lhs + rhs);
+}
+
+template<class T>
+Matrix_csr<T> _make_csr(int rows, int columns, std::vector<int> row_ptr, std::vector<int> col_idx, std::vector<T> vals){
+    TASK0_STAT(ALLOCATIONS, 3);
+    TASK0_STAT(BYTES_MOVED, vals.size() * (sizeof(int) + sizeof(T)));
+    return Matrix_csr<T>(rows, columns, std::move(row_ptr), std::move(col_idx), std::move(vals));
+}
+
+//////////////////////////////////
+
+// Products
+//////////////////////////////////
+
+/**
+ * @brief Kronecker product: block (i, k) of result is a(i, k) * b
+ *
+ * Row i * p + r (p rows of b) is row r of b repeated for every element of row i of a
+ * with columns shifted by k * q, so its length is known before filling and columns
+ * come out sorted.
+ */
+template<class T>
+Matrix_csr<T> kron(const Matrix_csr<T>& a, const Matrix_csr<T>& b,
+                   const Parallel_policy& policy = default_parallel_policy()){
+    long long rows = static_cast<long long>(a.get_rows_number()) * b.get_rows_number();
+    long long columns = static_cast<long long>(a.get_columns_number()) * b.get_columns_number();
+    if (rows > std::numeric_limits<int>::max() || columns > std::numeric_limits<int>::max()){
+        throw Out_of_range("Too large dimension of result of Kronecker product");
+    }
+    const std::vector<int> &a_ptr = a.get_row_ptr(), &a_col = a.get_col_idx(), &b_ptr = b.get_row_ptr(),
+                           &b_col = b.get_col_idx();
+    const std::vector<T> &a_vals = a.get_vals(), &b_vals = b.get_vals();
+    int p = b.get_rows_number(), q = b.get_columns_number();
+
+    std::vector<long long> counts(rows);
+    for (long long row = 0; row < rows; row++){
+        int i = row / p, r = row % p;
+        counts[row] = static_cast<long long>(a_ptr[i + 1] - a_ptr[i]) * (b_ptr[r + 1] - b_ptr[r]);
+    }
+    std::vector<int> row_ptr = _row_ptr_from_counts(counts, "Kronecker product");
+    std::vector<int> col_idx(row_ptr.back());
+    std::vector<T> vals(row_ptr.back());
+
+    parallel_for(rows, [&](size_t begin, size_t end){
+        for (size_t row = begin; row < end; row++){
+            int i = row / p, r = row % p, pos = row_ptr[row];
+            for (int ka = a_ptr[i]; ka < a_ptr[i + 1]; ka++){
+                int shift = a_col[ka] * q;
+                for (int kb = b_ptr[r]; kb < b_ptr[r + 1]; kb++, pos++){
+                    col_idx[pos] = shift + b_col[kb];
+                    vals[pos] = a_vals[ka] * b_vals[kb];
+                }
+            }
+        }
+    }, policy);
+    return _make_csr(static_cast<int>(rows), static_cast<int>(columns), std::move(row_ptr), std::move(col_idx),
+                     std::move(vals));
+}
+
+/**
+ * @brief Elementwise (Hadamard) product on intersection of patterns
+ *
+ * Symbolic pass counts common columns of rows, numeric pass multiplies them.
+ * @throw Shape_error if shapes differ
+ */
+template<class T>
+Matrix_csr<T> hadamard(const Matrix_csr<T>& a, const Matrix_csr<T>& b,
+                       const Parallel_policy& policy = default_parallel_policy()){
+    int rows = a.get_rows_number(), columns = a.get_columns_number();
+    if (rows != b.get_rows_number() || columns != b.get_columns_number()){
+        throw Shape_error("Wrong shapes for Hadamard product: ", {rows, columns},
+                          {b.get_rows_number(), b.get_columns_number()});
+    }
+    const std::vector<int> &a_ptr = a.get_row_ptr(), &a_col = a.get_col_idx(), &b_ptr = b.get_row_ptr(),
+                           &b_col = b.get_col_idx();
+
+    // f(ka, kb) for common columns of row i
+    auto for_common = [&](int i, auto f){
+        int ka = a_ptr[i], kb = b_ptr[i];
+        while (ka < a_ptr[i + 1] && kb < b_ptr[i + 1]){
+            if (a_col[ka] < b_col[kb]) ka++;
+            else if (b_col[kb] < a_col[ka]) kb++;
+            else f(ka++, kb++);
+        }
+    };
+
+    std::vector<long long> counts(rows, 0);
+    parallel_for(rows, [&](size_t begin, size_t end){
+        for (size_t i = begin; i < end; i++){
+            for_common(i, [&](int, int){ counts[i]++; });
+        }
+    }, policy);
+    std::vector<int> row_ptr = _row_ptr_from_counts(counts, "Hadamard product");
+    std::vector<int> col_idx(row_ptr.back());
+    std::vector<T> vals(row_ptr.back());
+
+    parallel_for(rows, [&](size_t begin, size_t end){
+        for (size_t i = begin; i < end; i++){
+            int pos = row_ptr[i];
+            for_common(i, [&](int ka, int kb){
+                col_idx[pos] = a_col[ka];
+                vals[pos++] = a.get_vals()[ka] * b.get_vals()[kb];
+            });
+        }
+    }, policy);
+    return _make_csr(rows, columns, std::move(row_ptr), std::move(col_idx), std::move(vals));
+}
+
+//////////////////////////////////
+
+// Block assembly
+//////////////////////////////////
+
+/**
+ * @brief [A B ...]: blocks with equal number of rows side by side
+ * @throw Shape_error if numbers of rows differ, Init_error if blocks is empty
+ */
+template<class T>
+Matrix_csr<T> hstack(const Csr_blocks<T>& blocks, const Parallel_policy& policy = default_parallel_policy()){
+    if (blocks.empty()){
+        throw Init_error("hstack: no blocks");
+    }
+    int rows = blocks[0].get().get_rows_number();
+    std::vector<int> shifts{0};
+    for (const Matrix_csr<T>& block : blocks){
+        if (block.get_rows_number() != rows){
+            throw Shape_error("hstack: blocks must have equal numbers of rows: ", rows, block.get_rows_number());
+        }
+        shifts.push_back(_sum_dims(shifts.back(), block.get_columns_number(), "hstack"));
+    }
+
+    std::vector<long long> counts(rows, 0);
+    for (const Matrix_csr<T>& block : blocks){
+        for (int i = 0; i < rows; i++){
+            counts[i] += block.get_row_ptr()[i + 1] - block.get_row_ptr()[i];
+        }
+    }
+    std::vector<int> row_ptr = _row_ptr_from_counts(counts, "hstack");
+    std::vector<int> col_idx(row_ptr.back());
+    std::vector<T> vals(row_ptr.back());
+
+    parallel_for(rows, [&](size_t begin, size_t end){
+        for (size_t i = begin; i < end; i++){
+            int pos = row_ptr[i];
+            for (size_t b = 0; b < blocks.size(); b++){
+                const Matrix_csr<T>& block = blocks[b];
+                for (int k = block.get_row_ptr()[i]; k < block.get_row_ptr()[i + 1]; k++, pos++){
+                    col_idx[pos] = block.get_col_idx()[k] + shifts[b];
+                    vals[pos] = block.get_vals()[k];
+                }
+            }
+        }
+    }, policy);
+    return _make_csr(rows, shifts.back(), std::move(row_ptr), std::move(col_idx), std::move(vals));
+}
+
+// blocks placed one under another (same_columns) or on diagonal: arrays are concatenated
+template<class T>
+Matrix_csr<T> _stack_rows(const Csr_blocks<T>& blocks, bool same_columns, const char* what){
+    if (blocks.empty()){
+        throw Init_error(std::string(what) + ": no blocks");
+    }
+    int rows = 0, columns = same_columns ? blocks[0].get().get_columns_number() : 0;
+    long long nnz = 0;
+    for (const Matrix_csr<T>& block : blocks){
+        if (same_columns && block.get_columns_number() != columns){
+            throw Shape_error(std::string(what) + ": blocks must have equal numbers of columns: ",
+                              columns, block.get_columns_number());
+        }
+        rows = _sum_dims(rows, block.get_rows_number(), what);
+        if (!same_columns) columns = _sum_dims(columns, block.get_columns_number(), what);
+        nnz += block.get_nnz();
+    }
+    if (nnz > std::numeric_limits<int>::max()){
+        throw Out_of_range(std::string("Too many elements in result of ") + what);
+    }
+
+    std::vector<int> row_ptr;
+    std::vector<int> col_idx;
+    std::vector<T> vals;
+    row_ptr.reserve(rows + 1);
+    col_idx.reserve(nnz);
+    vals.reserve(nnz);
+    row_ptr.push_back(0);
+    int column_shift = 0;
+    for (const Matrix_csr<T>& block : blocks){
+        int base = row_ptr.back();
+        for (int i = 0; i < block.get_rows_number(); i++){
+            row_ptr.push_back(base + block.get_row_ptr()[i + 1]);
+        }
+        for (int col : block.get_col_idx()){
+            col_idx.push_back(col + column_shift);
+        }
+        vals.insert(vals.end(), block.get_vals().begin(), block.get_vals().end());
+        if (!same_columns) column_shift += block.get_columns_number();
+    }
+    return _make_csr(rows, columns, std::move(row_ptr), std::move(col_idx), std::move(vals));
+}
+
+/**
+ * @brief [A; B; ...]: blocks with equal number of columns one under another
+ * @throw Shape_error if numbers of columns differ, Init_error if blocks is empty
+ */
+template<class T>
+Matrix_csr<T> vstack(const Csr_blocks<T>& blocks){
+    return _stack_rows(blocks, true, "vstack");
+}
+
+/**
+ * @brief Block diagonal matrix diag(A, B, ...), blocks may be rectangular
+ * @throw Init_error if blocks is empty
+ */
+template<class T>
+Matrix_csr<T> block_diag(const Csr_blocks<T>& blocks){
+    return _stack_rows(blocks, false, "block_diag");
+}
+
+//////////////////////////////////
+
+#endif // __MatrixAssembly_H__
@@ -0,0 +1,368 @@
+/**
+ * @file Matrix_bsr.hpp
+ * @brief Block compressed sparse row (BSR) matrices with compile-time block size
+ */
+
+#ifndef __ClassMatrixBsr_H__
+#define __ClassMatrixBsr_H__
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <utility>
+
+#include "ClassMatrix.h"
+#include "../parallel/Parallel.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#ifndef TASK0_AVX2
+#define TASK0_AVX2 1
+#endif
+#endif
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#ifndef TASK0_AVX512
+#define TASK0_AVX512 1
+#endif
+#endif
+
+// Block kernels
+// Blocks are B x B dense column-major arrays, so product of block and vector is B axpy
+// of block columns: with fixed B loops are unrolled by compiler and y stays in registers.
+// For double 4 x 4 (AVX2) and 8 x 8 (AVX-512) blocks one column is one register.
+//////////////////////////////////
+
+template<class T, int B>
+struct _Bsr_kernel{
+    // y[0 .. B) = sum of blocks a[k] * x[cols[k] * B .. +B) for k < count
+    static void row(const T* a, const int* cols, int count, const T* x, T* y){
+        T acc[B];
+        for (int r = 0; r < B; r++) acc[r] = T((long) 0);
+        for (int k = 0; k < count; k++, a += B * B){
+            const T* xb = x + static_cast<size_t>(cols[k]) * B;
+            for (int c = 0; c < B; c++){
+                for (int r = 0; r < B; r++){
+                    acc[r] += a[c * B + r] * xb[c];
+                }
+            }
+        }
+        for (int r = 0; r < B; r++) y[r] = acc[r];
+    }
+
+    // C += A * Bm
+    static void gemm(const T* a, const T* b, T* c){
+        for (int j = 0; j < B; j++){
+            for (int l = 0; l < B; l++){
+                const T blj = b[j * B + l];
+                for (int r = 0; r < B; r++){
+                    c[j * B + r] += a[l * B + r] * blj;
+                }
+            }
+        }
+    }
+};
+
+#ifdef TASK0_AVX2
+template<>
+struct _Bsr_kernel<double, 4>{
+    static void row(const double* a, const int* cols, int count, const double* x, double* y){
+        __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+        for (int k = 0; k < count; k++, a += 16){
+            const double* xb = x + static_cast<size_t>(cols[k]) * 4;
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a), _mm256_broadcast_sd(xb), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + 4), _mm256_broadcast_sd(xb + 1), acc1);
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + 8), _mm256_broadcast_sd(xb + 2), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + 12), _mm256_broadcast_sd(xb + 3), acc1);
+        }
+        _mm256_storeu_pd(y, _mm256_add_pd(acc0, acc1));
+    }
+
+    static void gemm(const double* a, const double* b, double* c){
+        __m256d a0 = _mm256_loadu_pd(a), a1 = _mm256_loadu_pd(a + 4);
+        __m256d a2 = _mm256_loadu_pd(a + 8), a3 = _mm256_loadu_pd(a + 12);
+        for (int j = 0; j < 4; j++){
+            __m256d acc = _mm256_loadu_pd(c + 4 * j);
+            acc = _mm256_fmadd_pd(a0, _mm256_broadcast_sd(b + 4 * j), acc);
+            acc = _mm256_fmadd_pd(a1, _mm256_broadcast_sd(b + 4 * j + 1), acc);
+            acc = _mm256_fmadd_pd(a2, _mm256_broadcast_sd(b + 4 * j + 2), acc);
+            acc = _mm256_fmadd_pd(a3, _mm256_broadcast_sd(b + 4 * j + 3), acc);
+            _mm256_storeu_pd(c + 4 * j, acc);
+        }
+    }
+};
+#endif
+
+#ifdef TASK0_AVX512
+template<>
+struct _Bsr_kernel<double, 8>{
+    static void row(const double* a, const int* cols, int count, const double* x, double* y){
+        __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+        for (int k = 0; k < count; k++, a += 64){
+            const double* xb = x + static_cast<size_t>(cols[k]) * 8;
+            for (int c = 0; c < 8; c += 2){
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + 8 * c), _mm512_set1_pd(xb[c]), acc0);
+                acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + 8 * c + 8), _mm512_set1_pd(xb[c + 1]), acc1);
+            }
+        }
+        _mm512_storeu_pd(y, _mm512_add_pd(acc0, acc1));
+    }
+
+    static void gemm(const double* a, const double* b, double* c){
+        for (int j = 0; j < 8; j++){
+            __m512d acc = _mm512_loadu_pd(c + 8 * j);
+            for (int l = 0; l < 8; l++){
+                acc = _mm512_fmadd_pd(_mm512_loadu_pd(a + 8 * l), _mm512_set1_pd(b[8 * j + l]), acc);
+            }
+            _mm512_storeu_pd(c + 8 * j, acc);
+        }
+    }
+};
+#endif
+
+//////////////////////////////////
+
+/**
+ * @brief Block compressed sparse row snapshot of Matrix (B x B dense blocks).
+ *
+ * Matrix keeps one hash map key per value. BSR keeps one column index per block and
+ * values of block contiguously, so matrices made of small dense blocks (FEM: 3 x 3, 4 x 4)
+ * need B^2 times less indices and kernels work on whole blocks in registers (_Bsr_kernel).
+ * Blocks containing at least one non-zero value are stored (missing values are zeros).
+ * Dimensions need not be multiples of B: last block row/column is padded with zeros.
+ * Snapshot is not linked with the source matrix.
+ *
+ * @tparam T - type of matrix's elements
+ * @tparam B - block size
+ */
+template<class T, int B>
+class Matrix_bsr{
+    static_assert(B >= 1, "Block size must be positive");
+private:
+    int rows;
+    int columns;
+    int block_rows;
+    int block_columns;
+    std::vector<int> row_ptr;   // size block_rows + 1, block row i is [row_ptr[i], row_ptr[i + 1])
+    std::vector<int> col_idx;   // block column of stored block
+    std::vector<T> vals;        // B * B values of block k from k * B * B, column-major
+
+    Matrix_bsr(int _rows, int _columns);
+    void _build(const matr_vals<T>& values);
+public:
+    static constexpr int block_size = B;
+
+    explicit Matrix_bsr(const Matrix<T>& matrix);
+    // from coordinate form: throws Init_error if coordinates are outside of dimensions
+    Matrix_bsr(int _rows, int _columns, const matr_vals<T>& values);
+
+    int get_rows_number() const;
+    int get_columns_number() const;
+    int get_block_rows_number() const;
+    int get_block_columns_number() const;
+    // number of stored blocks
+    int get_blocks_number() const;
+
+    const std::vector<int>& get_row_ptr() const;
+    const std::vector<int>& get_col_idx() const;
+    const std::vector<T>& get_vals() const;
+
+    // y = A * x, block rows in parallel
+    void multiply(const T* x, T* y) const;
+    // A * other (SpGEMM on blocks), throws Shape_error
+    Matrix_bsr multiply(const Matrix_bsr& other) const;
+
+    // values less than eps are dropped
+    Matrix<T> to_matrix(double eps = Matrix<T>::default_eps) const;
+};
+
+// Constructors
+//////////////////////////////////
+
+template<class T, int B>
+Matrix_bsr<T, B>::Matrix_bsr(int _rows, int _columns):
+    rows(_rows), columns(_columns), block_rows((_rows + B - 1) / B), block_columns((_columns + B - 1) / B),
+    row_ptr((_rows + B - 1) / B + 1, 0){}
+
+template<class T, int B>
+Matrix_bsr<T, B>::Matrix_bsr(const Matrix<T>& matrix):
+    Matrix_bsr(matrix.get_rows_number(), matrix.get_columns_number()){
+    _build(matrix.get_values());
+}
+
+template<class T, int B>
+Matrix_bsr<T, B>::Matrix_bsr(int _rows, int _columns, const matr_vals<T>& values):
+    Matrix_bsr(_rows, _columns){
+    _build(values);
+}
+
+// values are sorted by (block row, block column), every run of equal blocks is one block
+template<class T, int B>
+void Matrix_bsr<T, B>::_build(const matr_vals<T>& values){
+    const T zero((long) 0);
+    std::vector<std::tuple<int, int, int, const T*>> entries;   // block row, block column, position in block
+    entries.reserve(values.size());
+    for (const auto& elem : values){
+        int i = elem.first.first, j = elem.first.second;
+        if (i < 0 || j < 0 || i >= rows || j >= columns){
+            throw Init_error("Elements coordinates must be less then dimensions, but got: ",
+                             std::to_string(i) + ", " + std::to_string(j));
+        }
+        if (elem.second == zero) continue;      // fake values made by Matrix::operator()
+        entries.emplace_back(i / B, j / B, (j % B) * B + i % B, &elem.second);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs){
+        return std::make_pair(std::get<0>(lhs), std::get<1>(lhs)) < std::make_pair(std::get<0>(rhs), std::get<1>(rhs));
+    });
+
+    for (size_t k = 0; k < entries.size(); k++){
+        int bi = std::get<0>(entries[k]), bj = std::get<1>(entries[k]);
+        if (k == 0 || bi != std::get<0>(entries[k - 1]) || bj != std::get<1>(entries[k - 1])){
+            row_ptr[bi + 1]++;
+            col_idx.push_back(bj);
+            vals.resize(vals.size() + B * B, zero);
+        }
+        vals[vals.size() - B * B + std::get<2>(entries[k])] = *std::get<3>(entries[k]);
+    }
+    for (int i = 0; i < block_rows; i++){
+        row_ptr[i + 1] += row_ptr[i];
+    }
+    TASK0_STAT(ALLOCATIONS, 4);     // row_ptr, col_idx, vals and sorted entries
+    TASK0_STAT(BYTES_MOVED, vals.size() * sizeof(T));
+}
+
+//////////////////////////////////
+
+// Methods
+//////////////////////////////////
+
+template<class T, int B>
+int Matrix_bsr<T, B>::get_rows_number() const{
+    return rows;
+}
+
+template<class T, int B>
+int Matrix_bsr<T, B>::get_columns_number() const{
+    return columns;
+}
+
+template<class T, int B>
+int Matrix_bsr<T, B>::get_block_rows_number() const{
+    return block_rows;
+}
+
+template<class T, int B>
+int Matrix_bsr<T, B>::get_block_columns_number() const{
+    return block_columns;
+}
+
+template<class T, int B>
+int Matrix_bsr<T, B>::get_blocks_number() const{
+    return col_idx.size();
+}
+
+template<class T, int B>
+const std::vector<int>& Matrix_bsr<T, B>::get_row_ptr() const{
+    return row_ptr;
+}
+
+template<class T, int B>
+const std::vector<int>& Matrix_bsr<T, B>::get_col_idx() const{
+    return col_idx;
+}
+
+template<class T, int B>
+const std::vector<T>& Matrix_bsr<T, B>::get_vals() const{
+    return vals;
+}
+
+template<class T, int B>
+void Matrix_bsr<T, B>::multiply(const T* x, T* y) const{
+    // padded copies when dimensions are not multiples of B
+    std::vector<T> x_pad, y_tail(B);
+    if (columns % B != 0){
+        x_pad.assign(static_cast<size_t>(block_columns) * B, T((long) 0));
+        std::copy(x, x + columns, x_pad.begin());
+        x = x_pad.data();
+    }
+    int full_rows = rows / B;
+    parallel_for(block_rows, [&](size_t begin, size_t end){
+        for (size_t i = begin; i < end; i++){
+            T* out = static_cast<int>(i) < full_rows ? y + i * B : y_tail.data();
+            _Bsr_kernel<T, B>::row(vals.data() + static_cast<size_t>(row_ptr[i]) * B * B, col_idx.data() + row_ptr[i],
+                                   row_ptr[i + 1] - row_ptr[i], x, out);
+        }
+    });
+    if (full_rows < block_rows){
+        std::copy(y_tail.begin(), y_tail.begin() + (rows - full_rows * B), y + static_cast<size_t>(full_rows) * B);
+    }
+}
+
+// Gustavson's algorithm on blocks: block row of result is accumulated in dense blocks
+// indexed by marker of block columns
+template<class T, int B>
+Matrix_bsr<T, B> Matrix_bsr<T, B>::multiply(const Matrix_bsr& other) const{
+    if (columns != other.rows){
+        throw Shape_error("Wrong shapes for BSR matrix product: ", {rows, columns}, {other.rows, other.columns});
+    }
+    const T zero((long) 0);
+    Matrix_bsr<T, B> res(rows, other.columns);
+    std::vector<int> marker(other.block_columns, -1), pattern;
+    std::vector<T> acc;
+    for (int i = 0; i < block_rows; i++){
+        pattern.clear();
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            int l = col_idx[k];
+            for (int t = other.row_ptr[l]; t < other.row_ptr[l + 1]; t++){
+                int j = other.col_idx[t];
+                if (marker[j] < 0){
+                    marker[j] = pattern.size();
+                    pattern.push_back(j);
+                    acc.resize(pattern.size() * B * B);
+                    std::fill(acc.end() - B * B, acc.end(), zero);
+                }
+                _Bsr_kernel<T, B>::gemm(vals.data() + static_cast<size_t>(k) * B * B,
+                                        other.vals.data() + static_cast<size_t>(t) * B * B,
+                                        acc.data() + static_cast<size_t>(marker[j]) * B * B);
+            }
+        }
+        std::sort(pattern.begin(), pattern.end());
+        for (int j : pattern){
+            const T* block = acc.data() + static_cast<size_t>(marker[j]) * B * B;
+            marker[j] = -1;
+            if (std::all_of(block, block + B * B, [&zero](const T& val){ return val == zero; })) continue;
+            res.col_idx.push_back(j);
+            res.vals.insert(res.vals.end(), block, block + B * B);
+        }
+        res.row_ptr[i + 1] = res.col_idx.size();
+    }
+    return res;
+}
+
+template<class T, int B>
+Matrix<T> Matrix_bsr<T, B>::to_matrix(double eps) const{
+    const T zero((long) 0);
+    matr_vals<T> tmp_vals;
+    tmp_vals.reserve(vals.size());
+    for (int bi = 0; bi < block_rows; bi++){
+        for (int k = row_ptr[bi]; k < row_ptr[bi + 1]; k++){
+            const T* block = vals.data() + static_cast<size_t>(k) * B * B;
+            for (int c = 0; c < B; c++){
+                for (int r = 0; r < B; r++){
+                    int i = bi * B + r, j = col_idx[k] * B + c;
+                    if (i < rows && j < columns && !(block[c * B + r] == zero)){
+                        tmp_vals[{i, j}] = block[c * B + r];
+                    }
+                }
+            }
+        }
+    }
+    return Matrix<T>(rows, columns, std::move(tmp_vals), eps);
+}
+
+//////////////////////////////////
+
+#endif // __ClassMatrixBsr_H__
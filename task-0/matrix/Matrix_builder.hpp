@@ -0,0 +1,252 @@
+/**
+ * @file Matrix_builder.hpp
+ * @brief Bulk construction of matrices from (row, column, value) triplets with parallel radix sort
+ */
+
+#ifndef __MatrixBuilder_H__
+#define __MatrixBuilder_H__
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+
+#include "ClassMatrix.h"
+#include "../parallel/Parallel.hpp"
+#include "../stats/Stats.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+// what to do with triplets of the same coordinates
+enum class Duplicates{
+    SUM,            // values are added
+    OVERWRITE,      // last added value is kept
+};
+
+/**
+ * @brief Triplet (COO) builder of Matrix and Matrix_csr.
+ *
+ * Triplets are appended to three arrays (no hashing). build_csr() packs coordinates in
+ * one key row * columns + column, sorts keys by stable LSD radix sort (8-bit digits, only
+ * digits needed for rows * columns keys; histograms and scatter of chunks run in parallel,
+ * so order of equal keys is order of adding), merges equal keys and writes compressed
+ * arrays in one pass. build() makes Matrix with exactly reserved hash map.
+ * Values which are exactly zero after merging are not stored.
+ *
+ * @tparam T - type of matrix's elements
+ */
+template<class T>
+class Matrix_builder{
+private:
+    int rows;
+    int columns;
+    std::vector<int> row_idx;
+    std::vector<int> col_idx;
+    std::vector<T> vals;
+
+    void _check(int i, int j) const;
+    // positions of triplets ordered by (row, column), equal coordinates in order of adding;
+    // keys: sorted packed coordinates
+    std::vector<size_t> _sorted_order(std::vector<uint64_t>& keys, const Parallel_policy& policy) const;
+    // f(i, j, value) for merged triplets in order of (row, column)
+    template<class F>
+    void _for_each_merged(Duplicates mode, const Parallel_policy& policy, F f) const;
+public:
+    Matrix_builder(int _rows, int _columns);
+
+    void reserve(size_t count);
+    // throws Init_error if coordinates are outside of dimensions
+    void add(int i, int j, const T& val);
+    // bulk append, throws Shape_error if sizes of arrays differ
+    void add(const std::vector<int>& rows_idx, const std::vector<int>& columns_idx, const std::vector<T>& values);
+    // number of added triplets
+    size_t size() const;
+    void clear();
+
+    Matrix_csr<T> build_csr(Duplicates mode = Duplicates::SUM,
+                            const Parallel_policy& policy = default_parallel_policy()) const;
+    Matrix<T> build(Duplicates mode = Duplicates::SUM, double eps = Matrix<T>::default_eps,
+                    const Parallel_policy& policy = default_parallel_policy()) const;
+};
+
+// Constructors
+//////////////////////////////////
+
+template<class T>
+Matrix_builder<T>::Matrix_builder(int _rows, int _columns): rows(_rows), columns(_columns){
+    if (rows < 0 || columns < 0){
+        throw Init_error("Negative dimensions of matrix: ", std::to_string(rows) + ", " + std::to_string(columns));
+    }
+}
+
+//////////////////////////////////
+
+// Methods
+//////////////////////////////////
+
+template<class T>
+void Matrix_builder<T>::_check(int i, int j) const{
+    if (static_cast<unsigned>(i) >= static_cast<unsigned>(rows) ||
+        static_cast<unsigned>(j) >= static_cast<unsigned>(columns)){
+        throw Init_error("Elements coordinates must be less then dimensions, but got: ",
+                         std::to_string(i) + ", " + std::to_string(j));
+    }
+}
+
+template<class T>
+void Matrix_builder<T>::reserve(size_t count){
+    row_idx.reserve(count);
+    col_idx.reserve(count);
+    vals.reserve(count);
+}
+
+template<class T>
+void Matrix_builder<T>::add(int i, int j, const T& val){
+    _check(i, j);
+    row_idx.push_back(i);
+    col_idx.push_back(j);
+    vals.push_back(val);
+}
+
+template<class T>
+void Matrix_builder<T>::add(const std::vector<int>& rows_idx, const std::vector<int>& columns_idx,
+                            const std::vector<T>& values){
+    if (rows_idx.size() != columns_idx.size() || rows_idx.size() != values.size()){
+        throw Shape_error("Triplet arrays must have equal sizes: ", (int) rows_idx.size(), (int) values.size());
+    }
+    for (size_t k = 0; k < rows_idx.size(); k++){
+        _check(rows_idx[k], columns_idx[k]);
+    }
+    row_idx.insert(row_idx.end(), rows_idx.begin(), rows_idx.end());
+    col_idx.insert(col_idx.end(), columns_idx.begin(), columns_idx.end());
+    vals.insert(vals.end(), values.begin(), values.end());
+}
+
+template<class T>
+size_t Matrix_builder<T>::size() const{
+    return vals.size();
+}
+
+template<class T>
+void Matrix_builder<T>::clear(){
+    row_idx.clear();
+    col_idx.clear();
+    vals.clear();
+}
+
+template<class T>
+std::vector<size_t> Matrix_builder<T>::_sorted_order(std::vector<uint64_t>& keys, const Parallel_policy& policy) const{
+    constexpr int digit_bits = 8;
+    constexpr size_t digits = size_t(1) << digit_bits;
+    size_t n = vals.size();
+    keys.resize(n);
+    if (n == 0) return {};
+
+    std::vector<uint64_t> keys_tmp(n);
+    std::vector<size_t> order(n), order_tmp(n);
+    TASK0_STAT(ALLOCATIONS, 4);
+    TASK0_STAT(BYTES_MOVED, 2 * n * (sizeof(uint64_t) + sizeof(size_t)));
+    parallel_for(n, [&](size_t begin, size_t end){
+        for (size_t k = begin; k < end; k++){
+            keys[k] = static_cast<uint64_t>(row_idx[k]) * static_cast<uint64_t>(columns) + col_idx[k];
+            order[k] = k;
+        }
+    }, policy);
+
+    int key_bits = 0;     // keys are less than rows * columns
+    for (uint64_t max_key = static_cast<uint64_t>(rows) * columns - 1; key_bits < 64 && (max_key >> key_bits); key_bits++);
+    size_t chunk = n < policy.min_size ? std::max<size_t>(n, 1) : std::max<size_t>(policy.chunk, 1);
+    size_t chunks = (n + chunk - 1) / chunk;
+    std::vector<std::array<size_t, digits>> offsets(chunks);
+
+    for (int shift = 0; shift < key_bits; shift += digit_bits){
+        // histograms of chunks
+        Thread_pool::instance().run(chunks, policy.threads, [&](size_t c){
+            std::array<size_t, digits>& count = offsets[c];
+            count.fill(0);
+            for (size_t k = c * chunk; k < std::min(n, (c + 1) * chunk); k++){
+                count[(keys[k] >> shift) & (digits - 1)]++;
+            }
+        });
+        // start of (digit, chunk): all smaller digits, then same digit of previous chunks
+        size_t pos = 0;
+        for (size_t d = 0; d < digits; d++){
+            for (size_t c = 0; c < chunks; c++){
+                size_t count = offsets[c][d];
+                offsets[c][d] = pos;
+                pos += count;
+            }
+        }
+        // stable scatter
+        Thread_pool::instance().run(chunks, policy.threads, [&](size_t c){
+            std::array<size_t, digits>& next = offsets[c];
+            for (size_t k = c * chunk; k < std::min(n, (c + 1) * chunk); k++){
+                size_t dst = next[(keys[k] >> shift) & (digits - 1)]++;
+                keys_tmp[dst] = keys[k];
+                order_tmp[dst] = order[k];
+            }
+        });
+        keys.swap(keys_tmp);
+        order.swap(order_tmp);
+    }
+    return order;
+}
+
+template<class T>
+template<class F>
+void Matrix_builder<T>::_for_each_merged(Duplicates mode, const Parallel_policy& policy, F f) const{
+    const T zero((long) 0);
+    std::vector<uint64_t> keys;
+    std::vector<size_t> order = _sorted_order(keys, policy);
+    for (size_t k = 0; k < order.size(); ){
+        uint64_t key = keys[k];
+        T val = vals[order[k]];
+        for (k++; k < order.size() && keys[k] == key; k++){
+            if (mode == Duplicates::SUM) val += vals[order[k]]; else val = vals[order[k]];
+        }
+        if (!(val == zero)) f(key / columns, key % columns, std::move(val));
+    }
+}
+
+template<class T>
+Matrix_csr<T> Matrix_builder<T>::build_csr(Duplicates mode, const Parallel_policy& policy) const{
+    std::vector<int> row_ptr(rows + 1, 0), csr_cols;
+    std::vector<T> csr_vals;
+    csr_cols.reserve(vals.size());
+    csr_vals.reserve(vals.size());
+    _for_each_merged(mode, policy, [&](int i, int j, T&& val){
+        if (csr_cols.size() == static_cast<size_t>(std::numeric_limits<int>::max())){
+            throw Out_of_range("Too many elements for compressed storage");
+        }
+        row_ptr[i + 1]++;
+        csr_cols.push_back(j);
+        csr_vals.push_back(std::move(val));
+    });
+    for (int i = 0; i < rows; i++){
+        row_ptr[i + 1] += row_ptr[i];
+    }
+    TASK0_STAT(ALLOCATIONS, 3);
+    TASK0_STAT(BYTES_MOVED, csr_vals.size() * (sizeof(int) + sizeof(T)));
+    return Matrix_csr<T>(rows, columns, std::move(row_ptr), std::move(csr_cols), std::move(csr_vals));
+}
+
+template<class T>
+Matrix<T> Matrix_builder<T>::build(Duplicates mode, double eps, const Parallel_policy& policy) const{
+    std::vector<std::pair<coords, T>> merged;
+    merged.reserve(vals.size());
+    _for_each_merged(mode, policy, [&](int i, int j, T&& val){
+        merged.emplace_back(coords(i, j), std::move(val));
+    });
+    matr_vals<T> tmp_vals;
+    tmp_vals.reserve(merged.size());
+    for (auto& elem : merged){
+        tmp_vals.emplace(elem.first, std::move(elem.second));
+    }
+    return Matrix<T>(rows, columns, std::move(tmp_vals), eps);
+}
+
+//////////////////////////////////
+
+#endif // __MatrixBuilder_H__
@@ -0,0 +1,214 @@
+#ifndef __ClassMatrixCsr_H__
+#define __ClassMatrixCsr_H__
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "ClassMatrix.h"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+/**
+ * @brief Compressed sparse row (CSR) snapshot of Matrix.
+ *
+ * Matrix keeps its values in a hash map, which is convenient for element access
+ * but slow for repeated scans. Matrix_csr copies values once into three arrays
+ * (row_ptr, col_idx, vals) with columns sorted inside each row, so kernels
+ * (SpMV, preconditioners, solvers) can stream through the matrix.
+ * Snapshot is not linked with the source matrix: later changes of matrix are not visible.
+ *
+ * @tparam T - type of matrix's elements
+ */
+template<class T>
+class Matrix_csr{
+private:
+    int rows;
+    int columns;
+    std::vector<int> row_ptr;   // size rows + 1, row i is [row_ptr[i], row_ptr[i + 1])
+    std::vector<int> col_idx;
+    std::vector<T> vals;
+public:
+    explicit Matrix_csr(const Matrix<T>& matrix);
+    // from compressed arrays (moved, columns strictly increasing in rows), throws Init_error
+    Matrix_csr(int _rows, int _columns, std::vector<int> _row_ptr, std::vector<int> _col_idx, std::vector<T> _vals);
+
+    int get_rows_number() const;
+    int get_columns_number() const;
+    // number of stored elements
+    int get_nnz() const;
+
+    const std::vector<int>& get_row_ptr() const;
+    const std::vector<int>& get_col_idx() const;
+    const std::vector<T>& get_vals() const;
+    std::vector<T>& get_vals();     // for in-place factorizations with same pattern
+
+    // y = A * x, x has get_columns_number() elements, y has get_rows_number() elements
+    void multiply(const T* x, T* y) const;
+
+    // Y = A * X for block of count vectors (SpMM). Blocks are row-major: x[j * count + v] is
+    // element j of vector v. Every element of A is read once for all count vectors.
+    void multiply_block(const T* x, T* y, int count) const;
+
+    // main diagonal (zero if element is missing)
+    std::vector<T> get_diagonal() const;
+
+    // values less than eps are dropped (snapshot has no eps of its own)
+    Matrix<T> to_matrix(double eps = Matrix<T>::default_eps) const;
+};
+
+// Constructors
+//////////////////////////////////
+
+template<class T>
+Matrix_csr<T>::Matrix_csr(const Matrix<T>& matrix):
+    rows(matrix.rows), columns(matrix.columns), row_ptr(matrix.rows + 1, 0){
+    const T zero((long) 0);
+    for (const auto& elem : matrix.values){
+        if (elem.second == zero) continue;      // fake values made by Matrix::operator()
+        row_ptr[elem.first.first + 1]++;
+    }
+    for (int i = 0; i < rows; i++){
+        row_ptr[i + 1] += row_ptr[i];
+    }
+
+    TASK0_STAT(ALLOCATIONS, 4);     // row_ptr, col_idx, vals and buffer of rows
+    TASK0_STAT(BYTES_MOVED, 2 * static_cast<size_t>(row_ptr[rows]) * (sizeof(int) + sizeof(T)));
+    std::vector<std::pair<int, T>> row_elems(row_ptr[rows]);
+    std::vector<int> next(row_ptr.begin(), row_ptr.end() - 1);
+    for (const auto& elem : matrix.values){
+        if (elem.second == zero) continue;
+        row_elems[next[elem.first.first]++] = {elem.first.second, elem.second};
+    }
+
+    col_idx.reserve(row_elems.size());
+    vals.reserve(row_elems.size());
+    for (int i = 0; i < rows; i++){
+        auto row_begin = row_elems.begin() + row_ptr[i];
+        auto row_end = row_elems.begin() + row_ptr[i + 1];
+        std::sort(row_begin, row_end, [](const std::pair<int, T>& lhs, const std::pair<int, T>& rhs){
+            return lhs.first < rhs.first;
+        });
+        for (auto it = row_begin; it != row_end; it++){
+            col_idx.push_back(it->first);
+            vals.push_back(std::move(it->second));
+        }
+    }
+}
+
+template<class T>
+Matrix_csr<T>::Matrix_csr(int _rows, int _columns, std::vector<int> _row_ptr, std::vector<int> _col_idx,
+                          std::vector<T> _vals):
+    rows(_rows), columns(_columns), row_ptr(std::move(_row_ptr)), col_idx(std::move(_col_idx)), vals(std::move(_vals)){
+    if (rows < 0 || columns < 0 || static_cast<int>(row_ptr.size()) != rows + 1 || row_ptr[0] != 0 ||
+        static_cast<size_t>(row_ptr[rows]) != col_idx.size() || col_idx.size() != vals.size()){
+        throw Init_error("Inconsistent sizes of CSR arrays");
+    }
+    for (int i = 0; i < rows; i++){
+        if (row_ptr[i] > row_ptr[i + 1]){
+            throw Init_error("Row pointers of CSR arrays must not decrease, row: ", std::to_string(i));
+        }
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            if (col_idx[k] < 0 || col_idx[k] >= columns || (k > row_ptr[i] && col_idx[k] <= col_idx[k - 1])){
+                throw Init_error("Columns of CSR row must be increasing and less then dimension, row: ", std::to_string(i));
+            }
+        }
+    }
+}
+
+//////////////////////////////////
+
+// Methods
+//////////////////////////////////
+
+template<class T>
+int Matrix_csr<T>::get_rows_number() const{
+    return rows;
+}
+
+template<class T>
+int Matrix_csr<T>::get_columns_number() const{
+    return columns;
+}
+
+template<class T>
+int Matrix_csr<T>::get_nnz() const{
+    return vals.size();
+}
+
+template<class T>
+const std::vector<int>& Matrix_csr<T>::get_row_ptr() const{
+    return row_ptr;
+}
+
+template<class T>
+const std::vector<int>& Matrix_csr<T>::get_col_idx() const{
+    return col_idx;
+}
+
+template<class T>
+const std::vector<T>& Matrix_csr<T>::get_vals() const{
+    return vals;
+}
+
+template<class T>
+std::vector<T>& Matrix_csr<T>::get_vals(){
+    return vals;
+}
+
+template<class T>
+void Matrix_csr<T>::multiply(const T* x, T* y) const{
+    for (int i = 0; i < rows; i++){
+        T sum((long) 0);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            sum += vals[k] * x[col_idx[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+template<class T>
+void Matrix_csr<T>::multiply_block(const T* x, T* y, int count) const{
+    const T zero((long) 0);
+    for (int i = 0; i < rows; i++){
+        T* y_row = y + static_cast<size_t>(i) * count;
+        std::fill(y_row, y_row + count, zero);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            const T& a = vals[k];
+            const T* x_row = x + static_cast<size_t>(col_idx[k]) * count;
+            for (int v = 0; v < count; v++){
+                y_row[v] += a * x_row[v];
+            }
+        }
+    }
+}
+
+template<class T>
+std::vector<T> Matrix_csr<T>::get_diagonal() const{
+    std::vector<T> diag(std::min(rows, columns), T((long) 0));
+    for (int i = 0; i < (int) diag.size(); i++){
+        auto row_begin = col_idx.begin() + row_ptr[i];
+        auto row_end = col_idx.begin() + row_ptr[i + 1];
+        auto it = std::lower_bound(row_begin, row_end, i);
+        if (it != row_end && *it == i){
+            diag[i] = vals[it - col_idx.begin()];
+        }
+    }
+    return diag;
+}
+
+template<class T>
+Matrix<T> Matrix_csr<T>::to_matrix(double eps) const{
+    matr_vals<T> tmp_vals;
+    tmp_vals.reserve(vals.size());
+    for (int i = 0; i < rows; i++){
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            tmp_vals[{i, col_idx[k]}] = vals[k];
+        }
+    }
+    return Matrix<T>(rows, columns, tmp_vals, eps);
+}
+
+//////////////////////////////////
+
+#endif // __ClassMatrixCsr_H__
@@ -0,0 +1,340 @@
+/**
+ * @file Matrix_expressions.hpp
+ * @brief Lazy (expression template) arithmetic for Matrix
+ */
+
+#ifndef __MatrixExpressions_H__
+#define __MatrixExpressions_H__
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include "../exceptions/CommonExceptions.hpp"
+#include "../stats/Stats.hpp"
+
+template<class T>
+class Matrix;
+
+template<class T>
+class Matrix_csr;
+
+#ifndef __Matr_vals__
+#define __Matr_vals__
+struct pair_hash{
+    template <class T1, class T2>
+    std::size_t operator() (const std::pair<T1, T2>& pair) const {
+        TASK0_STAT(HASH_PROBES, 1);
+        return std::hash<T1>()(pair.first) ^ std::hash<T2>()(pair.second);
+    }
+};
+
+using coords = std::pair<int, int>;
+
+template<class T>
+using matr_vals = std::unordered_map<coords, T, pair_hash>;
+#endif  //__Matr_vals__
+
+/**
+ * @brief Multiplier of expression term: dst += (-1)^negative * factor * val.
+ *
+ * factor == nullptr means 1, so plain sums don't pay for multiplications.
+ */
+template<class T>
+struct Linear_scale{
+    bool negative = false;
+    const T* factor = nullptr;
+
+    Linear_scale negated() const{
+        return {!negative, factor};
+    }
+
+    template<class U>
+    void add_to(T& dst, const U& val) const{
+        if (factor){
+            T term = *factor * val;
+            if (negative) dst -= term; else dst += term;
+        } else {
+            if (negative) dst -= val; else dst += val;
+        }
+    }
+};
+
+/**
+ * @brief Base of all lazy matrix expressions (CRTP).
+ *
+ * Operators +, -, * return expression nodes instead of matrices. Nothing is computed
+ * until expression is assigned to Matrix (or Matrix is constructed from it): then all
+ * terms are accumulated into one hash map and eps filter is applied once.
+ * Leaves (matrices) are stored by reference, so expression must not outlive its operands.
+ *
+ * Every node provides value_type, get_rows_number(), get_columns_number(), get_eps()
+ * (smallest eps of operands: result keeps values kept by every operand) and
+ * accumulate(acc, scale): acc += scale * node.
+ */
+template<class E>
+struct Matrix_expression{
+    const E& derived() const{
+        return static_cast<const E&>(*this);
+    }
+};
+
+template<class E>
+struct is_matrix: std::false_type {};
+
+template<class T>
+struct is_matrix<Matrix<T>>: std::true_type {};
+
+template<class E>
+struct is_matrix_expression: std::is_base_of<Matrix_expression<E>, E> {};
+
+template<class E>
+constexpr bool is_matrix_operand_v = is_matrix<E>::value || is_matrix_expression<E>::value;
+
+// leaves are stored by reference, nodes by value
+template<class E>
+using matrix_operand_t = std::conditional_t<is_matrix<E>::value, const E&, const E>;
+
+// Accumulation of operands
+//////////////////////////////////
+
+template<class U, class T>
+void _accumulate(const Matrix<T>& matrix, matr_vals<U>& acc, const Linear_scale<U>& scale){
+    for (const auto& elem : matrix.get_values()){
+        scale.add_to(acc[elem.first], elem.second);
+    }
+}
+
+template<class U, class E, class = std::enable_if_t<is_matrix_expression<E>::value>>
+void _accumulate(const E& expr, matr_vals<U>& acc, const Linear_scale<U>& scale){
+    expr.accumulate(acc, scale);
+}
+
+// operand as Matrix (expressions are evaluated with their eps)
+template<class T>
+const Matrix<T>& _materialize_matrix(const Matrix<T>& matrix){
+    return matrix;
+}
+
+template<class E, class = std::enable_if_t<is_matrix_expression<E>::value>>
+Matrix<typename E::value_type> _materialize_matrix(const E& expr){
+    return Matrix<typename E::value_type>(expr);
+}
+
+//////////////////////////////////
+
+// Expression nodes
+//////////////////////////////////
+
+// lhs + rhs or lhs - rhs
+template<class L, class R>
+class Matrix_sum: public Matrix_expression<Matrix_sum<L, R>>{
+private:
+    matrix_operand_t<L> lhs;
+    matrix_operand_t<R> rhs;
+    bool subtract;
+public:
+    using value_type = typename L::value_type;
+
+    Matrix_sum(const L& _lhs, const R& _rhs, bool _subtract): lhs(_lhs), rhs(_rhs), subtract(_subtract) {};
+
+    int get_rows_number() const { return lhs.get_rows_number(); }
+    int get_columns_number() const { return lhs.get_columns_number(); }
+    double get_eps() const { return std::min(lhs.get_eps(), rhs.get_eps()); }
+    const L& get_lhs() const { return lhs; }
+    const R& get_rhs() const { return rhs; }
+    bool is_subtraction() const { return subtract; }
+
+    template<class U>
+    void accumulate(matr_vals<U>& acc, const Linear_scale<U>& scale) const{
+        _accumulate(lhs, acc, scale);
+        _accumulate(rhs, acc, subtract ? scale.negated() : scale);
+    }
+};
+
+// -expr (unary minus of a leaf is computed eagerly by Matrix::operator-)
+template<class E>
+class Matrix_negate: public Matrix_expression<Matrix_negate<E>>{
+private:
+    matrix_operand_t<E> expr;
+public:
+    using value_type = typename E::value_type;
+
+    explicit Matrix_negate(const E& _expr): expr(_expr) {};
+
+    int get_rows_number() const { return expr.get_rows_number(); }
+    int get_columns_number() const { return expr.get_columns_number(); }
+    double get_eps() const { return expr.get_eps(); }
+
+    template<class U>
+    void accumulate(matr_vals<U>& acc, const Linear_scale<U>& scale) const{
+        _accumulate(expr, acc, scale.negated());
+    }
+};
+
+// expr * scalar
+template<class E, class S>
+class Matrix_scaled: public Matrix_expression<Matrix_scaled<E, S>>{
+private:
+    matrix_operand_t<E> expr;
+    S scalar;
+public:
+    using value_type = typename E::value_type;
+
+    Matrix_scaled(const E& _expr, const S& _scalar): expr(_expr), scalar(_scalar) {};
+
+    int get_rows_number() const { return expr.get_rows_number(); }
+    int get_columns_number() const { return expr.get_columns_number(); }
+    double get_eps() const { return expr.get_eps(); }
+
+    template<class U>
+    void accumulate(matr_vals<U>& acc, const Linear_scale<U>& scale) const{
+        U factor = scale.factor ? *scale.factor * U(scalar) : U(scalar);
+        _accumulate(expr, acc, Linear_scale<U>{scale.negative, &factor});
+    }
+};
+
+/**
+ * @brief lhs * rhs
+ *
+ * Row-by-row (Gustavson) product: row i of result is accumulated in dense buffer
+ * from rows of rhs selected by non-zeros of row i of lhs, then flushed to result once.
+ * Work is proportional to number of non-trivial products, not to rows * columns * inner.
+ */
+template<class L, class R>
+class Matrix_product: public Matrix_expression<Matrix_product<L, R>>{
+private:
+    matrix_operand_t<L> lhs;
+    matrix_operand_t<R> rhs;
+public:
+    using value_type = typename L::value_type;
+
+    Matrix_product(const L& _lhs, const R& _rhs): lhs(_lhs), rhs(_rhs) {};
+
+    int get_rows_number() const { return lhs.get_rows_number(); }
+    int get_columns_number() const { return rhs.get_columns_number(); }
+    double get_eps() const { return std::min(lhs.get_eps(), rhs.get_eps()); }
+
+    template<class U>
+    void accumulate(matr_vals<U>& acc, const Linear_scale<U>& scale) const{
+        using T = value_type;
+        Matrix_csr<T> a(_materialize_matrix(lhs));
+        Matrix_csr<typename R::value_type> b(_materialize_matrix(rhs));
+        const std::vector<int>& a_ptr = a.get_row_ptr();
+        const std::vector<int>& a_col = a.get_col_idx();
+        const std::vector<int>& b_ptr = b.get_row_ptr();
+        const std::vector<int>& b_col = b.get_col_idx();
+
+        std::vector<T> row_acc(get_columns_number(), T((long) 0));
+        std::vector<int> marker(get_columns_number(), -1);
+        std::vector<int> row_pattern;
+        for (int i = 0; i < a.get_rows_number(); i++){
+            row_pattern.clear();
+            for (int k = a_ptr[i]; k < a_ptr[i + 1]; k++){
+                const T& a_val = a.get_vals()[k];
+                for (int t = b_ptr[a_col[k]]; t < b_ptr[a_col[k] + 1]; t++){
+                    int j = b_col[t];
+                    if (marker[j] != i){
+                        marker[j] = i;
+                        row_pattern.push_back(j);
+                    }
+                    row_acc[j] += a_val * b.get_vals()[t];
+                }
+            }
+            for (int j : row_pattern){
+                scale.add_to(acc[{i, j}], row_acc[j]);
+                row_acc[j] = T((long) 0);
+            }
+        }
+    }
+};
+
+//////////////////////////////////
+
+// Evaluation
+//////////////////////////////////
+
+template<class E>
+struct is_matrix_sum: std::false_type {};
+
+template<class L, class R>
+struct is_matrix_sum<Matrix_sum<L, R>>: std::true_type {};
+
+/**
+ * @brief Values of expression (eps filter is not applied)
+ *
+ * Fused kernel for C + expr, expr + C, C - expr (C is matrix): result starts as copy of C
+ * and expr is accumulated into it, so e.g. A * B + C (gemm) needs neither temporary
+ * product nor per-element insertion of C.
+ */
+template<class T, class E>
+matr_vals<T> _evaluate_matrix_expression(const E& expr){
+    matr_vals<T> acc;
+    Linear_scale<T> unit;
+    if constexpr (is_matrix_sum<E>::value){
+        using L = std::decay_t<decltype(expr.get_lhs())>;
+        using R = std::decay_t<decltype(expr.get_rhs())>;
+        if constexpr (std::is_same<L, Matrix<T>>::value){
+            acc = expr.get_lhs().get_values();
+            _accumulate(expr.get_rhs(), acc, expr.is_subtraction() ? unit.negated() : unit);
+            return acc;
+        } else if constexpr (std::is_same<R, Matrix<T>>::value){
+            if (!expr.is_subtraction()){
+                acc = expr.get_rhs().get_values();
+                _accumulate(expr.get_lhs(), acc, unit);
+                return acc;
+            }
+        }
+    }
+    _accumulate(expr, acc, unit);
+    return acc;
+}
+
+//////////////////////////////////
+
+// Operators
+//////////////////////////////////
+
+template<class L, class R, class = std::enable_if_t<is_matrix_operand_v<L> && is_matrix_operand_v<R>>>
+Matrix_sum<L, R> operator+(const L& lhs, const R& rhs){
+    if (lhs.get_rows_number() != rhs.get_rows_number() || lhs.get_columns_number() != rhs.get_columns_number()){
+        throw Shape_error("Wrong shape for operation '+': ", {lhs.get_rows_number(), lhs.get_columns_number()},
+                          {rhs.get_rows_number(), rhs.get_columns_number()});
+    }
+    return Matrix_sum<L, R>(lhs, rhs, false);
+}
+
+template<class L, class R, class = std::enable_if_t<is_matrix_operand_v<L> && is_matrix_operand_v<R>>>
+Matrix_sum<L, R> operator-(const L& lhs, const R& rhs){
+    if (lhs.get_rows_number() != rhs.get_rows_number() || lhs.get_columns_number() != rhs.get_columns_number()){
+        throw Shape_error("Wrong shape for operation '-': ", {lhs.get_rows_number(), lhs.get_columns_number()},
+                          {rhs.get_rows_number(), rhs.get_columns_number()});
+    }
+    return Matrix_sum<L, R>(lhs, rhs, true);
+}
+
+template<class L, class R, class = std::enable_if_t<is_matrix_operand_v<L> && is_matrix_operand_v<R>>>
+Matrix_product<L, R> operator*(const L& lhs, const R& rhs){
+    if (lhs.get_columns_number() != rhs.get_rows_number()){
+        throw Shape_error("Wrong shape for operation '*': ", {lhs.get_rows_number(), lhs.get_columns_number()},
+                          {rhs.get_rows_number(), rhs.get_columns_number()});
+    }
+    return Matrix_product<L, R>(lhs, rhs);
+}
+
+template<class E, class = std::enable_if_t<is_matrix_expression<E>::value>>
+Matrix_negate<E> operator-(const E& expr){
+    return Matrix_negate<E>(expr);
+}
+
+template<class E, class S, class = std::enable_if_t<is_matrix_operand_v<E> && !is_matrix_operand_v<S> &&
+                                                    std::is_convertible<S, typename E::value_type>::value>>
+Matrix_scaled<E, S> operator*(const E& expr, const S& scalar){
+    return Matrix_scaled<E, S>(expr, scalar);
+}
+
+//////////////////////////////////
+
+#endif // __MatrixExpressions_H__
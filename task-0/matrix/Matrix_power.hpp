@@ -0,0 +1,250 @@
+/**
+ * @file Matrix_power.hpp
+ * @brief Integer powers of square sparse matrices (exponentiation by squaring)
+ */
+
+#ifndef __MatrixPower_H__
+#define __MatrixPower_H__
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "ClassMatrix.h"
+#include "Matrix_csr.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+struct Power_params{
+    bool track_fill = true;         // switch to dense storage when fill passes threshold
+    double dense_threshold = 0.25;  // nnz / (n * n) when dense storage becomes cheaper
+};
+
+/**
+ * @brief Powers A^k of square matrix with O(log k) multiplications.
+ *
+ * Intermediate matrices are kept in CSR arrays (or dense row-major array once fill of
+ * power passes threshold: powers of irreducible matrices, e.g. Markov chains, become dense
+ * quickly, and then flat array is faster than sparse accumulation). All buffers (operands,
+ * scratch product, row accumulator) are members and are reused between squarings and
+ * between calls of pow, so repeated powers of one matrix don't reallocate.
+ * Exact zeros are kept in intermediate results, eps filter is applied to final Matrix only.
+ *
+ * @tparam T - type of matrix's elements
+ */
+template<class T>
+class Matrix_power{
+private:
+    // square n x n matrix in CSR or dense row-major storage
+    struct Operand{
+        bool dense = false;
+        std::vector<int> row_ptr;
+        std::vector<int> col_idx;
+        std::vector<T> vals;        // CSR values or n * n dense values
+    };
+
+    int n;
+    Power_params params;
+    double eps;             // drop tolerance of source matrix, passed to result
+    Operand source;
+    Operand base, result, scratch;
+    std::vector<T> row_acc;
+    std::vector<int> marker;
+    std::vector<int> row_pattern;
+    bool dense_used = false;
+
+    void to_dense(Operand& op);
+    void update_storage(Operand& op);
+    void multiply(const Operand& lhs, const Operand& rhs, Operand& res);
+    Matrix<T> to_matrix(const Operand& op) const;
+public:
+    explicit Matrix_power(const Matrix<T>& matrix, const Power_params& _params = Power_params());
+
+    Matrix<T> pow(unsigned long long k);
+    // true if dense storage was used by some call of pow
+    bool used_dense() const;
+};
+
+/**
+ * @brief A^k (A^0 is identity)
+ *
+ * @throw Shape_error if matrix is not square
+ */
+template<class T>
+Matrix<T> pow(const Matrix<T>& matrix, unsigned long long k, const Power_params& params = Power_params()){
+    return Matrix_power<T>(matrix, params).pow(k);
+}
+
+// Constructors
+//////////////////////////////////
+
+template<class T>
+Matrix_power<T>::Matrix_power(const Matrix<T>& matrix, const Power_params& _params):
+    n(matrix.get_rows_number()), params(_params), eps(matrix.get_eps()){
+    if (n != matrix.get_columns_number()){
+        throw Shape_error("Power is defined only for square matrix, got: ", n, matrix.get_columns_number());
+    }
+    Matrix_csr<T> csr(matrix);
+    source.row_ptr = csr.get_row_ptr();
+    source.col_idx = csr.get_col_idx();
+    source.vals = csr.get_vals();
+    row_acc.assign(n, T((long) 0));
+    marker.assign(n, -1);
+    update_storage(source);
+}
+
+//////////////////////////////////
+
+// Methods
+//////////////////////////////////
+
+template<class T>
+void Matrix_power<T>::to_dense(Operand& op){
+    std::vector<T> dense(static_cast<size_t>(n) * n, T((long) 0));
+    for (int i = 0; i < n; i++){
+        for (int k = op.row_ptr[i]; k < op.row_ptr[i + 1]; k++){
+            dense[static_cast<size_t>(i) * n + op.col_idx[k]] = op.vals[k];
+        }
+    }
+    op.vals.swap(dense);
+    op.dense = true;
+    dense_used = true;
+}
+
+template<class T>
+void Matrix_power<T>::update_storage(Operand& op){
+    if (op.dense || !params.track_fill || n == 0) return;
+    if (static_cast<double>(op.vals.size()) > params.dense_threshold * n * n){
+        to_dense(op);
+    }
+}
+
+// res = lhs * rhs, res is dense if any operand is dense
+template<class T>
+void Matrix_power<T>::multiply(const Operand& lhs, const Operand& rhs, Operand& res){
+    const T zero((long) 0);
+    // calls f(column, value) for stored non-zero elements of row i
+    auto for_each_in_row = [&](const Operand& op, int i, auto f){
+        if (op.dense){
+            const T* row = op.vals.data() + static_cast<size_t>(i) * n;
+            for (int j = 0; j < n; j++){
+                if (!(row[j] == zero)) f(j, row[j]);
+            }
+        } else {
+            for (int k = op.row_ptr[i]; k < op.row_ptr[i + 1]; k++){
+                f(op.col_idx[k], op.vals[k]);
+            }
+        }
+    };
+
+    if (lhs.dense || rhs.dense){
+        res.dense = true;
+        res.row_ptr.clear();
+        res.col_idx.clear();
+        res.vals.assign(static_cast<size_t>(n) * n, zero);
+        for (int i = 0; i < n; i++){
+            T* res_row = res.vals.data() + static_cast<size_t>(i) * n;
+            for_each_in_row(lhs, i, [&](int k, const T& a){
+                if (rhs.dense){
+                    const T* rhs_row = rhs.vals.data() + static_cast<size_t>(k) * n;
+                    for (int j = 0; j < n; j++) res_row[j] += a * rhs_row[j];
+                } else {
+                    for (int t = rhs.row_ptr[k]; t < rhs.row_ptr[k + 1]; t++){
+                        res_row[rhs.col_idx[t]] += a * rhs.vals[t];
+                    }
+                }
+            });
+        }
+        return;
+    }
+
+    // Gustavson: row i of result is accumulated in row_acc
+    res.dense = false;
+    res.row_ptr.assign(n + 1, 0);
+    res.col_idx.clear();
+    res.vals.clear();
+    std::fill(marker.begin(), marker.end(), -1);
+    for (int i = 0; i < n; i++){
+        row_pattern.clear();
+        for (int k = lhs.row_ptr[i]; k < lhs.row_ptr[i + 1]; k++){
+            const T& a = lhs.vals[k];
+            int row = lhs.col_idx[k];
+            for (int t = rhs.row_ptr[row]; t < rhs.row_ptr[row + 1]; t++){
+                int j = rhs.col_idx[t];
+                if (marker[j] != i){
+                    marker[j] = i;
+                    row_pattern.push_back(j);
+                }
+                row_acc[j] += a * rhs.vals[t];
+            }
+        }
+        std::sort(row_pattern.begin(), row_pattern.end());
+        for (int j : row_pattern){
+            res.col_idx.push_back(j);
+            res.vals.push_back(row_acc[j]);
+            row_acc[j] = zero;
+        }
+        res.row_ptr[i + 1] = res.col_idx.size();
+    }
+}
+
+template<class T>
+Matrix<T> Matrix_power<T>::to_matrix(const Operand& op) const{
+    const T zero((long) 0);
+    matr_vals<T> vals;
+    if (op.dense){
+        for (int i = 0; i < n; i++){
+            for (int j = 0; j < n; j++){
+                const T& val = op.vals[static_cast<size_t>(i) * n + j];
+                if (!(val == zero)) vals[{i, j}] = val;
+            }
+        }
+    } else {
+        vals.reserve(op.vals.size());
+        for (int i = 0; i < n; i++){
+            for (int k = op.row_ptr[i]; k < op.row_ptr[i + 1]; k++){
+                vals[{i, op.col_idx[k]}] = op.vals[k];
+            }
+        }
+    }
+    return Matrix<T>(n, n, vals, eps);
+}
+
+template<class T>
+Matrix<T> Matrix_power<T>::pow(unsigned long long k){
+    if (k == 0){
+        Matrix<T> identity(n, n, true);
+        identity.set_eps(eps);
+        return identity;
+    }
+    // right-to-left binary exponentiation, result = identity is not multiplied
+    base = source;
+    bool has_result = false;
+    while (true){
+        if (k & 1){
+            if (!has_result){
+                result = base;
+                has_result = true;
+            } else {
+                multiply(result, base, scratch);
+                std::swap(result, scratch);
+                update_storage(result);
+            }
+        }
+        k >>= 1;
+        if (k == 0) break;
+        multiply(base, base, scratch);
+        std::swap(base, scratch);
+        update_storage(base);
+    }
+    return to_matrix(result);
+}
+
+template<class T>
+bool Matrix_power<T>::used_dense() const{
+    return dense_used;
+}
+
+//////////////////////////////////
+
+#endif // __MatrixPower_H__
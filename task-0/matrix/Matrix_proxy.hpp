@@ -7,6 +7,7 @@
 
 #include "../exceptions/CommonExceptions.hpp"
 #include "../exceptions/MatrixExceptions.hpp"
+#include "../stats/Stats.hpp"
 
 template<class T>
 class Matrix;
@@ -16,6 +17,7 @@ class Matrix;
 struct pair_hash{
     template <class T1, class T2>
     std::size_t operator() (const std::pair<T1, T2>& pair) const {
+        TASK0_STAT(HASH_PROBES, 1);
         return std::hash<T1>()(pair.first) ^ std::hash<T2>()(pair.second);
     }
 };
@@ -0,0 +1,237 @@
+/**
+ * @file Matrix_reordering.hpp
+ * @brief Bandwidth-reducing orderings (reverse Cuthill-McKee) and permutations of matrices and vectors
+ */
+
+#ifndef __MatrixReordering_H__
+#define __MatrixReordering_H__
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "ClassMatrix.h"
+#include "../vector/ClassVector.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+// perm[new_index] = old_index
+using Permutation = std::vector<int>;
+
+// Permutations
+//////////////////////////////////
+
+// throws Shape_error if perm.size() != n, Init_error if perm is not permutation of 0 ... n - 1
+inline void _check_permutation(const Permutation& perm, int n, const char* what){
+    if (static_cast<int>(perm.size()) != n){
+        throw Shape_error(std::string("Wrong size of permutation of ") + what + ": ", (int) perm.size(), n);
+    }
+    std::vector<bool> seen(n, false);
+    for (int idx : perm){
+        if (idx < 0 || idx >= n || seen[idx]){
+            throw Init_error(std::string("Not a permutation of ") + what + ", repeated or wrong index: ", std::to_string(idx));
+        }
+        seen[idx] = true;
+    }
+}
+
+// inv[perm[k]] = k
+inline Permutation inverse_permutation(const Permutation& perm){
+    _check_permutation(perm, static_cast<int>(perm.size()), "indices");
+    Permutation inv(perm.size());
+    for (size_t k = 0; k < perm.size(); k++){
+        inv[perm[k]] = static_cast<int>(k);
+    }
+    return inv;
+}
+
+/**
+ * @brief B(i, j) = A(P[i], Q[j]): rows and columns of A in order P and Q
+ *
+ * Solution of A x = b after reordering: B y = permute(b, P), x = permute(y, inverse_permutation(Q)).
+ * Eps of A is kept.
+ */
+template<class T>
+Matrix<T> permute(const Matrix<T>& matrix, const Permutation& P, const Permutation& Q){
+    _check_permutation(P, matrix.get_rows_number(), "rows");
+    _check_permutation(Q, matrix.get_columns_number(), "columns");
+    Permutation row_inv = inverse_permutation(P), column_inv = inverse_permutation(Q);
+
+    matr_vals<T> vals;
+    vals.reserve(matrix.get_values().size());
+    for (const auto& elem : matrix.get_values()){
+        vals.emplace(coords(row_inv[elem.first.first], column_inv[elem.first.second]), elem.second);
+    }
+    return Matrix<T>(matrix.get_rows_number(), matrix.get_columns_number(), std::move(vals), matrix.get_eps());
+}
+
+// symmetric permutation P A P^T
+template<class T>
+Matrix<T> permute(const Matrix<T>& matrix, const Permutation& P){
+    return permute(matrix, P, P);
+}
+
+/**
+ * @brief y[i] = x[P[i]], storage of x is kept
+ */
+template<class T>
+Vector<T> permute(const Vector<T>& x, const Permutation& P){
+    _check_permutation(P, x.get_max_size(), "vector");
+    Permutation inv = inverse_permutation(P);
+    vect_vals<T> vals;
+    x.for_each_value([&](int idx, const T& val){
+        vals[inv[idx]] = val;
+    });
+    Vector<T> res(x.get_max_size(), vals);
+    res.set_storage(x.get_storage());
+    return res;
+}
+
+//////////////////////////////////
+
+// Orderings
+//////////////////////////////////
+
+// max |i - j| of non-zero values
+template<class T>
+int bandwidth(const Matrix<T>& matrix){
+    int res = 0;
+    for (const auto& elem : matrix.get_values()){
+        if (Numeric_traits<T>::is_zero(elem.second, matrix.get_eps())) continue;
+        res = std::max(res, std::abs(elem.first.first - elem.first.second));
+    }
+    return res;
+}
+
+// pattern of A + A^T without diagonal in CSR arrays, neighbours sorted by index
+template<class T>
+void _symmetric_pattern(const Matrix<T>& matrix, std::vector<int>& ptr, std::vector<int>& adj){
+    int n = matrix.get_rows_number();
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(2 * matrix.get_values().size());
+    for (const auto& elem : matrix.get_values()){
+        int i = elem.first.first, j = elem.first.second;
+        if (i == j || Numeric_traits<T>::is_zero(elem.second, matrix.get_eps())) continue;
+        edges.emplace_back(i, j);
+        edges.emplace_back(j, i);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    ptr.assign(n + 1, 0);
+    adj.resize(edges.size());
+    for (size_t k = 0; k < edges.size(); k++){
+        ptr[edges[k].first + 1]++;
+        adj[k] = edges[k].second;
+    }
+    for (int i = 0; i < n; i++){
+        ptr[i + 1] += ptr[i];
+    }
+}
+
+// breadth-first search from root over unvisited vertices; returns vertices in level order,
+// levels: number of levels, last_level: index in result where last level starts
+inline std::vector<int> _level_structure(int root, const std::vector<int>& ptr, const std::vector<int>& adj,
+                                         const std::vector<bool>& visited, std::vector<int>& mark, int stamp,
+                                         int& levels, size_t& last_level){
+    std::vector<int> order{root};
+    mark[root] = stamp;
+    levels = 0;
+    last_level = 0;
+    for (size_t begin = 0; begin < order.size(); levels++){
+        size_t end = order.size();
+        last_level = begin;
+        for (size_t k = begin; k < end; k++){
+            for (int e = ptr[order[k]]; e < ptr[order[k] + 1]; e++){
+                int v = adj[e];
+                if (visited[v] || mark[v] == stamp) continue;
+                mark[v] = stamp;
+                order.push_back(v);
+            }
+        }
+        begin = end;
+    }
+    return order;
+}
+
+/**
+ * @brief Reverse Cuthill-McKee ordering of square matrix
+ *
+ * Graph of matrix is pattern of A + A^T. Every connected component starts from
+ * pseudo-peripheral vertex (George-Liu: repeated breadth-first search from vertex of
+ * minimal degree in last level while number of levels grows) and is numbered breadth-first
+ * with neighbours in order of increasing degree, whole order is reversed.
+ * permute(A, P) with returned P has small bandwidth, so rows of CSR product read
+ * close entries of x. Ordering is deterministic (ties are broken by index).
+ *
+ * @throw Shape_error if matrix is not square
+ */
+template<class T>
+Permutation rcm_ordering(const Matrix<T>& matrix){
+    int n = matrix.get_rows_number();
+    if (n != matrix.get_columns_number()){
+        throw Shape_error("Ordering is defined for square matrices only: ",
+                          {n, matrix.get_columns_number()}, {matrix.get_columns_number(), n});
+    }
+    std::vector<int> ptr, adj;
+    _symmetric_pattern(matrix, ptr, adj);
+    auto degree = [&ptr](int v){ return ptr[v + 1] - ptr[v]; };
+
+    std::vector<int> by_degree(n);
+    for (int v = 0; v < n; v++) by_degree[v] = v;
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&](int a, int b){ return degree(a) < degree(b); });
+
+    Permutation order;
+    order.reserve(n);
+    std::vector<bool> visited(n, false);
+    std::vector<int> mark(n, -1), neighbours;
+    int stamp = 0;
+    for (int start : by_degree){
+        if (visited[start]) continue;
+
+        // pseudo-peripheral root of component
+        int root = start, levels;
+        size_t last_level;
+        std::vector<int> component = _level_structure(root, ptr, adj, visited, mark, stamp++, levels, last_level);
+        while (true){
+            int candidate = component[last_level];
+            for (size_t k = last_level; k < component.size(); k++){
+                if (degree(component[k]) < degree(candidate)) candidate = component[k];
+            }
+            int candidate_levels;
+            size_t candidate_last;
+            std::vector<int> candidate_component = _level_structure(candidate, ptr, adj, visited, mark, stamp++,
+                                                                    candidate_levels, candidate_last);
+            if (candidate_levels <= levels) break;
+            root = candidate;
+            levels = candidate_levels;
+            last_level = candidate_last;
+            component = std::move(candidate_component);
+        }
+
+        // Cuthill-McKee numbering of component
+        size_t head = order.size();
+        order.push_back(root);
+        visited[root] = true;
+        for (; head < order.size(); head++){
+            int u = order[head];
+            neighbours.clear();
+            for (int e = ptr[u]; e < ptr[u + 1]; e++){
+                if (!visited[adj[e]]) neighbours.push_back(adj[e]);
+            }
+            std::stable_sort(neighbours.begin(), neighbours.end(), [&](int a, int b){ return degree(a) < degree(b); });
+            for (int v : neighbours){
+                visited[v] = true;
+                order.push_back(v);
+            }
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+//////////////////////////////////
+
+#endif // __MatrixReordering_H__
@@ -0,0 +1,445 @@
+/**
+ * @file Matrix_structured.hpp
+ * @brief Compressed matrices storing one triangle: symmetric/hermitian and triangular
+ */
+
+#ifndef __MatrixStructured_H__
+#define __MatrixStructured_H__
+
+#include <vector>
+#include <tuple>
+#include <string>
+#include <algorithm>
+#include <utility>
+
+#include "ClassMatrix.h"
+#include "../complex/Scalar_functions.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+enum class Triangle{ LOWER, UPPER };
+
+// Common construction
+//////////////////////////////////
+
+// CSR arrays of values moved to one triangle by place(i, j, value) (columns sorted in rows).
+// Value given twice (both (i, j) and (j, i) of symmetric matrix) must be the same up to eps
+// (Numeric_traits<T>::is_zero of difference), otherwise Init_error is thrown; first of them
+// is kept. Fake zero values of Matrix are skipped.
+template<class T, class Place>
+void _triangle_csr(int n, const matr_vals<T>& values, Place place,
+                   std::vector<int>& row_ptr, std::vector<int>& col_idx, std::vector<T>& vals, double eps = 0){
+    const T zero((long) 0);
+    std::vector<std::tuple<int, int, T>> entries;
+    entries.reserve(values.size());
+    for (const auto& elem : values){
+        if (elem.second == zero) continue;
+        int i = elem.first.first, j = elem.first.second;
+        if (i < 0 || j < 0 || i >= n || j >= n){
+            throw Init_error("Elements coordinates must be less then dimensions, but got: ",
+                             std::to_string(i) + ", " + std::to_string(j));
+        }
+        entries.push_back(place(i, j, elem.second));
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs){
+        return std::make_pair(std::get<0>(lhs), std::get<1>(lhs)) < std::make_pair(std::get<0>(rhs), std::get<1>(rhs));
+    });
+
+    row_ptr.assign(n + 1, 0);
+    col_idx.clear();
+    vals.clear();
+    col_idx.reserve(entries.size());
+    vals.reserve(entries.size());
+    for (size_t k = 0; k < entries.size(); k++){
+        int i = std::get<0>(entries[k]), j = std::get<1>(entries[k]);
+        if (k > 0 && i == std::get<0>(entries[k - 1]) && j == std::get<1>(entries[k - 1])){
+            if (!Numeric_traits<T>::is_zero(std::get<2>(entries[k]) - vals.back(), eps)){
+                throw Init_error("Matrix is not symmetric at: ", std::to_string(i) + ", " + std::to_string(j));
+            }
+            continue;
+        }
+        row_ptr[i + 1]++;
+        col_idx.push_back(j);
+        vals.push_back(std::move(std::get<2>(entries[k])));
+    }
+    for (int i = 0; i < n; i++){
+        row_ptr[i + 1] += row_ptr[i];
+    }
+}
+
+template<class T>
+void _check_square(const Matrix<T>& matrix, const char* what){
+    if (matrix.get_rows_number() != matrix.get_columns_number()){
+        throw Shape_error(std::string(what) + " matrix must be square, got: ",
+                          {matrix.get_rows_number(), matrix.get_columns_number()},
+                          {matrix.get_columns_number(), matrix.get_rows_number()});
+    }
+}
+
+//////////////////////////////////
+
+/**
+ * @brief Symmetric (A = A^T) or hermitian (A = A^*) sparse matrix storing lower triangle only.
+ *
+ * Values are kept in CSR arrays of lower triangle with diagonal, so memory and
+ * bandwidth of SpMV are about half of full storage: every stored a_ij (j < i) is used
+ * twice, for y_i += a_ij * x_j and y_j += a_ji * x_i with a_ji = a_ij (conj(a_ij) if hermitian).
+ * Values may be given in any triangle (or both, then they must agree up to eps: exactly by
+ * default, up to eps of source Matrix, so e.g. A * A^T computed in floating point is accepted).
+ *
+ * @tparam T - type of matrix's elements
+ */
+template<class T>
+class Matrix_symmetric{
+private:
+    int n;
+    bool hermitian;
+    std::vector<int> row_ptr;   // rows of lower triangle, diagonal is last in row
+    std::vector<int> col_idx;
+    std::vector<T> vals;
+
+    T mirror(const T& val) const;   // a_ji for stored a_ij
+public:
+    // throws Init_error if values of both triangles differ by eps or more (or diagonal of
+    // hermitian matrix is not real)
+    Matrix_symmetric(int _n, const matr_vals<T>& values, bool _hermitian = false, double eps = 0);
+    // tolerance is eps of matrix, throws Shape_error if matrix is not square
+    explicit Matrix_symmetric(const Matrix<T>& matrix, bool _hermitian = false);
+
+    int get_rows_number() const;
+    int get_columns_number() const;
+    bool is_hermitian() const;
+    // number of stored elements (one triangle)
+    int get_nnz() const;
+
+    const std::vector<int>& get_row_ptr() const;
+    const std::vector<int>& get_col_idx() const;
+    const std::vector<T>& get_vals() const;
+
+    // y = A * x
+    void multiply(const T* x, T* y) const;
+    // Y = A * X for row-major block of count vectors (see Matrix_csr::multiply_block)
+    void multiply_block(const T* x, T* y, int count) const;
+
+    // A^T: same matrix if symmetric, conjugated values if hermitian
+    Matrix_symmetric transpose() const;
+
+    // both triangles, values less than eps are dropped
+    Matrix<T> to_matrix(double eps = Matrix<T>::default_eps) const;
+};
+
+template<class T>
+Matrix_symmetric<T>::Matrix_symmetric(int _n, const matr_vals<T>& values, bool _hermitian, double eps):
+    n(_n), hermitian(_hermitian){
+    _triangle_csr(n, values, [this](int i, int j, const T& val){
+        if (i == j && hermitian && !(conjugate(val) == val)){
+            throw Init_error("Diagonal of hermitian matrix must be real, wrong value at: ", std::to_string(i));
+        }
+        return i >= j ? std::make_tuple(i, j, val) : std::make_tuple(j, i, mirror(val));
+    }, row_ptr, col_idx, vals, eps);
+}
+
+template<class T>
+Matrix_symmetric<T>::Matrix_symmetric(const Matrix<T>& matrix, bool _hermitian):
+    Matrix_symmetric((_check_square(matrix, "Symmetric"), matrix.get_rows_number()), matrix.get_values(), _hermitian,
+                     matrix.get_eps()){}
+
+template<class T>
+T Matrix_symmetric<T>::mirror(const T& val) const{
+    return hermitian ? conjugate(val) : val;
+}
+
+template<class T>
+int Matrix_symmetric<T>::get_rows_number() const{
+    return n;
+}
+
+template<class T>
+int Matrix_symmetric<T>::get_columns_number() const{
+    return n;
+}
+
+template<class T>
+bool Matrix_symmetric<T>::is_hermitian() const{
+    return hermitian;
+}
+
+template<class T>
+int Matrix_symmetric<T>::get_nnz() const{
+    return vals.size();
+}
+
+template<class T>
+const std::vector<int>& Matrix_symmetric<T>::get_row_ptr() const{
+    return row_ptr;
+}
+
+template<class T>
+const std::vector<int>& Matrix_symmetric<T>::get_col_idx() const{
+    return col_idx;
+}
+
+template<class T>
+const std::vector<T>& Matrix_symmetric<T>::get_vals() const{
+    return vals;
+}
+
+template<class T>
+void Matrix_symmetric<T>::multiply(const T* x, T* y) const{
+    std::fill(y, y + n, T((long) 0));
+    for (int i = 0; i < n; i++){
+        T sum((long) 0);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            int j = col_idx[k];
+            sum += vals[k] * x[j];
+            if (j != i) y[j] += mirror(vals[k]) * x[i];
+        }
+        y[i] += sum;
+    }
+}
+
+template<class T>
+void Matrix_symmetric<T>::multiply_block(const T* x, T* y, int count) const{
+    std::fill(y, y + static_cast<size_t>(n) * count, T((long) 0));
+    for (int i = 0; i < n; i++){
+        T* y_row = y + static_cast<size_t>(i) * count;
+        const T* x_row = x + static_cast<size_t>(i) * count;
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            int j = col_idx[k];
+            const T& a = vals[k];
+            const T* x_col = x + static_cast<size_t>(j) * count;
+            for (int v = 0; v < count; v++){
+                y_row[v] += a * x_col[v];
+            }
+            if (j == i) continue;
+            T a_mirror = mirror(a);
+            T* y_col = y + static_cast<size_t>(j) * count;
+            for (int v = 0; v < count; v++){
+                y_col[v] += a_mirror * x_row[v];
+            }
+        }
+    }
+}
+
+template<class T>
+Matrix_symmetric<T> Matrix_symmetric<T>::transpose() const{
+    Matrix_symmetric<T> res(*this);
+    if (hermitian){
+        for (auto& val : res.vals) val = conjugate(val);
+    }
+    return res;
+}
+
+template<class T>
+Matrix<T> Matrix_symmetric<T>::to_matrix(double eps) const{
+    matr_vals<T> tmp_vals;
+    tmp_vals.reserve(2 * vals.size());
+    for (int i = 0; i < n; i++){
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            tmp_vals[{i, col_idx[k]}] = vals[k];
+            tmp_vals[{col_idx[k], i}] = mirror(vals[k]);
+        }
+    }
+    return Matrix<T>(n, n, std::move(tmp_vals), eps);
+}
+
+//////////////////////////////////
+
+/**
+ * @brief Lower or upper triangular sparse matrix in CSR arrays.
+ *
+ * Supports SpMV, transposition (lower <-> upper by one counting sort) and triangular
+ * solves (forward substitution for lower, backward for upper; diagonal is last/first
+ * element of row, so every row is one pass).
+ *
+ * @tparam T - type of matrix's elements
+ */
+template<class T>
+class Matrix_triangular{
+private:
+    int n;
+    Triangle triangle;
+    std::vector<int> row_ptr;
+    std::vector<int> col_idx;
+    std::vector<T> vals;
+
+    Matrix_triangular(int _n, Triangle _triangle): n(_n), triangle(_triangle){}
+public:
+    // throws Init_error if some value is outside of triangle
+    Matrix_triangular(int _n, const matr_vals<T>& values, Triangle _triangle);
+    // throws Shape_error if matrix is not square
+    Matrix_triangular(const Matrix<T>& matrix, Triangle _triangle);
+
+    int get_rows_number() const;
+    int get_columns_number() const;
+    Triangle get_triangle() const;
+    int get_nnz() const;
+
+    const std::vector<int>& get_row_ptr() const;
+    const std::vector<int>& get_col_idx() const;
+    const std::vector<T>& get_vals() const;
+
+    // y = A * x
+    void multiply(const T* x, T* y) const;
+    // Y = A * X for row-major block of count vectors (see Matrix_csr::multiply_block)
+    void multiply_block(const T* x, T* y, int count) const;
+
+    // A^T is triangular matrix of other type
+    Matrix_triangular transpose() const;
+
+    // A * x = b: b is overwritten with x; throws Zero_division if diagonal element is zero
+    // (or missing), Shape_error if b.size() != n
+    void solve_in_place(std::vector<T>& b) const;
+    std::vector<T> solve(const std::vector<T>& b) const;
+
+    // values less than eps are dropped
+    Matrix<T> to_matrix(double eps = Matrix<T>::default_eps) const;
+};
+
+template<class T>
+Matrix_triangular<T>::Matrix_triangular(int _n, const matr_vals<T>& values, Triangle _triangle):
+    n(_n), triangle(_triangle){
+    _triangle_csr(n, values, [this](int i, int j, const T& val){
+        if (triangle == Triangle::LOWER ? j > i : j < i){
+            throw Init_error(std::string("Value outside of ") + (triangle == Triangle::LOWER ? "lower" : "upper") +
+                             " triangle at: ", std::to_string(i) + ", " + std::to_string(j));
+        }
+        return std::make_tuple(i, j, val);
+    }, row_ptr, col_idx, vals);
+}
+
+template<class T>
+Matrix_triangular<T>::Matrix_triangular(const Matrix<T>& matrix, Triangle _triangle):
+    Matrix_triangular((_check_square(matrix, "Triangular"), matrix.get_rows_number()), matrix.get_values(), _triangle){}
+
+template<class T>
+int Matrix_triangular<T>::get_rows_number() const{
+    return n;
+}
+
+template<class T>
+int Matrix_triangular<T>::get_columns_number() const{
+    return n;
+}
+
+template<class T>
+Triangle Matrix_triangular<T>::get_triangle() const{
+    return triangle;
+}
+
+template<class T>
+int Matrix_triangular<T>::get_nnz() const{
+    return vals.size();
+}
+
+template<class T>
+const std::vector<int>& Matrix_triangular<T>::get_row_ptr() const{
+    return row_ptr;
+}
+
+template<class T>
+const std::vector<int>& Matrix_triangular<T>::get_col_idx() const{
+    return col_idx;
+}
+
+template<class T>
+const std::vector<T>& Matrix_triangular<T>::get_vals() const{
+    return vals;
+}
+
+template<class T>
+void Matrix_triangular<T>::multiply(const T* x, T* y) const{
+    for (int i = 0; i < n; i++){
+        T sum((long) 0);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            sum += vals[k] * x[col_idx[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+template<class T>
+void Matrix_triangular<T>::multiply_block(const T* x, T* y, int count) const{
+    const T zero((long) 0);
+    for (int i = 0; i < n; i++){
+        T* y_row = y + static_cast<size_t>(i) * count;
+        std::fill(y_row, y_row + count, zero);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            const T& a = vals[k];
+            const T* x_row = x + static_cast<size_t>(col_idx[k]) * count;
+            for (int v = 0; v < count; v++){
+                y_row[v] += a * x_row[v];
+            }
+        }
+    }
+}
+
+template<class T>
+Matrix_triangular<T> Matrix_triangular<T>::transpose() const{
+    Matrix_triangular<T> res(n, triangle == Triangle::LOWER ? Triangle::UPPER : Triangle::LOWER);
+    res.row_ptr.assign(n + 1, 0);
+    for (int j : col_idx){
+        res.row_ptr[j + 1]++;
+    }
+    for (int i = 0; i < n; i++){
+        res.row_ptr[i + 1] += res.row_ptr[i];
+    }
+    res.col_idx.resize(vals.size());
+    res.vals.resize(vals.size(), T((long) 0));
+    std::vector<int> next(res.row_ptr.begin(), res.row_ptr.end() - 1);
+    // rows are visited in increasing order, so columns of result are sorted
+    for (int i = 0; i < n; i++){
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            int pos = next[col_idx[k]]++;
+            res.col_idx[pos] = i;
+            res.vals[pos] = vals[k];
+        }
+    }
+    return res;
+}
+
+template<class T>
+void Matrix_triangular<T>::solve_in_place(std::vector<T>& b) const{
+    if (static_cast<int>(b.size()) != n){
+        throw Shape_error("Wrong shapes for triangular solve: ", {n, n}, {(int) b.size(), 1});
+    }
+    const T zero((long) 0);
+    bool lower = triangle == Triangle::LOWER;
+    for (int step = 0; step < n; step++){
+        int i = lower ? step : n - 1 - step;
+        int diag = lower ? row_ptr[i + 1] - 1 : row_ptr[i];
+        if (row_ptr[i] == row_ptr[i + 1] || col_idx[diag] != i || vals[diag] == zero){
+            throw Zero_division("Triangular solve: zero diagonal element in row " + std::to_string(i));
+        }
+        T sum = b[i];
+        int from = lower ? row_ptr[i] : row_ptr[i] + 1;
+        int to = lower ? row_ptr[i + 1] - 1 : row_ptr[i + 1];
+        for (int k = from; k < to; k++){
+            sum -= vals[k] * b[col_idx[k]];
+        }
+        b[i] = sum / vals[diag];
+    }
+}
+
+template<class T>
+std::vector<T> Matrix_triangular<T>::solve(const std::vector<T>& b) const{
+    std::vector<T> x(b);
+    solve_in_place(x);
+    return x;
+}
+
+template<class T>
+Matrix<T> Matrix_triangular<T>::to_matrix(double eps) const{
+    matr_vals<T> tmp_vals;
+    tmp_vals.reserve(vals.size());
+    for (int i = 0; i < n; i++){
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            tmp_vals[{i, col_idx[k]}] = vals[k];
+        }
+    }
+    return Matrix<T>(n, n, std::move(tmp_vals), eps);
+}
+
+//////////////////////////////////
+
+#endif // __MatrixStructured_H__
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <mutex>
+#include "Modular_arithmetic.h"
+#include "../exceptions/CommonExceptions.hpp"
+
+// Primes
+/////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t pow_mod(uint32_t a, uint32_t power, uint32_t p){
+    uint32_t res = 1 % p;
+    while (power > 0){
+        if (power & 1) res = mul_mod(res, a, p);
+        a = mul_mod(a, a, p);
+        power >>= 1;
+    }
+    return res;
+}
+
+// deterministic Miller-Rabin test for 32-bit numbers (bases 2, 7, 61)
+bool is_prime(uint32_t n){
+    if (n < 2) return false;
+    for (uint32_t small : {2u, 3u, 5u, 7u, 61u}){
+        if (n % small == 0) return n == small;
+    }
+    uint32_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0){
+        d >>= 1;
+        s++;
+    }
+    for (uint32_t base : {2u, 7u, 61u}){
+        uint32_t x = pow_mod(base, d, n);
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int i = 1; i < s && composite; i++){
+            x = mul_mod(x, x, n);
+            if (x == n - 1) composite = false;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+std::vector<uint32_t> word_primes(size_t count){
+    static std::vector<uint32_t> cache;     // primes are searched once
+    static uint32_t next_candidate = (1u << 30) - 1;
+    static std::mutex cache_mutex;
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    while (cache.size() < count){
+        if (is_prime(next_candidate)) cache.push_back(next_candidate);
+        next_candidate -= 2;
+    }
+    return std::vector<uint32_t>(cache.begin(), cache.begin() + count);
+}
+
+uint32_t inv_mod(uint32_t a, uint32_t p){
+    int64_t t0 = 0, t1 = 1;
+    int64_t r0 = p, r1 = a % p;
+    if (r1 == 0) throw Zero_division("Inverse of zero modulo " + std::to_string(p));
+    while (r1 != 0){
+        int64_t q = r0 / r1;
+        std::swap(r0, r1);
+        r1 -= q * r0;
+        std::swap(t0, t1);
+        t1 -= q * t0;
+    }
+    return static_cast<uint32_t>(t0 < 0 ? t0 + p : t0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// Big_unsigned
+/////////////////////////////////////////////////////////////////////////////////////////
+
+Big_unsigned::Big_unsigned(uint64_t x){
+    while (x != 0){
+        limbs.push_back(static_cast<uint32_t>(x));
+        x >>= 32;
+    }
+}
+
+void Big_unsigned::trim(){
+    while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+}
+
+bool Big_unsigned::is_zero() const{
+    return limbs.empty();
+}
+
+size_t Big_unsigned::bit_length() const{
+    if (limbs.empty()) return 0;
+    size_t res = 32 * (limbs.size() - 1);
+    for (uint32_t top = limbs.back(); top != 0; top >>= 1) res++;
+    return res;
+}
+
+bool operator<(const Big_unsigned& lhs, const Big_unsigned& rhs){
+    if (lhs.limbs.size() != rhs.limbs.size()) return lhs.limbs.size() < rhs.limbs.size();
+    for (size_t i = lhs.limbs.size(); i-- > 0; ){
+        if (lhs.limbs[i] != rhs.limbs[i]) return lhs.limbs[i] < rhs.limbs[i];
+    }
+    return false;
+}
+
+bool operator==(const Big_unsigned& lhs, const Big_unsigned& rhs){
+    return lhs.limbs == rhs.limbs;
+}
+
+Big_unsigned operator+(const Big_unsigned& lhs, const Big_unsigned& rhs){
+    Big_unsigned res;
+    size_t size = std::max(lhs.limbs.size(), rhs.limbs.size());
+    res.limbs.resize(size + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < size; i++){
+        uint64_t sum = carry;
+        if (i < lhs.limbs.size()) sum += lhs.limbs[i];
+        if (i < rhs.limbs.size()) sum += rhs.limbs[i];
+        res.limbs[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    res.limbs[size] = static_cast<uint32_t>(carry);
+    res.trim();
+    return res;
+}
+
+Big_unsigned operator-(const Big_unsigned& lhs, const Big_unsigned& rhs){
+    Big_unsigned res(lhs);
+    int64_t borrow = 0;
+    for (size_t i = 0; i < res.limbs.size(); i++){
+        int64_t diff = static_cast<int64_t>(res.limbs[i]) - borrow -
+                       (i < rhs.limbs.size() ? static_cast<int64_t>(rhs.limbs[i]) : 0);
+        borrow = diff < 0;
+        res.limbs[i] = static_cast<uint32_t>(diff + (borrow << 32));
+    }
+    res.trim();
+    return res;
+}
+
+Big_unsigned operator*(const Big_unsigned& lhs, const Big_unsigned& rhs){
+    Big_unsigned res;
+    if (lhs.is_zero() || rhs.is_zero()) return res;
+    res.limbs.assign(lhs.limbs.size() + rhs.limbs.size(), 0);
+    for (size_t i = 0; i < lhs.limbs.size(); i++){
+        uint64_t carry = 0;
+        for (size_t j = 0; j < rhs.limbs.size(); j++){
+            uint64_t cur = static_cast<uint64_t>(lhs.limbs[i]) * rhs.limbs[j] + res.limbs[i + j] + carry;
+            res.limbs[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        res.limbs[i + rhs.limbs.size()] = static_cast<uint32_t>(carry);
+    }
+    res.trim();
+    return res;
+}
+
+Big_unsigned& Big_unsigned::mul_add_small(uint32_t mul, uint32_t add){
+    uint64_t carry = add;
+    for (auto& limb : limbs){
+        uint64_t cur = static_cast<uint64_t>(limb) * mul + carry;
+        limb = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    if (carry != 0) limbs.push_back(static_cast<uint32_t>(carry));
+    trim();
+    return *this;
+}
+
+uint32_t Big_unsigned::div_small(uint32_t div){
+    uint64_t rem = 0;
+    for (size_t i = limbs.size(); i-- > 0; ){
+        uint64_t cur = (rem << 32) | limbs[i];
+        limbs[i] = static_cast<uint32_t>(cur / div);
+        rem = cur % div;
+    }
+    trim();
+    return static_cast<uint32_t>(rem);
+}
+
+uint32_t Big_unsigned::mod_small(uint32_t div) const{
+    uint64_t rem = 0;
+    for (size_t i = limbs.size(); i-- > 0; ){
+        rem = ((rem << 32) | limbs[i]) % div;
+    }
+    return static_cast<uint32_t>(rem);
+}
+
+// shift-and-subtract division, cost is proportional to length of quotient
+void Big_unsigned::divmod(const Big_unsigned& num, const Big_unsigned& div, Big_unsigned& quot, Big_unsigned& rem){
+    if (div.is_zero()) throw Zero_division("Zero division of long numbers");
+    rem = num;
+    quot = Big_unsigned();
+    if (num < div) return;
+
+    size_t shift = num.bit_length() - div.bit_length();
+    // d = div << shift
+    Big_unsigned d;
+    d.limbs.assign(shift / 32, 0);
+    uint32_t carry = 0, bits = shift % 32;
+    for (uint32_t limb : div.limbs){
+        d.limbs.push_back(bits == 0 ? limb : (limb << bits) | carry);
+        carry = bits == 0 ? 0 : limb >> (32 - bits);
+    }
+    if (carry != 0) d.limbs.push_back(carry);
+
+    quot.limbs.assign(shift / 32 + 1, 0);
+    for (size_t s = shift + 1; s-- > 0; ){
+        if (!(rem < d)){
+            rem = rem - d;
+            quot.limbs[s / 32] |= 1u << (s % 32);
+        }
+        // d >>= 1
+        for (size_t i = 0; i < d.limbs.size(); i++){
+            d.limbs[i] >>= 1;
+            if (i + 1 < d.limbs.size()) d.limbs[i] |= d.limbs[i + 1] << 31;
+        }
+        d.trim();
+    }
+    quot.trim();
+}
+
+std::string Big_unsigned::to_string() const{
+    if (is_zero()) return "0";
+    Big_unsigned tmp(*this);
+    std::string res;
+    while (!tmp.is_zero()){
+        uint32_t chunk = tmp.div_small(1000000000);
+        for (int i = 0; i < 9; i++){
+            res.push_back('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+    while (res.size() > 1 && res.back() == '0') res.pop_back();
+    std::reverse(res.begin(), res.end());
+    return res;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// Crt_basis
+/////////////////////////////////////////////////////////////////////////////////////////
+
+Crt_basis::Crt_basis(const std::vector<uint32_t>& _primes): primes(_primes), modulus(1){
+    pair_inverses.resize(primes.size());
+    for (size_t i = 0; i < primes.size(); i++){
+        for (size_t j = 0; j < i; j++){
+            pair_inverses[i].push_back(inv_mod(primes[j] % primes[i], primes[i]));
+        }
+        modulus.mul_add_small(primes[i], 0);
+    }
+}
+
+size_t Crt_basis::size() const{
+    return primes.size();
+}
+
+// Garner's algorithm: x = v_0 + v_1 * p_0 + v_2 * p_0 * p_1 + ...
+Big_unsigned Crt_basis::combine(const uint32_t* residues) const{
+    size_t k = primes.size();
+    std::vector<uint32_t> digits(k);
+    for (size_t i = 0; i < k; i++){
+        uint32_t p = primes[i];
+        uint32_t t = residues[i] % p;
+        for (size_t j = 0; j < i; j++){
+            uint32_t v = digits[j] % p;
+            t = mul_mod(t >= v ? t - v : t + p - v, pair_inverses[i][j], p);
+        }
+        digits[i] = t;
+    }
+    Big_unsigned x(digits[k - 1]);
+    for (size_t i = k - 1; i-- > 0; ){
+        x.mul_add_small(primes[i], digits[i]);
+    }
+    return x;
+}
+
+bool Crt_basis::reconstruct(const uint32_t* residues, Rational_number& res) const{
+    Big_unsigned r0 = modulus, r1 = combine(residues);
+    Big_unsigned t0, t1(1), quot, rem;
+    bool t1_negative = false;   // signs of t0 and t1 alternate, so only magnitudes are stored
+
+    // stop when 2 * r1^2 < M
+    while (!r1.is_zero() && !(r1 * r1 * Big_unsigned(2) < modulus)){
+        Big_unsigned::divmod(r0, r1, quot, rem);
+        r0 = std::move(r1);
+        r1 = std::move(rem);
+        Big_unsigned t_new = t0 + quot * t1;
+        t0 = std::move(t1);
+        t1 = std::move(t_new);
+        t1_negative = !t1_negative;
+    }
+    if (!(t1 * t1 * Big_unsigned(2) < modulus)){
+        return false;
+    }
+    std::string num = r1.to_string();
+    if (t1_negative && !r1.is_zero()) num = "-" + num;
+    res = Rational_number(num, t1.to_string());
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,92 @@
+/**
+ * @file Modular_arithmetic.h
+ * @brief Word-size prime fields, CRT and rational reconstruction
+ */
+
+#ifndef __ModularArithmetic_H__
+#define __ModularArithmetic_H__
+
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include "../rational/ClassRationalNumber.h"
+
+/**
+ * @brief Get count largest primes below 2^30 (in descending order)
+ *
+ * p^2 < 2^60, so up to 16 products of residues can be accumulated in uint64_t
+ * before reduction.
+ */
+std::vector<uint32_t> word_primes(size_t count);
+
+inline uint32_t mul_mod(uint32_t a, uint32_t b, uint32_t p){
+    return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % p);
+}
+
+// a^(-1) mod p, a must be non-zero modulo p
+uint32_t inv_mod(uint32_t a, uint32_t p);
+
+/**
+ * @brief Minimal unsigned long integer for CRT reconstruction.
+ *
+ * Little-endian 32-bit limbs without leading zero limbs (zero has no limbs).
+ */
+class Big_unsigned{
+private:
+    std::vector<uint32_t> limbs;
+    void trim();
+public:
+    Big_unsigned(uint64_t x = 0);
+
+    bool is_zero() const;
+    size_t bit_length() const;
+
+    friend bool operator<(const Big_unsigned& lhs, const Big_unsigned& rhs);
+    friend bool operator==(const Big_unsigned& lhs, const Big_unsigned& rhs);
+
+    friend Big_unsigned operator+(const Big_unsigned& lhs, const Big_unsigned& rhs);
+    // lhs >= rhs
+    friend Big_unsigned operator-(const Big_unsigned& lhs, const Big_unsigned& rhs);
+    friend Big_unsigned operator*(const Big_unsigned& lhs, const Big_unsigned& rhs);
+
+    Big_unsigned& mul_add_small(uint32_t mul, uint32_t add);
+    // divide by small number in place, return remainder
+    uint32_t div_small(uint32_t div);
+    uint32_t mod_small(uint32_t div) const;
+    // quotient and remainder, div must be non-zero
+    static void divmod(const Big_unsigned& num, const Big_unsigned& div, Big_unsigned& quot, Big_unsigned& rem);
+
+    std::string to_string() const;
+};
+
+/**
+ * @brief Reconstruction of rational numbers from residues modulo several primes.
+ *
+ * Residues are combined by Garner's CRT into x mod M (M - product of primes), then
+ * extended Euclid finds num/den = x mod M with |num|, den < sqrt(M / 2).
+ * Such fraction is unique, so reconstruction is correct once M is large enough.
+ */
+class Crt_basis{
+private:
+    std::vector<uint32_t> primes;
+    std::vector<std::vector<uint32_t>> pair_inverses;   // [i][j] = p_j^(-1) mod p_i, j < i
+    Big_unsigned modulus;                               // product of primes
+public:
+    explicit Crt_basis(const std::vector<uint32_t>& _primes);
+
+    size_t size() const;
+    // x mod M, residues[i] is x mod primes[i]
+    Big_unsigned combine(const uint32_t* residues) const;
+
+    /**
+     * @brief Reconstruct rational number from its residues
+     *
+     * @param residues residues[i] is value modulo primes[i]
+     * @param res reconstructed value
+     * @return false if there is no fraction with small enough numerator and denominator
+     */
+    bool reconstruct(const uint32_t* residues, Rational_number& res) const;
+};
+
+#endif // __ModularArithmetic_H__
@@ -0,0 +1,316 @@
+/**
+ * @file Modular_engine.hpp
+ * @brief Exact rational matrix arithmetic through word-size prime fields
+ */
+
+#ifndef __ModularEngine_H__
+#define __ModularEngine_H__
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+
+#include "Modular_arithmetic.h"
+
+#include "../matrix/ClassMatrix.h"
+#include "../matrix/Matrix_csr.hpp"
+#include "../vector/ClassVector.hpp"
+#include "../rational/ClassRationalNumber.h"
+
+#include "../exceptions/CommonExceptions.hpp"
+#include "../exceptions/MatrixExceptions.hpp"
+
+struct Modular_params{
+    int initial_primes = 2;     // size of first batch of primes
+    int max_primes = 256;       // result must be reconstructed with at most max_primes primes
+    bool parallel = true;       // images modulo different primes are computed by different threads
+};
+
+enum class Prime_status {
+    GOOD,
+    BAD,        // prime divides some denominator
+    SINGULAR,   // matrix is singular modulo prime
+};
+
+/**
+ * @brief Engine for exact products and solves of rational matrices without long arithmetic.
+ *
+ * Rational matrices are mapped to fields Z_p for primes p < 2^30, the operation is
+ * performed there with 64-bit integer kernels (independently for every prime, optionally
+ * in parallel), then every element is restored by CRT and rational reconstruction.
+ * Number of primes is doubled until reconstructed result stops changing
+ * (early termination: result is correct with overwhelming probability).
+ */
+class Modular_engine{
+private:
+    Modular_params params;
+
+    // up to 15 products of residues are accumulated in uint64_t before reduction
+    static constexpr int lazy_terms = 15;
+
+    template<class Func>
+    void for_each_index(size_t count, Func func) const{
+        size_t workers = 1;
+        if (params.parallel){
+            workers = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+        }
+        if (workers <= 1){
+            for (size_t i = 0; i < count; i++) func(i);
+            return;
+        }
+        std::atomic<size_t> next(0);
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < workers; w++){
+            threads.emplace_back([&](){
+                try{
+                    for (size_t i = next++; i < count; i = next++) func(i);
+                } catch (...){
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        if (error) std::rethrow_exception(error);
+    }
+
+    // vals modulo p, false if p divides some denominator
+    static bool map_values(const std::vector<Rational_number>& vals, uint32_t p, std::vector<uint32_t>& res){
+        res.resize(vals.size());
+        for (size_t k = 0; k < vals.size(); k++){
+            auto residues = vals[k].residues(p);
+            if (residues.second == 0) return false;
+            res[k] = mul_mod(residues.first, inv_mod(residues.second, p), p);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Restore values from images modulo primes with doubling number of primes
+     *
+     * @param count number of values
+     * @param image image(p, res) computes all values modulo p
+     */
+    template<class Image>
+    std::vector<Rational_number> restore(size_t count, Image image) const{
+        std::vector<uint32_t> primes;
+        std::vector<std::vector<uint32_t>> images;
+        size_t next_prime = 0, target = std::max(1, params.initial_primes);
+        int singular_in_row = 0;
+        std::vector<Rational_number> prev;
+        bool has_prev = false;
+
+        while (true){
+            while (primes.size() < target){
+                size_t need = target - primes.size();
+                std::vector<uint32_t> batch = word_primes(next_prime + need);
+                batch.erase(batch.begin(), batch.begin() + next_prime);
+                next_prime += need;
+                if (next_prime > 2 * (size_t) params.max_primes + 16){
+                    throw Out_of_range("Modular engine: too many unlucky primes");
+                }
+
+                std::vector<std::vector<uint32_t>> batch_images(need);
+                std::vector<Prime_status> status(need);
+                for_each_index(need, [&](size_t i){
+                    status[i] = image(batch[i], batch_images[i]);
+                });
+                for (size_t i = 0; i < need; i++){
+                    if (status[i] == Prime_status::SINGULAR && ++singular_in_row >= 3){
+                        throw Singular_matrix("Can't solve linear system: matrix is singular");
+                    }
+                    if (status[i] == Prime_status::GOOD){
+                        singular_in_row = 0;
+                        primes.push_back(batch[i]);
+                        images.push_back(std::move(batch_images[i]));
+                    }
+                }
+            }
+
+            Crt_basis basis(primes);
+            std::vector<Rational_number> cur(count);
+            std::vector<char> restored(count);
+            for_each_index(count, [&](size_t k){
+                std::vector<uint32_t> residues(primes.size());
+                for (size_t i = 0; i < primes.size(); i++){
+                    residues[i] = images[i][k];
+                }
+                restored[k] = basis.reconstruct(residues.data(), cur[k]);
+            });
+            bool all_restored = std::all_of(restored.begin(), restored.end(), [](char ok){ return ok; });
+
+            if (all_restored && has_prev){
+                bool same = true;
+                for (size_t k = 0; k < count && same; k++){
+                    same = cur[k].to_string() == prev[k].to_string();
+                }
+                if (same) return cur;
+            }
+            if (primes.size() >= (size_t) params.max_primes){
+                throw Out_of_range("Modular engine: result can't be reconstructed with max_primes primes");
+            }
+            prev = std::move(cur);
+            has_prev = all_restored;
+            target = std::min(2 * primes.size(), (size_t) params.max_primes);
+        }
+    }
+
+public:
+    explicit Modular_engine(const Modular_params& _params = Modular_params()): params(_params) {};
+
+    /**
+     * @brief Exact product of rational matrices
+     *
+     * Sparsity pattern of the product is computed once, then for every prime
+     * values are accumulated row by row (Gustavson) with lazy reduction.
+     *
+     * @throw Shape_error if lhs columns != rhs rows
+     */
+    Matrix<Rational_number> multiply(const Matrix<Rational_number>& lhs, const Matrix<Rational_number>& rhs) const{
+        if (lhs.get_columns_number() != rhs.get_rows_number()){
+            throw Shape_error("Wrong shape for operation '*': ", {lhs.get_rows_number(), lhs.get_columns_number()},
+                              {rhs.get_rows_number(), rhs.get_columns_number()});
+        }
+        Matrix_csr<Rational_number> a(lhs), b(rhs);
+        int rows = a.get_rows_number(), columns = b.get_columns_number();
+        const std::vector<int>& a_ptr = a.get_row_ptr();
+        const std::vector<int>& a_col = a.get_col_idx();
+        const std::vector<int>& b_ptr = b.get_row_ptr();
+        const std::vector<int>& b_col = b.get_col_idx();
+
+        // symbolic product
+        std::vector<int> c_ptr(rows + 1, 0), c_col;
+        std::vector<int> marker(columns, -1);
+        for (int i = 0; i < rows; i++){
+            for (int k = a_ptr[i]; k < a_ptr[i + 1]; k++){
+                for (int t = b_ptr[a_col[k]]; t < b_ptr[a_col[k] + 1]; t++){
+                    if (marker[b_col[t]] != i){
+                        marker[b_col[t]] = i;
+                        c_col.push_back(b_col[t]);
+                    }
+                }
+            }
+            c_ptr[i + 1] = c_col.size();
+        }
+
+        auto image = [&](uint32_t p, std::vector<uint32_t>& res){
+            std::vector<uint32_t> a_vals, b_vals;
+            if (!map_values(a.get_vals(), p, a_vals) || !map_values(b.get_vals(), p, b_vals)){
+                return Prime_status::BAD;
+            }
+            res.assign(c_col.size(), 0);
+            std::vector<uint64_t> acc(columns, 0);
+            for (int i = 0; i < rows; i++){
+                int terms = 0;
+                for (int k = a_ptr[i]; k < a_ptr[i + 1]; k++){
+                    uint64_t a_val = a_vals[k];
+                    const int* cols = b_col.data() + b_ptr[a_col[k]];
+                    const uint32_t* vals = b_vals.data() + b_ptr[a_col[k]];
+                    int len = b_ptr[a_col[k] + 1] - b_ptr[a_col[k]];
+                    for (int t = 0; t < len; t++){
+                        acc[cols[t]] += a_val * vals[t];
+                    }
+                    if (++terms == lazy_terms){
+                        for (int c = c_ptr[i]; c < c_ptr[i + 1]; c++) acc[c_col[c]] %= p;
+                        terms = 0;
+                    }
+                }
+                for (int c = c_ptr[i]; c < c_ptr[i + 1]; c++){
+                    res[c] = static_cast<uint32_t>(acc[c_col[c]] % p);
+                    acc[c_col[c]] = 0;
+                }
+            }
+            return Prime_status::GOOD;
+        };
+
+        std::vector<Rational_number> c_vals = restore(c_col.size(), image);
+        matr_vals<Rational_number> res_vals;
+        res_vals.reserve(c_vals.size());
+        const Rational_number zero;
+        for (int i = 0; i < rows; i++){
+            for (int c = c_ptr[i]; c < c_ptr[i + 1]; c++){
+                if (c_vals[c] != zero) res_vals[{i, c_col[c]}] = c_vals[c];
+            }
+        }
+        return Matrix<Rational_number>(rows, columns, res_vals);
+    }
+
+    /**
+     * @brief Exact solution of A * x = b for square nonsingular rational matrix
+     *
+     * Gaussian elimination modulo every prime is dense: O(n^3) word operations per prime.
+     *
+     * @throw Shape_error if shapes are wrong
+     * @throw Singular_matrix if matrix is singular
+     */
+    Vector<Rational_number> solve(const Matrix<Rational_number>& A, const Vector<Rational_number>& b) const{
+        int n = A.get_rows_number();
+        if (n != A.get_columns_number() || n != b.get_max_size()){
+            throw Shape_error("Wrong shapes for linear system (A, b): ",
+                              {n, A.get_columns_number()}, {b.get_max_size(), 1});
+        }
+        Matrix_csr<Rational_number> a(A);
+        std::vector<Rational_number> b_vals = b.to_dense();
+        const std::vector<int>& a_ptr = a.get_row_ptr();
+        const std::vector<int>& a_col = a.get_col_idx();
+
+        auto image = [&](uint32_t p, std::vector<uint32_t>& res){
+            std::vector<uint32_t> a_vals, rhs;
+            if (!map_values(a.get_vals(), p, a_vals) || !map_values(b_vals, p, rhs)){
+                return Prime_status::BAD;
+            }
+            // augmented matrix [A | b], row-major
+            int width = n + 1;
+            std::vector<uint32_t> m(n * width, 0);
+            for (int i = 0; i < n; i++){
+                for (int k = a_ptr[i]; k < a_ptr[i + 1]; k++){
+                    m[i * width + a_col[k]] = a_vals[k];
+                }
+                m[i * width + n] = rhs[i];
+            }
+
+            for (int c = 0; c < n; c++){
+                int pivot = c;
+                while (pivot < n && m[pivot * width + c] == 0) pivot++;
+                if (pivot == n) return Prime_status::SINGULAR;
+                if (pivot != c){
+                    std::swap_ranges(m.begin() + pivot * width + c, m.begin() + (pivot + 1) * width,
+                                     m.begin() + c * width + c);
+                }
+                uint32_t* row_c = m.data() + c * width;
+                uint32_t inv = inv_mod(row_c[c], p);
+                for (int j = c; j < width; j++){
+                    row_c[j] = mul_mod(row_c[j], inv, p);
+                }
+                for (int i = c + 1; i < n; i++){
+                    uint32_t* row_i = m.data() + i * width;
+                    if (row_i[c] == 0) continue;
+                    uint64_t factor = p - row_i[c];
+                    for (int j = c; j < width; j++){
+                        row_i[j] = static_cast<uint32_t>((row_i[j] + factor * row_c[j]) % p);
+                    }
+                }
+            }
+
+            res.assign(n, 0);
+            for (int i = n - 1; i >= 0; i--){
+                const uint32_t* row_i = m.data() + i * width;
+                uint64_t sum = row_i[n];
+                for (int j = i + 1; j < n; j++){
+                    sum += static_cast<uint64_t>(p - row_i[j]) * res[j] % p;
+                }
+                res[i] = static_cast<uint32_t>(sum % p);
+            }
+            return Prime_status::GOOD;
+        };
+
+        return Vector<Rational_number>(restore(n, image));
+    }
+};
+
+#endif // __ModularEngine_H__
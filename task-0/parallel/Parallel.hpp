@@ -0,0 +1,188 @@
+/**
+ * @file Parallel.hpp
+ * @brief Thread pool, parallel loops and reproducible parallel reductions
+ */
+
+#ifndef __Parallel_H__
+#define __Parallel_H__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+struct Parallel_policy{
+    unsigned threads = 0;           // 0: std::thread::hardware_concurrency()
+    size_t chunk = 1 << 15;         // elements per task, also fixes order of reductions
+    size_t min_size = 1 << 17;      // shorter ranges are processed by calling thread only
+};
+
+// policy of library kernels (Vector operations, norms, dot products)
+inline Parallel_policy& default_parallel_policy(){
+    static Parallel_policy policy;
+    return policy;
+}
+
+/**
+ * @brief Fixed set of worker threads executing indexed tasks.
+ *
+ * run(tasks, threads, task) calls task(0) ... task(tasks - 1) on calling thread and
+ * threads - 1 workers (tasks are taken by atomic counter) and returns when all are done.
+ * Workers are created on first use and live until exit. Call from inside a task
+ * (nested parallelism) is executed sequentially. First exception of tasks is rethrown.
+ */
+class Thread_pool{
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::mutex run_mutex;               // one job at a time
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t job_tasks = 0;
+    unsigned job_workers = 0;           // workers with id < job_workers take part in job
+    unsigned finished = 0;
+    size_t generation = 0;
+    bool stop = false;
+    std::atomic<size_t> next_task{0};
+    std::exception_ptr error;
+
+    Thread_pool() = default;
+
+    static bool& inside_pool(){
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    void execute(){
+        try{
+            for (size_t t = next_task++; t < job_tasks; t = next_task++){
+                (*job)(t);
+            }
+        } catch (...){
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+            next_task = job_tasks;      // remaining tasks are skipped
+        }
+    }
+
+    void work_loop(unsigned id){
+        inside_pool() = true;
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true){
+            wake.wait(lock, [&](){ return stop || generation != seen; });
+            if (stop) return;
+            seen = generation;
+            if (id >= job_workers) continue;
+            lock.unlock();
+            execute();
+            lock.lock();
+            if (++finished == job_workers) done.notify_all();
+        }
+    }
+
+public:
+    Thread_pool(const Thread_pool&) = delete;
+    Thread_pool& operator=(const Thread_pool&) = delete;
+
+    ~Thread_pool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    static Thread_pool& instance(){
+        static Thread_pool pool;
+        return pool;
+    }
+
+    // threads == 0 means std::thread::hardware_concurrency()
+    void run(size_t tasks, unsigned threads, const std::function<void(size_t)>& task){
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<size_t>(threads, tasks));
+        if (threads <= 1 || inside_pool()){
+            for (size_t t = 0; t < tasks; t++) task(t);
+            return;
+        }
+        std::lock_guard<std::mutex> run_lock(run_mutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (workers.size() + 1 < threads){
+                workers.emplace_back(&Thread_pool::work_loop, this, static_cast<unsigned>(workers.size()));
+            }
+            job = &task;
+            job_tasks = tasks;
+            job_workers = threads - 1;
+            finished = 0;
+            next_task = 0;
+            error = nullptr;
+            generation++;
+        }
+        wake.notify_all();
+        inside_pool() = true;
+        execute();
+        inside_pool() = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&](){ return finished == job_workers; });
+        job = nullptr;
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+/**
+ * @brief f(begin, end) for chunks of [0, n), in parallel if n >= policy.min_size
+ */
+template<class F>
+void parallel_for(size_t n, F f, const Parallel_policy& policy = default_parallel_policy()){
+    if (n == 0) return;
+    if (n < policy.min_size){
+        f(size_t(0), n);
+        return;
+    }
+    size_t chunk = std::max<size_t>(policy.chunk, 1);
+    size_t chunks = (n + chunk - 1) / chunk;
+    Thread_pool::instance().run(chunks, policy.threads, [&](size_t c){
+        f(c * chunk, std::min(n, (c + 1) * chunk));
+    });
+}
+
+/**
+ * @brief Reduction of [0, n) with fixed-chunk tree
+ *
+ * map(begin, end) reduces one chunk of policy.chunk elements, partial results are combined
+ * pairwise in fixed order ((p0 + p1) + (p2 + p3)) + ... Chunks and order of combination
+ * depend only on n and policy.chunk, so floating-point result is the same for any number
+ * of threads (and for sequential execution of short ranges).
+ */
+template<class R, class Map, class Combine>
+R parallel_reduce(size_t n, const R& identity, Map map, Combine combine,
+                  const Parallel_policy& policy = default_parallel_policy()){
+    size_t chunk = std::max<size_t>(policy.chunk, 1);
+    size_t chunks = std::max<size_t>(1, (n + chunk - 1) / chunk);
+    std::vector<R> partial(chunks, identity);
+    auto task = [&](size_t c){
+        partial[c] = map(c * chunk, std::min(n, (c + 1) * chunk));
+    };
+    if (n < policy.min_size){
+        for (size_t c = 0; c < chunks; c++) task(c);
+    } else {
+        Thread_pool::instance().run(chunks, policy.threads, task);
+    }
+    for (size_t width = 1; width < chunks; width *= 2){
+        for (size_t c = 0; c + width < chunks; c += 2 * width){
+            partial[c] = combine(partial[c], partial[c + width]);
+        }
+    }
+    return partial[0];
+}
+
+#endif // __Parallel_H__
@@ -0,0 +1,490 @@
+/**
+ * @file Matrix_market.hpp
+ * @brief Reading and writing of matrices in MatrixMarket coordinate format (.mtx)
+ */
+
+#ifndef __MatrixMarket_H__
+#define __MatrixMarket_H__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cctype>
+#include <type_traits>
+
+#include "../matrix/ClassMatrix.h"
+#include "../parallel/Parallel.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+#include "../exceptions/ParserExceptions.hpp"
+
+/*
+ * Format:
+ *
+ *   %%MatrixMarket matrix coordinate <real|complex|integer|pattern> <general|symmetric|skew-symmetric|hermitian>
+ *   % comments
+ *   rows columns entries
+ *   i j [value]             (1-based, "re im" for complex, no value for pattern)
+ *
+ * Symmetric files keep one triangle only: mirrored values (negated for skew-symmetric,
+ * conjugated for hermitian) are added during load. Duplicated entries are summed.
+ * Dense "array" format is not supported.
+ */
+
+enum class Mtx_field{ REAL, COMPLEX, INTEGER, PATTERN };
+enum class Mtx_symmetry{ GENERAL, SYMMETRIC, SKEW_SYMMETRIC, HERMITIAN };
+
+struct Mtx_header{
+    Mtx_field field = Mtx_field::REAL;
+    Mtx_symmetry symmetry = Mtx_symmetry::GENERAL;
+    int rows = 0;
+    int columns = 0;
+    long entries = 0;       // lines of file, before symmetric expansion
+};
+
+// Tokens and numbers
+//////////////////////////////////
+
+// next token of [pos, end), begin == end if there are no more tokens
+inline std::pair<const char*, const char*> _mtx_token(const char*& pos, const char* end){
+    while (pos < end && std::isspace(static_cast<unsigned char>(*pos))) pos++;
+    const char* begin = pos;
+    while (pos < end && !std::isspace(static_cast<unsigned char>(*pos))) pos++;
+    return {begin, pos};
+}
+
+inline std::string _mtx_lower(std::pair<const char*, const char*> token){
+    std::string res(token.first, token.second);
+    std::transform(res.begin(), res.end(), res.begin(), [](unsigned char c){ return std::tolower(c); });
+    return res;
+}
+
+// whole token must be number
+template<class V>
+V _mtx_number(std::pair<const char*, const char*> token){
+    const char* begin = token.first;
+    if (begin < token.second && *begin == '+') begin++;
+    V res{};
+    auto result = std::from_chars(begin, token.second, res);
+    if (begin == token.second || result.ec != std::errc() || result.ptr != token.second){
+        throw Not_a_number("Not a number in MatrixMarket file: ", std::string(token.first, token.second));
+    }
+    return res;
+}
+
+// decimal (1.25, -3e-2) as exact fraction
+inline Rational_number _mtx_rational(std::pair<const char*, const char*> token){
+    const char* pos = token.first;
+    bool negative = false;
+    if (pos < token.second && (*pos == '-' || *pos == '+')) negative = *pos++ == '-';
+    std::string digits;
+    long exponent = 0;
+    bool point = false;
+    for (; pos < token.second && (std::isdigit(static_cast<unsigned char>(*pos)) || *pos == '.'); pos++){
+        if (*pos == '.'){
+            if (point) break;
+            point = true;
+        } else {
+            digits.push_back(*pos);
+            if (point) exponent--;
+        }
+    }
+    if (pos < token.second && (*pos == 'e' || *pos == 'E')){
+        exponent += _mtx_number<long>({pos + 1, token.second});
+        pos = token.second;
+    }
+    if (digits.empty() || pos != token.second){
+        throw Not_a_number("Not a number in MatrixMarket file: ", std::string(token.first, token.second));
+    }
+    digits.erase(0, std::min(digits.find_first_not_of('0'), digits.size() - 1));
+    if (digits == "0") return Rational_number((long) 0);
+    std::string denominator("1");
+    if (exponent > 0){
+        digits.append(exponent, '0');
+    } else {
+        denominator.append(-exponent, '0');
+    }
+    return Rational_number(negative ? "-" + digits : digits, denominator);
+}
+
+//////////////////////////////////
+
+// Value types
+// parse reads value of one entry, format appends it to line
+//////////////////////////////////
+
+template<class T>
+struct _Mtx_value{
+    static constexpr bool complex = false;
+
+    static T parse(const char*& pos, const char* end, Mtx_field field){
+        if (field == Mtx_field::PATTERN) return Numeric_traits<T>::one();
+        auto token = _mtx_token(pos, end);
+        if constexpr (std::is_integral<T>::value){
+            if (field == Mtx_field::REAL){
+                throw Type_error("Real MatrixMarket values can't be read to integer matrix");
+            }
+            return static_cast<T>(_mtx_number<long long>(token));
+        } else {
+            return static_cast<T>(_mtx_number<double>(token));
+        }
+    }
+
+    static T conjugate(const T& x){
+        return x;
+    }
+
+    static Mtx_field field(const std::vector<const T*>&){
+        return std::is_integral<T>::value ? Mtx_field::INTEGER : Mtx_field::REAL;
+    }
+
+    static void format(const T& x, Mtx_field, std::string& out){
+        char buf[32];
+        auto result = std::to_chars(buf, buf + sizeof(buf), x);
+        out.append(buf, result.ptr);
+    }
+};
+
+template<>
+struct _Mtx_value<Rational_number>{
+    static constexpr bool complex = false;
+
+    static Rational_number parse(const char*& pos, const char* end, Mtx_field field){
+        if (field == Mtx_field::PATTERN) return Numeric_traits<Rational_number>::one();
+        return _mtx_rational(_mtx_token(pos, end));
+    }
+
+    static Rational_number conjugate(const Rational_number& x){
+        return x;
+    }
+
+    // integer if all values are integers (exact), real (rounded to double) otherwise
+    static Mtx_field field(const std::vector<const Rational_number*>& values){
+        for (const Rational_number* x : values){
+            if (x->get_denominator() != Rational_number((long) 1)) return Mtx_field::REAL;
+        }
+        return Mtx_field::INTEGER;
+    }
+
+    static void format(const Rational_number& x, Mtx_field field, std::string& out){
+        if (field == Mtx_field::INTEGER){
+            std::string str = x.to_string();      // "<num/1>"
+            out.append(str, 1, str.find('/') - 1);
+        } else {
+            double res = Numeric_traits<Rational_number>::magnitude(x);
+            _Mtx_value<double>::format(x < Rational_number((long) 0) ? -res : res, field, out);
+        }
+    }
+};
+
+template<class R, class I>
+struct _Mtx_value<Complex_number<R, I>>{
+    static constexpr bool complex = true;
+
+    static Complex_number<R, I> parse(const char*& pos, const char* end, Mtx_field field){
+        if (field == Mtx_field::PATTERN) return Numeric_traits<Complex_number<R, I>>::one();
+        R re = _Mtx_value<R>::parse(pos, end, field);
+        if (field != Mtx_field::COMPLEX) return Complex_number<R, I>(re, Numeric_traits<I>::zero());
+        return Complex_number<R, I>(re, _Mtx_value<I>::parse(pos, end, field));
+    }
+
+    static Complex_number<R, I> conjugate(const Complex_number<R, I>& x){
+        return Complex_number<R, I>(x.get_real(), -x.get_imag());
+    }
+
+    static Mtx_field field(const std::vector<const Complex_number<R, I>*>&){
+        return Mtx_field::COMPLEX;
+    }
+
+    static void format(const Complex_number<R, I>& x, Mtx_field, std::string& out){
+        _Mtx_value<R>::format(x.get_real(), Mtx_field::REAL, out);
+        out.push_back(' ');
+        _Mtx_value<I>::format(x.get_imag(), Mtx_field::REAL, out);
+    }
+};
+
+//////////////////////////////////
+
+// Reading
+//////////////////////////////////
+
+inline std::string _mtx_read_file(const char* filename){
+    std::ifstream file_data(filename, std::ios::binary);
+    if (!file_data.is_open()){
+        throw File_open_error("Fail opening file: ", std::string(filename));
+    }
+    std::ostringstream buffer;
+    buffer << file_data.rdbuf();
+    return buffer.str();
+}
+
+// end of line starting at pos (position of '\n' or end)
+inline const char* _mtx_line_end(const char* pos, const char* end){
+    const void* res = std::memchr(pos, '\n', end - pos);
+    return res ? static_cast<const char*>(res) : end;
+}
+
+// banner, comments and size line; body is set to position of first entry
+inline Mtx_header _mtx_parse_header(const std::string& data, size_t& body){
+    const char* pos = data.data();
+    const char* end = data.data() + data.size();
+    const char* line_end = _mtx_line_end(pos, end);
+
+    if (_mtx_lower(_mtx_token(pos, line_end)) != "%%matrixmarket"){
+        throw Parser_error("Not a MatrixMarket file: ", std::string(data.data(), line_end));
+    }
+    std::string object = _mtx_lower(_mtx_token(pos, line_end));
+    std::string format = _mtx_lower(_mtx_token(pos, line_end));
+    std::string field = _mtx_lower(_mtx_token(pos, line_end));
+    std::string symmetry = _mtx_lower(_mtx_token(pos, line_end));
+    if (object != "matrix" || format != "coordinate"){
+        throw Parser_error("Only coordinate matrices are supported, but got: ", object + " " + format);
+    }
+
+    Mtx_header header;
+    if (field == "real" || field == "double"){
+        header.field = Mtx_field::REAL;
+    } else if (field == "complex"){
+        header.field = Mtx_field::COMPLEX;
+    } else if (field == "integer"){
+        header.field = Mtx_field::INTEGER;
+    } else if (field == "pattern"){
+        header.field = Mtx_field::PATTERN;
+    } else {
+        throw Parser_error("Unknown MatrixMarket field: ", field);
+    }
+    if (symmetry == "general"){
+        header.symmetry = Mtx_symmetry::GENERAL;
+    } else if (symmetry == "symmetric"){
+        header.symmetry = Mtx_symmetry::SYMMETRIC;
+    } else if (symmetry == "skew-symmetric"){
+        header.symmetry = Mtx_symmetry::SKEW_SYMMETRIC;
+    } else if (symmetry == "hermitian"){
+        header.symmetry = Mtx_symmetry::HERMITIAN;
+    } else {
+        throw Parser_error("Unknown MatrixMarket symmetry: ", symmetry);
+    }
+
+    // comments and empty lines before size line
+    while (line_end < end){
+        pos = line_end + 1;
+        line_end = _mtx_line_end(pos, end);
+        const char* tmp = pos;
+        auto token = _mtx_token(tmp, line_end);
+        if (token.first == token.second || *token.first == '%') continue;
+
+        header.rows = _mtx_number<int>(token);
+        header.columns = _mtx_number<int>(_mtx_token(tmp, line_end));
+        header.entries = _mtx_number<long>(_mtx_token(tmp, line_end));
+        if (header.rows < 0 || header.columns < 0 || header.entries < 0){
+            throw Parser_error("Wrong MatrixMarket size line: ", std::string(pos, line_end));
+        }
+        if (header.symmetry != Mtx_symmetry::GENERAL && header.rows != header.columns){
+            throw Shape_error("Symmetric MatrixMarket matrix must be square: ",
+                              {header.rows, header.columns}, {header.columns, header.rows});
+        }
+        body = std::min<size_t>(line_end - data.data() + 1, data.size());
+        return header;
+    }
+    throw Parser_error("No size line in MatrixMarket file");
+}
+
+/**
+ * @brief Header of MatrixMarket file (to choose value type of matrix before reading)
+ */
+inline Mtx_header read_matrix_market_header(const char* filename){
+    std::string data = _mtx_read_file(filename);
+    size_t body;
+    return _mtx_parse_header(data, body);
+}
+
+template<class T>
+struct _Mtx_entry{
+    coords pos;
+    T value;
+};
+
+// entries of lines starting in [first, last) of body, mirrored entries are added to part
+template<class T>
+size_t _mtx_parse_lines(const char* first, const char* last, const char* end, const Mtx_header& header,
+                        std::vector<_Mtx_entry<T>>& part){
+    size_t count = 0;
+    while (first < last){
+        const char* line_end = _mtx_line_end(first, end);
+        const char* pos = first;
+        auto token = _mtx_token(pos, line_end);
+        if (token.first != token.second && *token.first != '%'){
+            long i = _mtx_number<long>(token);
+            long j = _mtx_number<long>(_mtx_token(pos, line_end));
+            if (i < 1 || i > header.rows || j < 1 || j > header.columns){
+                throw Out_of_range("MatrixMarket entry is out of matrix: ", std::string(first, line_end));
+            }
+            T value = _Mtx_value<T>::parse(pos, line_end, header.field);
+            auto rest = _mtx_token(pos, line_end);
+            if (rest.first != rest.second){
+                throw Parser_error("Wrong MatrixMarket entry: ", std::string(first, line_end));
+            }
+            coords ij(static_cast<int>(i - 1), static_cast<int>(j - 1));
+            if (i != j && header.symmetry == Mtx_symmetry::SYMMETRIC){
+                part.push_back({{ij.second, ij.first}, value});
+            } else if (i != j && header.symmetry == Mtx_symmetry::SKEW_SYMMETRIC){
+                part.push_back({{ij.second, ij.first}, -value});
+            } else if (i != j && header.symmetry == Mtx_symmetry::HERMITIAN){
+                part.push_back({{ij.second, ij.first}, _Mtx_value<T>::conjugate(value)});
+            }
+            part.push_back({ij, std::move(value)});
+            count++;
+        }
+        first = line_end + 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Matrix from MatrixMarket coordinate file
+ *
+ * File is read at once and its body is split into policy.chunk-byte parts aligned to lines,
+ * which are parsed in parallel (parallel_for) into per-part entries with symmetric expansion.
+ * Parts are then inserted into hash map of Matrix in file order and moved into result.
+ * Throws File_open_error, Parser_error (wrong header or entry, number of entries differs from
+ * size line), Not_a_number, Out_of_range (entry out of matrix) and Type_error (complex or real
+ * values for matrix of real or integer type).
+ *
+ * @param eps - drop tolerance of result (see Matrix)
+ */
+template<class T>
+Matrix<T> read_matrix_market(const char* filename, double eps = Matrix<T>::default_eps,
+                             const Parallel_policy& policy = default_parallel_policy()){
+    std::string data = _mtx_read_file(filename);
+    size_t body;
+    Mtx_header header = _mtx_parse_header(data, body);
+    if (header.field == Mtx_field::COMPLEX && !_Mtx_value<T>::complex){
+        throw Type_error("Complex MatrixMarket values can't be read to matrix of real type");
+    }
+
+    const char* text = data.data() + body;
+    const char* end = data.data() + data.size();
+    size_t length = end - text;
+    size_t chunk = std::max<size_t>(policy.chunk, 1);
+    size_t chunks = std::max<size_t>(1, (length + chunk - 1) / chunk);
+    std::vector<std::vector<_Mtx_entry<T>>> parts(chunks);
+    std::vector<size_t> counts(chunks, 0);
+
+    // sequential call is f(0, length), so part index is begin / chunk in both cases
+    parallel_for(length, [&](size_t begin, size_t finish){
+        const char* first = text + begin;
+        if (begin > 0 && first[-1] != '\n'){
+            first = std::min(_mtx_line_end(first, end) + 1, end);
+        }
+        counts[begin / chunk] = _mtx_parse_lines(first, text + finish, end, header, parts[begin / chunk]);
+    }, policy);
+
+    size_t total = 0, expanded = 0;
+    for (size_t c = 0; c < chunks; c++){
+        total += counts[c];
+        expanded += parts[c].size();
+    }
+    if (total != static_cast<size_t>(header.entries)){
+        throw Parser_error("Number of MatrixMarket entries differs from size line: ", std::to_string(total));
+    }
+
+    matr_vals<T> vals;
+    vals.reserve(expanded);
+    for (auto& part : parts){
+        for (auto& entry : part){
+            auto inserted = vals.emplace(entry.pos, std::move(entry.value));
+            if (!inserted.second) inserted.first->second += entry.value;
+        }
+        std::vector<_Mtx_entry<T>>().swap(part);
+    }
+    return Matrix<T>(header.rows, header.columns, std::move(vals), eps);
+}
+
+//////////////////////////////////
+
+// Writing
+//////////////////////////////////
+
+/**
+ * @brief Write matrix to MatrixMarket coordinate file
+ *
+ * Entries are sorted by columns, then by rows (column-major as in most .mtx collections),
+ * lines are formatted in parallel. Field is integer for integral types and Rational_number
+ * matrices with integer values, complex for Complex_number, real otherwise (Rational_number
+ * values are rounded to double then). Values less than eps of matrix are skipped.
+ *
+ * @param symmetry - GENERAL or SYMMETRIC (lower triangle is written, Type_error if mirrored
+ *                   values differ by eps or more, Shape_error if matrix is not square)
+ */
+template<class T>
+void write_matrix_market(const Matrix<T>& matrix, const char* filename,
+                         Mtx_symmetry symmetry = Mtx_symmetry::GENERAL,
+                         const Parallel_policy& policy = default_parallel_policy()){
+    if (symmetry != Mtx_symmetry::GENERAL && symmetry != Mtx_symmetry::SYMMETRIC){
+        throw Type_error("Only general and symmetric MatrixMarket files are written");
+    }
+    const matr_vals<T>& values = matrix.get_values();
+    bool symmetric = symmetry == Mtx_symmetry::SYMMETRIC;
+    if (symmetric && matrix.get_rows_number() != matrix.get_columns_number()){
+        throw Shape_error("Symmetric MatrixMarket matrix must be square: ",
+                          {matrix.get_rows_number(), matrix.get_columns_number()},
+                          {matrix.get_columns_number(), matrix.get_rows_number()});
+    }
+
+    std::vector<std::pair<coords, const T*>> entries;
+    entries.reserve(values.size());
+    for (const auto& elem : values){
+        if (Numeric_traits<T>::is_zero(elem.second, matrix.get_eps())) continue;
+        if (symmetric){
+            auto mirror = values.find({elem.first.second, elem.first.first});
+            if (mirror == values.end() || !Numeric_traits<T>::is_zero(mirror->second - elem.second, matrix.get_eps())){
+                throw Type_error("Matrix is not symmetric at: ",
+                                 std::to_string(elem.first.first) + ", " + std::to_string(elem.first.second));
+            }
+            if (elem.first.first < elem.first.second) continue;
+        }
+        entries.emplace_back(elem.first, &elem.second);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs){
+        return std::make_pair(lhs.first.second, lhs.first.first) < std::make_pair(rhs.first.second, rhs.first.first);
+    });
+
+    std::vector<const T*> vals(entries.size());
+    std::transform(entries.begin(), entries.end(), vals.begin(), [](const auto& entry){ return entry.second; });
+    Mtx_field field = _Mtx_value<T>::field(vals);
+
+    size_t chunk = std::max<size_t>(policy.chunk, 1);
+    std::vector<std::string> lines(std::max<size_t>(1, (entries.size() + chunk - 1) / chunk));
+    parallel_for(entries.size(), [&](size_t begin, size_t finish){
+        std::string& out = lines[begin / chunk];
+        for (size_t k = begin; k < finish; k++){
+            out += std::to_string(entries[k].first.first + 1);
+            out.push_back(' ');
+            out += std::to_string(entries[k].first.second + 1);
+            out.push_back(' ');
+            _Mtx_value<T>::format(*entries[k].second, field, out);
+            out.push_back('\n');
+        }
+    }, policy);
+
+    std::ofstream file_data(filename, std::ios::binary);
+    if (!file_data.is_open()){
+        throw File_open_error("Fail opening file: ", std::string(filename));
+    }
+    const char* field_names[] = {"real", "complex", "integer", "pattern"};
+    file_data << "%%MatrixMarket matrix coordinate " << field_names[static_cast<int>(field)]
+              << (symmetric ? " symmetric\n" : " general\n")
+              << matrix.get_rows_number() << " " << matrix.get_columns_number() << " " << entries.size() << "\n";
+    for (const auto& part : lines){
+        file_data << part;
+    }
+}
+
+//////////////////////////////////
+
+#endif // __MatrixMarket_H__
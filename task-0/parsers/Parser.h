@@ -7,11 +7,14 @@
 #include <utility>
 #include <fstream>
 
+#include "../stats/Stats.hpp"
+
 #ifndef __Matr_vals__
 #define __Matr_vals__
 struct pair_hash{
     template <class T1, class T2>
     std::size_t operator() (const std::pair<T1, T2>& pair) const {
+        TASK0_STAT(HASH_PROBES, 1);
         return std::hash<T1>()(pair.first) ^ std::hash<T2>()(pair.second);
     }
 };
@@ -4,6 +4,7 @@
 #include "ClassRationalNumber.h"
 #include "../exceptions/CommonExceptions.hpp"
 #include "../exceptions/RatNumbersExceptions.hpp"
+#include "../stats/Stats.hpp"
 
 #define BASE 10 
 #define LONG_MAX 2147483647
@@ -173,7 +174,7 @@ const std::string operator %(const std::string& left, const std::string& right)
 
 // greatest common divisor for possitive reversed numbers
 std::string gcd(std::string s1, std::string s2){
-    
+    TASK0_STAT(GCD_CALLS, 1);
     while (s1 != "0" and s2 != "0") {
         if (s1 > s2){
             s1 = s1 % s2;
@@ -255,6 +256,7 @@ Rational_number::Rational_number(const Rational_number& other):
 
 
 void Rational_number::make_canonical(){
+    TASK0_STAT(CANONICALIZATIONS, 1);
     std::string tmp = gcd(numerator, denominator);
     while (tmp != "1"){
         numerator = numerator / tmp;
@@ -461,6 +463,34 @@ Rational_number::operator short() const{
     return is_negative ? -res : res;
 }
 
+Rational_number Rational_number::get_numerator() const{
+    Rational_number res;
+    res.numerator = numerator;
+    res.is_negative = is_negative;
+    return res;
+}
+
+Rational_number Rational_number::get_denominator() const{
+    Rational_number res;
+    res.numerator = denominator;
+    return res;
+}
+
+// reversed string number modulo m
+unsigned long long _string_mod(const std::string& reversed_str, unsigned long long m){
+    unsigned long long res = 0;
+    for (auto digit = reversed_str.rbegin(); digit != reversed_str.rend(); digit++){
+        res = (res * BASE + (*digit - '0')) % m;
+    }
+    return res;
+}
+
+std::pair<unsigned long long, unsigned long long> Rational_number::residues(unsigned long long m) const{
+    unsigned long long num = _string_mod(numerator, m);
+    if (is_negative && num != 0) num = m - num;
+    return {num, _string_mod(denominator, m)};
+}
+
 long long Rational_number::floor() const{
     std::string tmp_res = numerator / denominator;
     if (!check_bound<long long>(tmp_res, is_negative))
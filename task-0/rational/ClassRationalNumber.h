@@ -8,6 +8,7 @@
 
 #include <string>
 #include <ostream>
+#include <utility>
 
 /**
  * @brief Class to store rational numbers and perform operation with them.
@@ -86,6 +87,29 @@ public:
      */
     void make_canonical();
 
+    /**
+     * @brief Get numerator as integer Rational_number (with sign of this number)
+     * 
+     * @return Rational_number with denominator 1
+     */
+    Rational_number get_numerator() const;
+
+    /**
+     * @brief Get denominator as integer Rational_number (always positive)
+     * 
+     * @return Rational_number with denominator 1
+     */
+    Rational_number get_denominator() const;
+
+    /**
+     * @brief Get residues of numerator and denominator modulo m
+     * 
+     * Sign is taken into account: residue of negative numerator is m - (|numerator| mod m).
+     * @param m modulus, 0 < m < 2^60
+     * @return {numerator mod m, denominator mod m}
+     */
+    std::pair<unsigned long long, unsigned long long> residues(unsigned long long m) const;
+
     /**
      * @brief Perform floor on rational number if possible
      * 
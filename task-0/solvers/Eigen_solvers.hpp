@@ -0,0 +1,832 @@
+/**
+ * @file Eigen_solvers.hpp
+ * @brief Extreme eigenvalues of sparse matrices: thick-restart Lanczos, implicitly restarted Arnoldi
+ */
+
+#ifndef __EigenSolvers_H__
+#define __EigenSolvers_H__
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <random>
+#include <algorithm>
+#include <numeric>
+
+#include "Solver_kernels.hpp"
+
+#include "../matrix/ClassMatrix.h"
+#include "../matrix/Matrix_csr.hpp"
+#include "../complex/ClassComplex.h"
+#include "../complex/Complex_array.hpp"
+#include "../complex/Scalar_functions.hpp"
+#include "../parallel/Parallel.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+enum class Eigen_target{
+    LARGEST_MAGNITUDE,
+    LARGEST_REAL,       // largest algebraic for hermitian matrices
+    SMALLEST_REAL
+};
+
+struct Eigen_params{
+    int count = 6;              // number of wanted eigenvalues
+    int subspace = 0;           // Krylov vectors kept in memory, 0: max(2 * count + 1, 20) (at most n)
+    int max_restarts = 300;
+    double tolerance = 1e-10;   // relative: ||A * x - lambda * x|| <= tolerance * |lambda|
+    Eigen_target target = Eigen_target::LARGEST_MAGNITUDE;
+    unsigned seed = 1;          // of random starting vector
+};
+
+template<class V, class T>
+struct Eigen_result{
+    std::vector<V> values;                  // in order of target
+    std::vector<std::vector<T>> vectors;    // unit eigenvectors of values
+    int restarts = 0;
+    int multiplications = 0;                // number of products A * v
+    bool converged = false;                 // all count values reached tolerance
+};
+
+// Real type of values (R for Complex_number<R>)
+//////////////////////////////////
+
+template<class T>
+struct _Real_type{
+    using type = T;
+};
+
+template<class R, class I>
+struct _Real_type<Complex_number<R, I>>{
+    using type = R;
+};
+
+template<class T>
+double _real_part(const T& x){
+    return static_cast<double>(x);
+}
+
+template<class R, class I>
+double _real_part(const Complex_number<R, I>& x){
+    return static_cast<double>(x.get_real());
+}
+
+//////////////////////////////////
+
+// Krylov basis
+// Columns v_0 ... v_(columns - 1) of length n are stored one after another in one dense
+// block (split real and imaginary blocks for complex values), so memory is exactly
+// columns * n values. All operations are passes over whole columns in parallel
+// (parallel_for / parallel_reduce of Parallel.hpp, reductions are deterministic).
+//////////////////////////////////
+
+// A * v on basis columns (rows in parallel)
+template<class A>
+struct _Krylov_operator{
+    const Matrix_csr<A>& csr;
+
+    explicit _Krylov_operator(const Matrix_csr<A>& _csr): csr(_csr){}
+
+    // y = A * x, also used for real and imaginary parts of complex x separately
+    void apply(const A* x, A* y) const{
+        const std::vector<int>& row_ptr = csr.get_row_ptr();
+        const int* col_idx = csr.get_col_idx().data();
+        const A* vals = csr.get_vals().data();
+        parallel_for(csr.get_rows_number(), [&](size_t begin, size_t end){
+            for (size_t i = begin; i < end; i++){
+                A sum((long) 0);
+                for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+                    sum += vals[k] * x[col_idx[k]];
+                }
+                y[i] = sum;
+            }
+        });
+    }
+};
+
+// values of complex matrix are split once, rows are gather dot products (Complex_array.hpp)
+template<class R>
+struct _Krylov_operator<Complex_number<R>>{
+    const Matrix_csr<Complex_number<R>>& csr;
+    Complex_array<R> vals;
+
+    explicit _Krylov_operator(const Matrix_csr<Complex_number<R>>& _csr): csr(_csr), vals(_csr.get_vals()){}
+
+    void apply(const R* xr, const R* xi, R* yr, R* yi) const{
+        const std::vector<int>& row_ptr = csr.get_row_ptr();
+        const int* col_idx = csr.get_col_idx().data();
+        parallel_for(csr.get_rows_number(), [&](size_t begin, size_t end){
+            for (size_t i = begin; i < end; i++){
+                size_t from = row_ptr[i], len = row_ptr[i + 1] - row_ptr[i];
+                Complex_number<R> sum = _complex_gather_dot(col_idx + from, vals.real_data() + from,
+                                                            vals.imag_data() + from, xr, xi, len);
+                yr[i] = sum.get_real();
+                yi[i] = sum.get_imag();
+            }
+        });
+    }
+};
+
+// rows of combined block are formed in tiles of this size (fit in cache for all columns)
+constexpr size_t _krylov_tile = 256;
+
+/**
+ * @brief Krylov basis of real vectors
+ */
+template<class T>
+class Krylov_basis{
+private:
+    size_t n;
+    std::vector<T> data;    // v_j is data[j * n, (j + 1) * n)
+public:
+    Krylov_basis(size_t _n, int columns): n(_n), data(_n * columns, T((long) 0)){}
+
+    size_t size() const{
+        return n;
+    }
+
+    T* column(int j){
+        return data.data() + j * n;
+    }
+
+    const T* column(int j) const{
+        return data.data() + j * n;
+    }
+
+    std::vector<T> get_column(int j) const{
+        return std::vector<T>(column(j), column(j) + n);
+    }
+
+    // v_target = A * v_j
+    void multiply(const _Krylov_operator<T>& A, int j, int target){
+        A.apply(column(j), column(target));
+    }
+
+    // dot(v_i, v_j)
+    T dot(int i, int j) const{
+        const T* x = column(i);
+        const T* y = column(j);
+        return parallel_reduce(n, T((long) 0), [&](size_t begin, size_t end){
+            T sum((long) 0);
+            for (size_t k = begin; k < end; k++){
+                sum += x[k] * y[k];
+            }
+            return sum;
+        }, [](const T& lhs, const T& rhs){ return lhs + rhs; });
+    }
+
+    double norm(int j) const{
+        return std::sqrt(_real_part(dot(j, j)));
+    }
+
+    // v_j += a * v_i
+    void axpy(const T& a, int i, int j){
+        const T* x = column(i);
+        T* y = column(j);
+        parallel_for(n, [&](size_t begin, size_t end){
+            for (size_t k = begin; k < end; k++){
+                y[k] += a * x[k];
+            }
+        });
+    }
+
+    void scale(int j, const T& s){
+        T* x = column(j);
+        parallel_for(n, [&](size_t begin, size_t end){
+            for (size_t k = begin; k < end; k++){
+                x[k] *= s;
+            }
+        });
+    }
+
+    void copy(int from, int to){
+        std::copy(column(from), column(from) + n, column(to));
+    }
+
+    void randomize(int j, std::mt19937& gen){
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (size_t k = 0; k < n; k++){
+            column(j)[k] = T(dist(gen));
+        }
+    }
+
+    // [v_0 ... v_(to - 1)] = [v_0 ... v_(from - 1)] * Q, Q is from x to (column-major)
+    void combine(const std::vector<T>& Q, int from, int to){
+        parallel_for(n, [&](size_t begin, size_t end){
+            std::vector<T> tile(_krylov_tile * to);
+            for (size_t row = begin; row < end; row += _krylov_tile){
+                size_t rows = std::min(_krylov_tile, end - row);
+                std::fill(tile.begin(), tile.end(), T((long) 0));
+                for (int c = 0; c < to; c++){
+                    T* out = tile.data() + c * _krylov_tile;
+                    for (int l = 0; l < from; l++){
+                        const T q = Q[c * from + l];
+                        const T* v = column(l) + row;
+                        for (size_t r = 0; r < rows; r++){
+                            out[r] += v[r] * q;
+                        }
+                    }
+                }
+                for (int c = 0; c < to; c++){
+                    std::copy(tile.data() + c * _krylov_tile, tile.data() + c * _krylov_tile + rows, column(c) + row);
+                }
+            }
+        });
+    }
+};
+
+/**
+ * @brief Krylov basis of complex vectors in split (SoA) storage
+ *
+ * Real operator (Matrix_csr<R>) is applied to real and imaginary blocks separately,
+ * complex one by gather dot products of split arrays. Dot products and axpy use kernels
+ * of Complex_array.hpp (AVX2/AVX-512 for R = double).
+ */
+template<class R>
+class Krylov_basis<Complex_number<R>>{
+private:
+    using C = Complex_number<R>;
+
+    size_t n;
+    std::vector<R> re;
+    std::vector<R> im;
+public:
+    Krylov_basis(size_t _n, int columns): n(_n), re(_n * columns, R((long) 0)), im(_n * columns, R((long) 0)){}
+
+    size_t size() const{
+        return n;
+    }
+
+    R* real_column(int j){
+        return re.data() + j * n;
+    }
+
+    R* imag_column(int j){
+        return im.data() + j * n;
+    }
+
+    const R* real_column(int j) const{
+        return re.data() + j * n;
+    }
+
+    const R* imag_column(int j) const{
+        return im.data() + j * n;
+    }
+
+    std::vector<C> get_column(int j) const{
+        std::vector<C> res;
+        res.reserve(n);
+        for (size_t k = 0; k < n; k++){
+            res.emplace_back(real_column(j)[k], imag_column(j)[k]);
+        }
+        return res;
+    }
+
+    void multiply(const _Krylov_operator<R>& A, int j, int target){
+        A.apply(real_column(j), real_column(target));
+        A.apply(imag_column(j), imag_column(target));
+    }
+
+    void multiply(const _Krylov_operator<C>& A, int j, int target){
+        A.apply(real_column(j), imag_column(j), real_column(target), imag_column(target));
+    }
+
+    // sum of conj(v_i[k]) * v_j[k]
+    C dot(int i, int j) const{
+        const R *xr = real_column(i), *xi = imag_column(i), *yr = real_column(j), *yi = imag_column(j);
+        return parallel_reduce(n, C(), [&](size_t begin, size_t end){
+            return _complex_dot(xr + begin, xi + begin, yr + begin, yi + begin, end - begin);
+        }, [](const C& lhs, const C& rhs){ return lhs + rhs; });
+    }
+
+    double norm(int j) const{
+        return std::sqrt(_real_part(dot(j, j)));
+    }
+
+    // v_j += a * v_i
+    void axpy(const C& a, int i, int j){
+        const R *xr = real_column(i), *xi = imag_column(i);
+        R *yr = real_column(j), *yi = imag_column(j);
+        const R ar = a.get_real(), ai = a.get_imag();
+        parallel_for(n, [&](size_t begin, size_t end){
+            for (size_t k = begin; k < end; k++){
+                yr[k] += ar * xr[k] - ai * xi[k];
+                yi[k] += ar * xi[k] + ai * xr[k];
+            }
+        });
+    }
+
+    void scale(int j, const C& s){
+        R *xr = real_column(j), *xi = imag_column(j);
+        const R sr = s.get_real(), si = s.get_imag();
+        parallel_for(n, [&](size_t begin, size_t end){
+            for (size_t k = begin; k < end; k++){
+                R tmp = sr * xr[k] - si * xi[k];
+                xi[k] = sr * xi[k] + si * xr[k];
+                xr[k] = tmp;
+            }
+        });
+    }
+
+    void copy(int from, int to){
+        std::copy(real_column(from), real_column(from) + n, real_column(to));
+        std::copy(imag_column(from), imag_column(from) + n, imag_column(to));
+    }
+
+    void randomize(int j, std::mt19937& gen){
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (size_t k = 0; k < n; k++){
+            real_column(j)[k] = R(dist(gen));
+            imag_column(j)[k] = R(dist(gen));
+        }
+    }
+
+    // [v_0 ... v_(to - 1)] = [v_0 ... v_(from - 1)] * Q, Q is from x to (column-major),
+    // S is R (real combinations of Lanczos) or Complex_number<R>
+    template<class S>
+    void combine(const std::vector<S>& Q, int from, int to){
+        parallel_for(n, [&](size_t begin, size_t end){
+            std::vector<R> tile_re(_krylov_tile * to), tile_im(_krylov_tile * to);
+            for (size_t row = begin; row < end; row += _krylov_tile){
+                size_t rows = std::min(_krylov_tile, end - row);
+                std::fill(tile_re.begin(), tile_re.end(), R((long) 0));
+                std::fill(tile_im.begin(), tile_im.end(), R((long) 0));
+                for (int c = 0; c < to; c++){
+                    R* out_re = tile_re.data() + c * _krylov_tile;
+                    R* out_im = tile_im.data() + c * _krylov_tile;
+                    for (int l = 0; l < from; l++){
+                        const R* vr = real_column(l) + row;
+                        const R* vi = imag_column(l) + row;
+                        if constexpr (std::is_same<S, C>::value){
+                            const R qr = Q[c * from + l].get_real(), qi = Q[c * from + l].get_imag();
+                            for (size_t r = 0; r < rows; r++){
+                                out_re[r] += vr[r] * qr - vi[r] * qi;
+                                out_im[r] += vr[r] * qi + vi[r] * qr;
+                            }
+                        } else {
+                            const R q = Q[c * from + l];
+                            for (size_t r = 0; r < rows; r++){
+                                out_re[r] += vr[r] * q;
+                                out_im[r] += vi[r] * q;
+                            }
+                        }
+                    }
+                }
+                for (int c = 0; c < to; c++){
+                    std::copy(tile_re.data() + c * _krylov_tile, tile_re.data() + c * _krylov_tile + rows, real_column(c) + row);
+                    std::copy(tile_im.data() + c * _krylov_tile, tile_im.data() + c * _krylov_tile + rows, imag_column(c) + row);
+                }
+            }
+        });
+    }
+};
+
+// v_j -= projections on v_0 ... v_(j - 1), two passes of Gram-Schmidt; h[i] = coefficients
+template<class T>
+void _orthogonalize(Krylov_basis<T>& V, int j, std::vector<T>& h){
+    std::fill(h.begin(), h.begin() + j, T((long) 0));
+    for (int pass = 0; pass < 2; pass++){
+        for (int i = 0; i < j; i++){
+            T coef = V.dot(i, j);
+            h[i] += coef;
+            V.axpy(-coef, i, j);
+        }
+    }
+}
+
+// v_j = random unit vector orthogonal to v_0 ... v_(j - 1) (Krylov space is invariant);
+// projections go to own buffer, coefficients of caller are entries of projected matrix
+template<class T>
+void _random_orthonormal(Krylov_basis<T>& V, int j, std::mt19937& gen){
+    std::vector<T> coefs(j);
+    V.randomize(j, gen);
+    _orthogonalize(V, j, coefs);
+    V.scale(j, T(1.0 / V.norm(j)));
+}
+
+// A * v_j -> v_(j + 1), orthogonalized against v_0 ... v_j (h[0 .. j] = coefficients) and
+// normalized, returns its norm before normalization (0 on breakdown)
+template<class T, class A>
+double _krylov_step(Krylov_basis<T>& V, const _Krylov_operator<A>& op, int j, int last,
+                    std::mt19937& gen, std::vector<T>& h){
+    V.multiply(op, j, j + 1);
+    double w_norm = V.norm(j + 1);
+    _orthogonalize(V, j + 1, h);
+    double beta = V.norm(j + 1);
+    if (beta <= 1e-12 * w_norm || w_norm == 0){
+        // invariant subspace: continue with new direction (not needed after last column)
+        if (j + 1 < last) _random_orthonormal(V, j + 1, gen);
+        return 0;
+    }
+    V.scale(j + 1, T(1.0 / beta));
+    return beta;
+}
+
+//////////////////////////////////
+
+// Dense eigenvalue problems of projected matrices (size of Krylov subspace)
+// Matrices are column-major: a[j * ld + i] is a_ij
+//////////////////////////////////
+
+/**
+ * @brief Eigenvalues and eigenvectors of real symmetric m x m matrix (cyclic Jacobi method)
+ */
+inline void _symmetric_eigen(std::vector<double> a, int m, std::vector<double>& values, std::vector<double>& vectors){
+    auto at = [&a, m](int i, int j) -> double&{ return a[j * m + i]; };
+    vectors.assign(m * m, 0.0);
+    for (int i = 0; i < m; i++) vectors[i * m + i] = 1.0;
+
+    for (int sweep = 0; sweep < 100; sweep++){
+        double off = 0, total = 0;
+        for (int j = 0; j < m; j++){
+            for (int i = 0; i < m; i++){
+                total += at(i, j) * at(i, j);
+                if (i != j) off += at(i, j) * at(i, j);
+            }
+        }
+        if (off <= DBL_EPSILON * DBL_EPSILON * total) break;
+        for (int p = 0; p < m - 1; p++){
+            for (int q = p + 1; q < m; q++){
+                double apq = at(p, q);
+                if (apq == 0) continue;
+                double theta = (at(q, q) - at(p, p)) / (2 * apq);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+                double c = 1 / std::sqrt(t * t + 1), s = t * c;
+                for (int k = 0; k < m; k++){
+                    double akp = at(k, p), akq = at(k, q);
+                    at(k, p) = c * akp - s * akq;
+                    at(k, q) = s * akp + c * akq;
+                }
+                for (int k = 0; k < m; k++){
+                    double apk = at(p, k), aqk = at(q, k);
+                    at(p, k) = c * apk - s * aqk;
+                    at(q, k) = s * apk + c * aqk;
+                }
+                for (int k = 0; k < m; k++){
+                    double vkp = vectors[p * m + k], vkq = vectors[q * m + k];
+                    vectors[p * m + k] = c * vkp - s * vkq;
+                    vectors[q * m + k] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    values.resize(m);
+    for (int i = 0; i < m; i++) values[i] = at(i, i);
+}
+
+template<class R>
+Complex_number<R> _complex_sqrt(const Complex_number<R>& z){
+    double x = z.get_real(), y = z.get_imag();
+    double r = std::sqrt(x * x + y * y);
+    double re = std::sqrt(std::max(0.0, (r + x) / 2));
+    double im = std::sqrt(std::max(0.0, (r - x) / 2));
+    return Complex_number<R>(re, y < 0 ? -im : im);
+}
+
+/**
+ * @brief One shifted QR step T - mu * I = Q * R, T = R * Q + mu * I on rows/columns lo ... hi
+ *
+ * T is upper Hessenberg size x size (leading dimension ld), Givens rotations are applied
+ * to whole rows and columns of T (so Schur form of other blocks is kept) and to columns
+ * of Z (z_rows x size).
+ */
+template<class C>
+void _shifted_qr_step(std::vector<C>& T, int ld, int size, int lo, int hi, const C& mu,
+                      std::vector<C>& Z, int z_rows){
+    auto at = [&T, ld](int i, int j) -> C&{ return T[j * ld + i]; };
+    std::vector<double> cs(hi - lo);
+    std::vector<C> sn(hi - lo);
+    for (int i = lo; i <= hi; i++) at(i, i) -= mu;
+    for (int i = lo; i < hi; i++){
+        C x = at(i, i), y = at(i + 1, i);
+        double x_abs = magnitude(x), y_abs = magnitude(y);
+        double r = std::sqrt(x_abs * x_abs + y_abs * y_abs);
+        if (r == 0){
+            cs[i - lo] = 1;
+            sn[i - lo] = C();
+        } else if (x_abs == 0){
+            cs[i - lo] = 0;
+            sn[i - lo] = C(1.0);
+        } else {
+            cs[i - lo] = x_abs / r;
+            sn[i - lo] = (x / C(x_abs)) * conjugate(y) / C(r);
+        }
+        C c(cs[i - lo]), s = sn[i - lo];
+        for (int j = i; j < size; j++){
+            C a = at(i, j), b = at(i + 1, j);
+            at(i, j) = c * a + s * b;
+            at(i + 1, j) = c * b - conjugate(s) * a;
+        }
+    }
+    for (int i = lo; i < hi; i++){
+        C c(cs[i - lo]), s = sn[i - lo];
+        for (int k = 0; k <= std::min(i + 2, hi); k++){
+            C a = at(k, i), b = at(k, i + 1);
+            at(k, i) = c * a + conjugate(s) * b;
+            at(k, i + 1) = c * b - s * a;
+        }
+        for (int k = 0; k < z_rows; k++){
+            C a = Z[i * z_rows + k], b = Z[(i + 1) * z_rows + k];
+            Z[i * z_rows + k] = c * a + conjugate(s) * b;
+            Z[(i + 1) * z_rows + k] = c * b - s * a;
+        }
+    }
+    for (int i = lo; i <= hi; i++) at(i, i) += mu;
+}
+
+/**
+ * @brief Eigenvalues and eigenvectors of complex upper Hessenberg m x m matrix
+ *
+ * Shifted QR algorithm (Wilkinson shifts, deflation) gives Schur form T = Z^* * H * Z,
+ * eigenvectors of triangular T are found by back substitution and multiplied by Z.
+ * vectors are unit columns (column-major m x m).
+ */
+template<class C>
+void _hessenberg_eigen(std::vector<C> T, int m, std::vector<C>& values, std::vector<C>& vectors){
+    auto at = [&T, m](int i, int j) -> C&{ return T[j * m + i]; };
+    std::vector<C> Z(m * m, C());
+    for (int i = 0; i < m; i++) Z[i * m + i] = C(1.0);
+
+    double t_norm = 0;
+    for (const C& x : T) t_norm = std::max(t_norm, magnitude(x));
+    int hi = m - 1, iterations = 0;
+    while (hi > 0 && iterations < 100 * m){
+        int lo = hi;
+        for (; lo > 0; lo--){
+            double scale = magnitude(at(lo - 1, lo - 1)) + magnitude(at(lo, lo));
+            if (scale == 0) scale = t_norm;
+            if (magnitude(at(lo, lo - 1)) <= DBL_EPSILON * scale){
+                at(lo, lo - 1) = C();
+                break;
+            }
+        }
+        if (lo == hi){
+            hi--;
+            continue;
+        }
+        iterations++;
+        // eigenvalue of trailing 2 x 2 block closer to its last diagonal value
+        C a = at(hi - 1, hi - 1), b = at(hi - 1, hi), c = at(hi, hi - 1), d = at(hi, hi);
+        C half_diff = (a - d) * C(0.5);
+        C disc = _complex_sqrt(half_diff * half_diff + b * c);
+        C denom = magnitude(half_diff + disc) >= magnitude(half_diff - disc) ? half_diff + disc : half_diff - disc;
+        C mu = magnitude(denom) == 0 ? d : d - b * c / denom;
+        if (iterations % 11 == 10) mu = d + C(magnitude(at(hi, hi - 1)));     // exceptional shift
+        _shifted_qr_step(T, m, m, lo, hi, mu, Z, m);
+    }
+
+    values.resize(m);
+    vectors.assign(m * m, C());
+    std::vector<C> x(m);
+    double small = DBL_EPSILON * std::max(t_norm, DBL_MIN);
+    for (int k = 0; k < m; k++){
+        values[k] = at(k, k);
+        std::fill(x.begin(), x.end(), C());
+        x[k] = C(1.0);
+        for (int i = k - 1; i >= 0; i--){
+            C sum;
+            for (int j = i + 1; j <= k; j++) sum += at(i, j) * x[j];
+            C diff = at(i, i) - values[k];
+            if (magnitude(diff) < small) diff = C(small);
+            x[i] = -sum / diff;
+        }
+        double norm = 0;
+        for (int i = 0; i < m; i++){
+            C sum;
+            for (int j = 0; j <= k; j++) sum += Z[j * m + i] * x[j];
+            vectors[k * m + i] = sum;
+            norm += _real_part(sum.module_square());
+        }
+        norm = std::sqrt(norm);
+        for (int i = 0; i < m; i++) vectors[k * m + i] /= C(norm);
+    }
+}
+
+//////////////////////////////////
+
+// Common parts
+//////////////////////////////////
+
+// size of Krylov subspace; throws Shape_error if A is not square, Init_error for wrong count
+template<class T>
+int _eigen_subspace(const Matrix_csr<T>& A, const Eigen_params& params){
+    int n = A.get_rows_number();
+    if (n != A.get_columns_number()){
+        throw Shape_error("Eigenvalues are defined for square matrices only: ",
+                          {n, A.get_columns_number()}, {A.get_columns_number(), n});
+    }
+    if (params.count < 1 || params.count > n){
+        throw Init_error("Number of eigenvalues must be in [1, n], got: ", std::to_string(params.count));
+    }
+    int m = params.subspace > 0 ? params.subspace : std::max(2 * params.count + 1, 20);
+    m = std::min(m, n);
+    if (m <= params.count && m < n){
+        throw Init_error("Krylov subspace must be larger than number of eigenvalues, got: ", std::to_string(m));
+    }
+    return m;
+}
+
+// indices of values from most to least wanted
+template<class V>
+std::vector<int> _eigen_order(const std::vector<V>& values, Eigen_target target){
+    std::vector<int> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto key = [&](int i){
+        switch (target){
+            case Eigen_target::LARGEST_REAL: return -_real_part(values[i]);
+            case Eigen_target::SMALLEST_REAL: return _real_part(values[i]);
+            default: return -magnitude(values[i]);
+        }
+    };
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b){ return key(a) < key(b); });
+    return order;
+}
+
+// Ritz value is converged if ||A * x - theta * x|| = |beta * y_last| <= tolerance * max(|theta|, eps^(2/3))
+template<class V>
+bool _ritz_converged(const V& theta, double residual, double tolerance){
+    return residual <= tolerance * std::max(magnitude(theta), std::pow(DBL_EPSILON, 2.0 / 3));
+}
+
+//////////////////////////////////
+
+// Solvers on CSR snapshot
+//////////////////////////////////
+
+/**
+ * @brief Thick-restart Lanczos method for hermitian (symmetric) matrices
+ *
+ * Builds m = params.subspace orthonormal Krylov vectors (full reorthogonalization),
+ * projected matrix H = V^* * A * V is real symmetric, its eigenpairs (Jacobi) give Ritz
+ * pairs. On restart (k + m) / 2 most wanted Ritz vectors and residual vector are kept
+ * (Wu-Simon thick restart, equivalent to implicit restart for hermitian A), H becomes
+ * diagonal with coupling row. Memory: m + 1 vectors of length n (split real/imaginary
+ * blocks for complex values). A is not checked for symmetry.
+ */
+template<class T>
+Eigen_result<double, T> lanczos(const Matrix_csr<T>& A, const Eigen_params& params = Eigen_params()){
+    int m = _eigen_subspace(A, params);
+    int n = A.get_rows_number(), k = params.count;
+    _Krylov_operator<T> op(A);
+    Krylov_basis<T> V(n, m + 1);
+    std::mt19937 gen(params.seed);
+    std::vector<T> h(m + 1);
+    std::vector<double> H(m * m, 0.0), theta, Y;
+    Eigen_result<double, T> res;
+
+    V.randomize(0, gen);
+    V.scale(0, T(1.0 / V.norm(0)));
+    int start = 0;
+    double beta = 0;
+    while (true){
+        for (int j = start; j < m; j++){
+            beta = _krylov_step(V, op, j, m, gen, h);
+            res.multiplications++;
+            H[j * m + j] = _real_part(h[j]);
+            if (j + 1 < m){
+                H[j * m + j + 1] = H[(j + 1) * m + j] = beta;
+            }
+        }
+        _symmetric_eigen(H, m, theta, Y);
+        std::vector<int> order = _eigen_order(theta, params.target);
+        int converged = 0;
+        for (int c = 0; c < k; c++){
+            if (_ritz_converged(theta[order[c]], std::abs(beta * Y[order[c] * m + m - 1]), params.tolerance)) converged++;
+        }
+
+        // whole space (m = n) is invariant, nothing to restart
+        bool done = converged == k || res.restarts >= params.max_restarts || m == n;
+        int keep = done ? k : std::min(m - 1, (k + m) / 2);
+        std::vector<double> Q(m * keep);
+        for (int c = 0; c < keep; c++){
+            std::copy(Y.begin() + order[c] * m, Y.begin() + (order[c] + 1) * m, Q.begin() + c * m);
+        }
+        V.combine(Q, m, keep);
+
+        if (done){
+            res.converged = converged == k;
+            for (int c = 0; c < k; c++){
+                res.values.push_back(theta[order[c]]);
+                res.vectors.push_back(V.get_column(c));
+            }
+            return res;
+        }
+        res.restarts++;
+        V.copy(m, keep);
+        std::fill(H.begin(), H.end(), 0.0);
+        for (int c = 0; c < keep; c++){
+            H[c * m + c] = theta[order[c]];
+            H[c * m + keep] = H[keep * m + c] = beta * Y[order[c] * m + m - 1];
+        }
+        start = keep;
+    }
+}
+
+/**
+ * @brief Implicitly restarted Arnoldi method for general matrices
+ *
+ * Builds m = params.subspace Krylov vectors (Hessenberg H = V^* * A * V, two passes of
+ * Gram-Schmidt), Ritz values are eigenvalues of H (shifted QR). On restart m - (k + m) / 2
+ * unwanted Ritz values are applied as exact shifts to H (implicit QR steps), basis is
+ * compressed to (k + m) / 2 vectors and extended again (Sorensen's implicit restart).
+ * Eigenvalues of real matrices may be complex, so basis is always complex in split
+ * (real/imaginary) blocks: memory is m + 1 complex vectors of length n.
+ */
+template<class T>
+Eigen_result<Complex_number<typename _Real_type<T>::type>, Complex_number<typename _Real_type<T>::type>>
+arnoldi(const Matrix_csr<T>& A, const Eigen_params& params = Eigen_params()){
+    using C = Complex_number<typename _Real_type<T>::type>;
+    int m = _eigen_subspace(A, params);
+    int n = A.get_rows_number(), k = params.count, ld = m + 1;
+    _Krylov_operator<T> op(A);
+    Krylov_basis<C> V(n, m + 1);
+    std::mt19937 gen(params.seed);
+    std::vector<C> h(m + 1), H(ld * m, C()), Hm(m * m), theta, Y, Q;
+    auto at = [&H, ld](int i, int j) -> C&{ return H[j * ld + i]; };
+    Eigen_result<C, C> res;
+
+    V.randomize(0, gen);
+    V.scale(0, C(1.0 / V.norm(0)));
+    int start = 0;
+    while (true){
+        for (int j = start; j < m; j++){
+            double beta = _krylov_step(V, op, j, m, gen, h);
+            res.multiplications++;
+            for (int i = 0; i <= j; i++) at(i, j) = h[i];
+            at(j + 1, j) = C(beta);
+        }
+        for (int j = 0; j < m; j++){
+            std::copy(H.begin() + j * ld, H.begin() + j * ld + m, Hm.begin() + j * m);
+        }
+        _hessenberg_eigen(Hm, m, theta, Y);
+        std::vector<int> order = _eigen_order(theta, params.target);
+        double beta = magnitude(at(m, m - 1));
+        int converged = 0;
+        for (int c = 0; c < k; c++){
+            if (_ritz_converged(theta[order[c]], beta * magnitude(Y[order[c] * m + m - 1]), params.tolerance)) converged++;
+        }
+
+        if (converged == k || res.restarts >= params.max_restarts || m == n){
+            res.converged = converged == k;
+            Q.resize(m * k);
+            for (int c = 0; c < k; c++){
+                std::copy(Y.begin() + order[c] * m, Y.begin() + (order[c] + 1) * m, Q.begin() + c * m);
+            }
+            V.combine(Q, m, k);
+            for (int c = 0; c < k; c++){
+                res.values.push_back(theta[order[c]]);
+                res.vectors.push_back(V.get_column(c));
+            }
+            return res;
+        }
+        res.restarts++;
+
+        // exact shifts: H = Q^* * H * Q, A * V * Q = V * Q * H + f * e_m^T * Q
+        int keep = std::min(m - 1, (k + m) / 2);
+        Q.assign(m * m, C());
+        for (int i = 0; i < m; i++) Q[i * m + i] = C(1.0);
+        for (int c = keep; c < m; c++){
+            _shifted_qr_step(H, ld, m, 0, m - 1, theta[order[c]], Q, m);
+        }
+        // new residual: v_keep * H(keep, keep - 1) + f * Q(m - 1, keep - 1)
+        C sigma = at(m, m - 1) * Q[(keep - 1) * m + m - 1];
+        C h_keep = at(keep, keep - 1);
+        V.combine(Q, m, keep + 1);
+        V.scale(m, sigma);
+        V.axpy(h_keep, keep, m);
+        double f_norm = V.norm(m);
+        if (f_norm <= 1e-12 * magnitude(h_keep) || f_norm == 0){
+            _random_orthonormal(V, keep, gen);
+            f_norm = 0;
+        } else {
+            V.copy(m, keep);
+            V.scale(keep, C(1.0 / f_norm));
+        }
+        for (int j = keep; j < m; j++){
+            std::fill(H.begin() + j * ld, H.begin() + (j + 1) * ld, C());
+        }
+        for (int i = keep + 1; i <= m; i++) at(i, keep - 1) = C();
+        at(keep, keep - 1) = C(f_norm);
+        start = keep;
+    }
+}
+
+//////////////////////////////////
+
+// Versions for Matrix: A is compressed once
+//////////////////////////////////
+
+template<class T>
+Eigen_result<double, T> eigs_hermitian(const Matrix<T>& A, const Eigen_params& params = Eigen_params()){
+    return lanczos(Matrix_csr<T>(A), params);
+}
+
+template<class T>
+Eigen_result<Complex_number<typename _Real_type<T>::type>, Complex_number<typename _Real_type<T>::type>>
+eigs(const Matrix<T>& A, const Eigen_params& params = Eigen_params()){
+    return arnoldi(Matrix_csr<T>(A), params);
+}
+
+//////////////////////////////////
+
+#endif // __EigenSolvers_H__
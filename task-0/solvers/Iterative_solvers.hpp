@@ -0,0 +1,316 @@
+/**
+ * @file Iterative_solvers.hpp
+ * @brief Krylov solvers for A * x = b: CG, BiCGSTAB, restarted GMRES
+ */
+
+#ifndef __IterativeSolvers_H__
+#define __IterativeSolvers_H__
+
+#include <vector>
+#include <cmath>
+
+#include "Solver_kernels.hpp"
+#include "Preconditioners.hpp"
+
+#include "../matrix/ClassMatrix.h"
+#include "../matrix/Matrix_csr.hpp"
+#include "../vector/ClassVector.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+struct Solver_params{
+    int max_iterations = 1000;
+    double tolerance = 1e-10;   // relative: ||b - A * x|| <= tolerance * ||b||
+    int restart = 30;           // Krylov subspace size for GMRES
+};
+
+struct Solver_result{
+    int iterations = 0;
+    double residual = 0;        // relative residual norm at exit
+    bool converged = false;
+};
+
+// Core versions work with CSR snapshot and dense arrays, x contains initial guess
+// and is overwritten with solution. Preconditioner M is applied as z = M^(-1) * r.
+//////////////////////////////////
+
+/**
+ * @brief Preconditioned conjugate gradient method
+ *
+ * A must be symmetric (hermitian for complex values) positive definite, M too.
+ */
+template<class T>
+Solver_result cg(const Matrix_csr<T>& A, const std::vector<T>& b, std::vector<T>& x,
+                 const Preconditioner<T>& M, const Solver_params& params = Solver_params()){
+    Solver_result res;
+    int n = A.get_rows_number();
+    double b_norm = norm2(b);
+    if (b_norm == 0){
+        x.assign(n, T((long) 0));
+        res.converged = true;
+        return res;
+    }
+
+    std::vector<T> r(n), z(n), p(n), q(n);
+    residual(A, x, b, r);
+    res.residual = norm2(r) / b_norm;
+    if (res.residual <= params.tolerance){
+        res.converged = true;
+        return res;
+    }
+    M.apply(r, z);
+    p = z;
+    T rz = dot(r, z);
+
+    while (res.iterations < params.max_iterations){
+        res.iterations++;
+        T alpha = rz / spmv_dot(A, p, q, p);
+        double rr = axpy_pair_norm(alpha, p, q, x, r);
+        res.residual = std::sqrt(rr) / b_norm;
+        if (res.residual <= params.tolerance){
+            res.converged = true;
+            break;
+        }
+        M.apply(r, z);
+        T rz_new = dot(r, z);
+        xpby(z, rz_new / rz, p);
+        rz = rz_new;
+    }
+    return res;
+}
+
+/**
+ * @brief Preconditioned stabilized biconjugate gradient method (right preconditioning)
+ *
+ * Works for general nonsingular A. Stops with converged == false on breakdown.
+ */
+template<class T>
+Solver_result bicgstab(const Matrix_csr<T>& A, const std::vector<T>& b, std::vector<T>& x,
+                       const Preconditioner<T>& M, const Solver_params& params = Solver_params()){
+    Solver_result res;
+    int n = A.get_rows_number();
+    const T zero((long) 0), one((long) 1);
+    double b_norm = norm2(b);
+    if (b_norm == 0){
+        x.assign(n, zero);
+        res.converged = true;
+        return res;
+    }
+
+    std::vector<T> r(n), r_hat(n), p(n, zero), v(n, zero), s(n), t(n), p_hat(n), s_hat(n);
+    residual(A, x, b, r);
+    res.residual = norm2(r) / b_norm;
+    if (res.residual <= params.tolerance){
+        res.converged = true;
+        return res;
+    }
+    r_hat = r;
+    T rho = one, alpha = one, omega = one;
+
+    while (res.iterations < params.max_iterations){
+        res.iterations++;
+        T rho_new = dot(r_hat, r);
+        if (rho_new == zero) break;         // breakdown
+        T beta = (rho_new / rho) * (alpha / omega);
+        for (int i = 0; i < n; i++){
+            p[i] = r[i] + beta * (p[i] - omega * v[i]);
+        }
+        M.apply(p, p_hat);
+        T r_hat_v = spmv_dot(A, p_hat, v, r_hat);
+        if (r_hat_v == zero) break;         // breakdown
+        alpha = rho_new / r_hat_v;
+
+        double ss = xmay_norm(r, alpha, v, s);
+        if (std::sqrt(ss) / b_norm <= params.tolerance){
+            axpy(alpha, p_hat, x);
+            res.residual = std::sqrt(ss) / b_norm;
+            res.converged = true;
+            break;
+        }
+
+        M.apply(s, s_hat);
+        T ts;
+        double tt;
+        spmv_dot2(A, s_hat, t, s, ts, tt);
+        if (tt == 0) break;                 // breakdown
+        omega = ts / T(tt);
+
+        double rr = 0;
+        for (int i = 0; i < n; i++){
+            x[i] += alpha * p_hat[i] + omega * s_hat[i];
+            r[i] = s[i] - omega * t[i];
+            double tmp = magnitude(r[i]);
+            rr += tmp * tmp;
+        }
+        res.residual = std::sqrt(rr) / b_norm;
+        if (res.residual <= params.tolerance){
+            res.converged = true;
+            break;
+        }
+        if (omega == zero) break;           // breakdown
+        rho = rho_new;
+    }
+    return res;
+}
+
+/**
+ * @brief Restarted GMRES(m) method with right preconditioning
+ *
+ * m is params.restart. Memory: m + 1 basis vectors.
+ * Uses modified Gram-Schmidt and Givens rotations for least squares problem.
+ */
+template<class T>
+Solver_result gmres(const Matrix_csr<T>& A, const std::vector<T>& b, std::vector<T>& x,
+                    const Preconditioner<T>& M, const Solver_params& params = Solver_params()){
+    Solver_result res;
+    int n = A.get_rows_number();
+    int m = std::max(1, std::min(params.restart, n));
+    const T zero((long) 0);
+    double b_norm = norm2(b);
+    if (b_norm == 0){
+        x.assign(n, zero);
+        res.converged = true;
+        return res;
+    }
+
+    std::vector<std::vector<T>> V(m + 1, std::vector<T>(n));
+    std::vector<std::vector<T>> H(m + 1, std::vector<T>(m, zero));
+    std::vector<T> cs(m), sn(m), g(m + 1), y(m), w(n), z(n);
+
+    residual(A, x, b, w);
+    double beta = norm2(w);
+    res.residual = beta / b_norm;
+    if (res.residual <= params.tolerance){
+        res.converged = true;
+        return res;
+    }
+
+    while (res.iterations < params.max_iterations){
+        for (int i = 0; i < n; i++){
+            V[0][i] = w[i] / T(beta);
+        }
+        std::fill(g.begin(), g.end(), zero);
+        g[0] = T(beta);
+
+        int k = 0;      // number of built basis vectors
+        while (k < m && res.iterations < params.max_iterations){
+            res.iterations++;
+            M.apply(V[k], z);
+            A.multiply(z.data(), w.data());
+            for (int i = 0; i <= k; i++){
+                H[i][k] = dot(V[i], w);
+                axpy(-H[i][k], V[i], w);
+            }
+            double h_next = norm2(w);
+            H[k + 1][k] = T(h_next);
+            if (h_next != 0){
+                for (int i = 0; i < n; i++){
+                    V[k + 1][i] = w[i] / T(h_next);
+                }
+            }
+
+            for (int i = 0; i < k; i++){
+                T tmp = cs[i] * H[i][k] + sn[i] * H[i + 1][k];
+                H[i + 1][k] = -conjugate(sn[i]) * H[i][k] + cs[i] * H[i + 1][k];
+                H[i][k] = tmp;
+            }
+            // rotation which eliminates H[k + 1][k]
+            double a_abs = magnitude(H[k][k]);
+            double r = std::sqrt(a_abs * a_abs + h_next * h_next);
+            if (a_abs == 0){
+                cs[k] = zero;
+                sn[k] = T((long) 1);
+            } else {
+                cs[k] = T(a_abs / r);
+                sn[k] = (H[k][k] / T(a_abs)) * conjugate(H[k + 1][k]) / T(r);
+            }
+            H[k][k] = cs[k] * H[k][k] + sn[k] * H[k + 1][k];
+            H[k + 1][k] = zero;
+            g[k + 1] = -conjugate(sn[k]) * g[k];
+            g[k] = cs[k] * g[k];
+            k++;
+
+            res.residual = magnitude(g[k]) / b_norm;
+            if (res.residual <= params.tolerance || h_next == 0) break;
+        }
+
+        // y = H^(-1) * g, x += M^(-1) * (V * y)
+        for (int i = k - 1; i >= 0; i--){
+            T sum = g[i];
+            for (int j = i + 1; j < k; j++){
+                sum -= H[i][j] * y[j];
+            }
+            y[i] = sum / H[i][i];
+        }
+        std::fill(w.begin(), w.end(), zero);
+        for (int j = 0; j < k; j++){
+            axpy(y[j], V[j], w);
+        }
+        M.apply(w, z);
+        axpy(T((long) 1), z, x);
+
+        residual(A, x, b, w);
+        beta = norm2(w);
+        res.residual = beta / b_norm;
+        if (res.residual <= params.tolerance){
+            res.converged = true;
+            break;
+        }
+    }
+    return res;
+}
+
+//////////////////////////////////
+
+// Versions for Matrix and Vector: A is compressed once, x contains initial guess
+// and is overwritten with solution.
+//////////////////////////////////
+
+template<class T>
+void _check_system_shape(const Matrix<T>& A, const Vector<T>& b, const Vector<T>& x){
+    if (A.get_rows_number() != A.get_columns_number()){
+        throw Shape_error("Matrix of linear system must be square, got: ",
+                          {A.get_rows_number(), A.get_columns_number()}, {b.get_max_size(), x.get_max_size()});
+    }
+    if (A.get_rows_number() != b.get_max_size() || A.get_columns_number() != x.get_max_size()){
+        throw Shape_error("Wrong shapes for linear system (A, b): ",
+                          {A.get_rows_number(), A.get_columns_number()}, {b.get_max_size(), x.get_max_size()});
+    }
+}
+
+template<class T, class Solver>
+Solver_result _solve_system(const Matrix<T>& A, const Vector<T>& b, Vector<T>& x,
+                            Preconditioner_type precond, const Solver_params& params, Solver solver){
+    _check_system_shape(A, b, x);
+    Matrix_csr<T> csr(A);
+    auto M = make_preconditioner(precond, csr);
+    std::vector<T> x_dense = x.to_dense();
+    Solver_result res = solver(csr, b.to_dense(), x_dense, *M, params);
+    x.assign_dense(std::move(x_dense));     // residual is of unfiltered solution
+    return res;
+}
+
+template<class T>
+Solver_result solve_cg(const Matrix<T>& A, const Vector<T>& b, Vector<T>& x,
+                       Preconditioner_type precond = Preconditioner_type::NONE,
+                       const Solver_params& params = Solver_params()){
+    return _solve_system(A, b, x, precond, params, cg<T>);
+}
+
+template<class T>
+Solver_result solve_bicgstab(const Matrix<T>& A, const Vector<T>& b, Vector<T>& x,
+                             Preconditioner_type precond = Preconditioner_type::NONE,
+                             const Solver_params& params = Solver_params()){
+    return _solve_system(A, b, x, precond, params, bicgstab<T>);
+}
+
+template<class T>
+Solver_result solve_gmres(const Matrix<T>& A, const Vector<T>& b, Vector<T>& x,
+                          Preconditioner_type precond = Preconditioner_type::NONE,
+                          const Solver_params& params = Solver_params()){
+    return _solve_system(A, b, x, precond, params, gmres<T>);
+}
+
+//////////////////////////////////
+
+#endif // __IterativeSolvers_H__
@@ -0,0 +1,160 @@
+#ifndef __Preconditioners_H__
+#define __Preconditioners_H__
+
+#include <vector>
+#include <memory>
+#include <string>
+
+#include "../matrix/Matrix_csr.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+enum class Preconditioner_type {
+    NONE,
+    JACOBI,
+    ILU0,
+};
+
+/**
+ * @brief Interface of preconditioner M for iterative solvers.
+ *
+ * apply() computes z = M^(-1) * r, z is already allocated by solver.
+ *
+ * @tparam T - type of matrix's elements
+ */
+template<class T>
+class Preconditioner{
+public:
+    virtual ~Preconditioner() = default;
+    virtual void apply(const std::vector<T>& r, std::vector<T>& z) const = 0;
+};
+
+// M = I
+template<class T>
+class Identity_preconditioner: public Preconditioner<T>{
+public:
+    void apply(const std::vector<T>& r, std::vector<T>& z) const override{
+        z = r;
+    }
+};
+
+/**
+ * @brief Jacobi preconditioner: M = diag(A)
+ *
+ * @throw Zero_division if some diagonal element is zero
+ */
+template<class T>
+class Jacobi_preconditioner: public Preconditioner<T>{
+private:
+    std::vector<T> inv_diag;
+public:
+    explicit Jacobi_preconditioner(const Matrix_csr<T>& A){
+        inv_diag = A.get_diagonal();
+        const T zero((long) 0), one((long) 1);
+        for (size_t i = 0; i < inv_diag.size(); i++){
+            if (inv_diag[i] == zero){
+                throw Zero_division("Jacobi preconditioner: zero diagonal element in row " + std::to_string(i));
+            }
+            inv_diag[i] = one / inv_diag[i];
+        }
+    }
+
+    void apply(const std::vector<T>& r, std::vector<T>& z) const override{
+        for (size_t i = 0; i < r.size(); i++){
+            z[i] = inv_diag[i] * r[i];
+        }
+    }
+};
+
+/**
+ * @brief Incomplete LU factorization with zero fill-in: M = L * U
+ *
+ * L and U keep sparsity pattern of A (L has unit diagonal and is not stored).
+ *
+ * @throw Zero_division if zero pivot appears during factorization
+ */
+template<class T>
+class ILU0_preconditioner: public Preconditioner<T>{
+private:
+    Matrix_csr<T> LU;
+    std::vector<int> diag_pos;  // position of (i, i) in LU arrays
+public:
+    explicit ILU0_preconditioner(const Matrix_csr<T>& A): LU(A), diag_pos(A.get_rows_number(), -1){
+        const std::vector<int>& row_ptr = LU.get_row_ptr();
+        const std::vector<int>& col_idx = LU.get_col_idx();
+        std::vector<T>& vals = LU.get_vals();
+        int n = LU.get_rows_number();
+        const T zero((long) 0);
+
+        for (int i = 0; i < n; i++){
+            for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+                if (col_idx[k] == i) diag_pos[i] = k;
+            }
+            if (diag_pos[i] == -1){
+                throw Zero_division("ILU(0) preconditioner: missing diagonal element in row " + std::to_string(i));
+            }
+        }
+
+        std::vector<int> pos_in_row(LU.get_columns_number(), -1);
+        for (int i = 0; i < n; i++){
+            for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+                pos_in_row[col_idx[k]] = k;
+            }
+            for (int k = row_ptr[i]; k < row_ptr[i + 1] && col_idx[k] < i; k++){
+                int p = col_idx[k];
+                if (vals[diag_pos[p]] == zero){
+                    throw Zero_division("ILU(0) preconditioner: zero pivot in row " + std::to_string(p));
+                }
+                vals[k] = vals[k] / vals[diag_pos[p]];
+                for (int j = diag_pos[p] + 1; j < row_ptr[p + 1]; j++){
+                    int pos = pos_in_row[col_idx[j]];
+                    if (pos != -1){
+                        vals[pos] -= vals[k] * vals[j];
+                    }
+                }
+            }
+            for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+                pos_in_row[col_idx[k]] = -1;
+            }
+        }
+    }
+
+    // forward substitution with L, then backward substitution with U
+    void apply(const std::vector<T>& r, std::vector<T>& z) const override{
+        const std::vector<int>& row_ptr = LU.get_row_ptr();
+        const std::vector<int>& col_idx = LU.get_col_idx();
+        const std::vector<T>& vals = LU.get_vals();
+        int n = LU.get_rows_number();
+
+        for (int i = 0; i < n; i++){
+            T sum = r[i];
+            for (int k = row_ptr[i]; k < diag_pos[i]; k++){
+                sum -= vals[k] * z[col_idx[k]];
+            }
+            z[i] = sum;
+        }
+        for (int i = n - 1; i >= 0; i--){
+            T sum = z[i];
+            for (int k = diag_pos[i] + 1; k < row_ptr[i + 1]; k++){
+                sum -= vals[k] * z[col_idx[k]];
+            }
+            z[i] = sum / vals[diag_pos[i]];
+        }
+    }
+};
+
+// Create preconditioner of given type for matrix A
+template<class T>
+std::unique_ptr<Preconditioner<T>> make_preconditioner(Preconditioner_type type, const Matrix_csr<T>& A){
+    switch (type) {
+        case Preconditioner_type::JACOBI:
+            return std::make_unique<Jacobi_preconditioner<T>>(A);
+        case Preconditioner_type::ILU0:
+            return std::make_unique<ILU0_preconditioner<T>>(A);
+        case Preconditioner_type::NONE:
+            break;
+    }
+    return std::make_unique<Identity_preconditioner<T>>();
+}
+
+#endif // __Preconditioners_H__
@@ -0,0 +1,126 @@
+#ifndef __SolverKernels_H__
+#define __SolverKernels_H__
+
+#include <vector>
+#include <cmath>
+
+#include "../matrix/Matrix_csr.hpp"
+#include "../complex/ClassComplex.h"
+#include "../complex/Scalar_functions.hpp"
+
+// Dense kernels used by iterative solvers.
+// Work vectors are allocated once by a solver and updated in place, several
+// BLAS-1 steps of one iteration are fused into a single pass over memory.
+
+// sum of conj(x[i]) * y[i]
+template<class T>
+T dot(const std::vector<T>& x, const std::vector<T>& y){
+    T sum((long) 0);
+    for (size_t i = 0; i < x.size(); i++){
+        sum += conjugate(x[i]) * y[i];
+    }
+    return sum;
+}
+
+// euclidean norm
+template<class T>
+double norm2(const std::vector<T>& x){
+    double sum = 0;
+    for (const auto& elem : x){
+        double tmp = magnitude(elem);
+        sum += tmp * tmp;
+    }
+    return std::sqrt(sum);
+}
+
+// y += a * x
+template<class T>
+void axpy(const T& a, const std::vector<T>& x, std::vector<T>& y){
+    for (size_t i = 0; i < x.size(); i++){
+        y[i] += a * x[i];
+    }
+}
+
+// y = x + b * y
+template<class T>
+void xpby(const std::vector<T>& x, const T& b, std::vector<T>& y){
+    for (size_t i = 0; i < x.size(); i++){
+        y[i] = x[i] + b * y[i];
+    }
+}
+
+// r = b - A * x
+template<class T>
+void residual(const Matrix_csr<T>& A, const std::vector<T>& x, const std::vector<T>& b, std::vector<T>& r){
+    A.multiply(x.data(), r.data());
+    for (size_t i = 0; i < r.size(); i++){
+        r[i] = b[i] - r[i];
+    }
+}
+
+// fused: y = A * x, return dot(w, y)
+template<class T>
+T spmv_dot(const Matrix_csr<T>& A, const std::vector<T>& x, std::vector<T>& y, const std::vector<T>& w){
+    const std::vector<int>& row_ptr = A.get_row_ptr();
+    const std::vector<int>& col_idx = A.get_col_idx();
+    const std::vector<T>& vals = A.get_vals();
+    T res((long) 0);
+    for (int i = 0; i < A.get_rows_number(); i++){
+        T sum((long) 0);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            sum += vals[k] * x[col_idx[k]];
+        }
+        y[i] = sum;
+        res += conjugate(w[i]) * sum;
+    }
+    return res;
+}
+
+// fused: y = A * x, dot_wy = dot(y, w), yy = dot(y, y)
+template<class T>
+void spmv_dot2(const Matrix_csr<T>& A, const std::vector<T>& x, std::vector<T>& y,
+               const std::vector<T>& w, T& dot_yw, double& yy){
+    const std::vector<int>& row_ptr = A.get_row_ptr();
+    const std::vector<int>& col_idx = A.get_col_idx();
+    const std::vector<T>& vals = A.get_vals();
+    dot_yw = T((long) 0);
+    yy = 0;
+    for (int i = 0; i < A.get_rows_number(); i++){
+        T sum((long) 0);
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+            sum += vals[k] * x[col_idx[k]];
+        }
+        y[i] = sum;
+        dot_yw += conjugate(sum) * w[i];
+        double tmp = magnitude(sum);
+        yy += tmp * tmp;
+    }
+}
+
+// fused: x += a * p, r -= a * q, return dot(r, r)
+template<class T>
+double axpy_pair_norm(const T& a, const std::vector<T>& p, const std::vector<T>& q,
+                      std::vector<T>& x, std::vector<T>& r){
+    double rr = 0;
+    for (size_t i = 0; i < x.size(); i++){
+        x[i] += a * p[i];
+        r[i] -= a * q[i];
+        double tmp = magnitude(r[i]);
+        rr += tmp * tmp;
+    }
+    return rr;
+}
+
+// fused: r = s - a * t, return dot(r, r)
+template<class T>
+double xmay_norm(const std::vector<T>& s, const T& a, const std::vector<T>& t, std::vector<T>& r){
+    double rr = 0;
+    for (size_t i = 0; i < s.size(); i++){
+        r[i] = s[i] - a * t[i];
+        double tmp = magnitude(r[i]);
+        rr += tmp * tmp;
+    }
+    return rr;
+}
+
+#endif // __SolverKernels_H__
@@ -0,0 +1,171 @@
+/**
+ * @file Stats.hpp
+ * @brief Optional per-thread counters of allocations, gcd calls, hash probes and fake values
+ */
+
+#ifndef __Task0Stats_H__
+#define __Task0Stats_H__
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+
+/**
+ * Library code records events with TASK0_STAT(counter, n). Without TASK0_STATS (cmake
+ * -DTASK0_STATS=ON) the macro is empty and arguments are not evaluated, so production
+ * builds pay nothing. Counters are thread-local (no shared cache lines on hot paths) and
+ * are merged on read: stats_read() sums live threads and threads that have finished.
+ */
+
+enum class Stat_counter{
+    ALLOCATIONS,        // buffers allocated by storage conversions, snapshots (CSR, BSR) and compaction
+    BYTES_MOVED,        // bytes of values copied or shifted by them
+    GCD_CALLS,          // gcd of Rational_number numerator and denominator
+    CANONICALIZATIONS,  // Rational_number::make_canonical
+    HASH_PROBES,        // hash computations of matrix coordinates (lookups and insertions)
+    FAKE_INSERTS,       // zero values created by operator() of Matrix and Vector
+    FAKE_REMOVALS,      // values removed by _clear_fake_vals
+    COUNT
+};
+
+constexpr size_t stat_counters_number = static_cast<size_t>(Stat_counter::COUNT);
+
+using Stats_snapshot = std::array<uint64_t, stat_counters_number>;
+
+#ifdef TASK0_STATS
+constexpr bool stats_enabled = true;
+#define TASK0_STAT(counter, n) stat_add(Stat_counter::counter, (n))
+#else
+constexpr bool stats_enabled = false;
+#define TASK0_STAT(counter, n) ((void) 0)
+#endif
+
+inline const char* stat_name(Stat_counter counter){
+    static const char* names[stat_counters_number] = {
+        "allocations", "bytes_moved", "gcd_calls", "canonicalizations",
+        "hash_probes", "fake_inserts", "fake_removals"
+    };
+    return names[static_cast<size_t>(counter)];
+}
+
+// Registry
+//////////////////////////////////
+
+// counters of one thread: written by owner only, read by stats_read()
+struct _Thread_stats{
+    std::array<std::atomic<uint64_t>, stat_counters_number> counters{};
+
+    _Thread_stats();
+    ~_Thread_stats();
+};
+
+/**
+ * @brief Live thread counters, sum of finished threads and baseline of stats_reset().
+ *
+ * Never destroyed: threads of Thread_pool finish during static destruction.
+ */
+class Stats_registry{
+private:
+    std::mutex mutex;
+    std::vector<const _Thread_stats*> live;
+    Stats_snapshot retired{};
+    Stats_snapshot baseline{};
+
+    Stats_registry() = default;
+
+    Stats_snapshot _total(){
+        Stats_snapshot res = retired;
+        for (const _Thread_stats* stats : live){
+            for (size_t c = 0; c < stat_counters_number; c++){
+                res[c] += stats->counters[c].load(std::memory_order_relaxed);
+            }
+        }
+        return res;
+    }
+public:
+    static Stats_registry& instance(){
+        static Stats_registry* registry = new Stats_registry;
+        return *registry;
+    }
+
+    void attach(const _Thread_stats* stats){
+        std::lock_guard<std::mutex> lock(mutex);
+        live.push_back(stats);
+    }
+
+    void detach(const _Thread_stats* stats){
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t c = 0; c < stat_counters_number; c++){
+            retired[c] += stats->counters[c].load(std::memory_order_relaxed);
+        }
+        live.erase(std::find(live.begin(), live.end(), stats));
+    }
+
+    Stats_snapshot read(){
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats_snapshot res = _total();
+        for (size_t c = 0; c < stat_counters_number; c++){
+            res[c] -= baseline[c];
+        }
+        return res;
+    }
+
+    // counters are not written by other threads: reset only moves baseline
+    void reset(){
+        std::lock_guard<std::mutex> lock(mutex);
+        baseline = _total();
+    }
+};
+
+inline _Thread_stats::_Thread_stats(){
+    Stats_registry::instance().attach(this);
+}
+
+inline _Thread_stats::~_Thread_stats(){
+    Stats_registry::instance().detach(this);
+}
+
+inline thread_local _Thread_stats _thread_stats;
+
+//////////////////////////////////
+
+// API
+//////////////////////////////////
+
+// single writer: plain load and store, no locked instruction
+inline void stat_add(Stat_counter counter, uint64_t n = 1){
+    std::atomic<uint64_t>& cell = _thread_stats.counters[static_cast<size_t>(counter)];
+    cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// counters of all threads since start or last stats_reset()
+inline Stats_snapshot stats_read(){
+    return Stats_registry::instance().read();
+}
+
+inline uint64_t stats_read(Stat_counter counter){
+    return stats_read()[static_cast<size_t>(counter)];
+}
+
+inline void stats_reset(){
+    Stats_registry::instance().reset();
+}
+
+// "name value" line per counter
+inline void stats_dump(std::ostream& os){
+    if (!stats_enabled){
+        os << "# library counters are disabled, build with -DTASK0_STATS=ON\n";
+    }
+    Stats_snapshot snapshot = stats_read();
+    for (size_t c = 0; c < stat_counters_number; c++){
+        os << stat_name(static_cast<Stat_counter>(c)) << ' ' << snapshot[c] << '\n';
+    }
+}
+
+//////////////////////////////////
+
+#endif // __Task0Stats_H__
@@ -4,6 +4,8 @@
  */
 
 #include "../../complex/ClassComplex.h"
+#include "../../complex/Complex_array.hpp"
+#include "../../complex/Numeric_traits.hpp"
 #include "../../exceptions/ComplNumbersExceptions.hpp"
 #include "../../exceptions/CommonExceptions.hpp"
 #include "gtest/gtest.h"
@@ -57,4 +59,100 @@ TEST(ComplNumberMethodsTest, Assignment){
 TEST(ComplNumberMethodsTest, Others){
     Complex_number<Rational_number> c(Rational_number(5, 3));
     EXPECT_EQ(c.module_square(), Rational_number(5, 3) * Rational_number(5, 3));
-}
\ No newline at end of file
+}
+
+TEST(ComplNumberMethodsTest, Constexpr){
+    constexpr Complex_number<> a(3, 4), b(1, -2);
+    static_assert(a.module_square() == 25);
+    static_assert(a + b == Complex_number<>(4, 2));
+    static_assert(a * b == Complex_number<>(11, -2));
+    static_assert(a * b / b == a);
+    static_assert(b < a);
+    constexpr Complex_number<float, float> f(3, 4), g(1, -2);
+    static_assert(f * g == Complex_number<float, float>(11, -2));
+    static_assert(f * g / g == f);
+    constexpr Complex_number<int> c = Complex_number<int>(Complex_number<>(2, 5)) - Complex_number<int>(1, 1);
+    static_assert(c.get_real() == 1 && c.get_imag() == 4);
+    static_assert(std::is_trivially_copyable<Complex_number<>>::value);
+    EXPECT_EQ(-a, Complex_number<>(-3, -4));
+}
+
+TEST(ComplNumberMethodsTest, SmithDivision){
+    // |rhs|^2 overflows double, division by parts doesn't
+    Complex_number<> big(1e300, 1e300), res = big / big;
+    EXPECT_DOUBLE_EQ(res.get_real(), 1.0);
+    EXPECT_DOUBLE_EQ(res.get_imag(), 0.0);
+    res = Complex_number<>(1e-300, 2e-300) / Complex_number<>(0, 1e-300);
+    EXPECT_DOUBLE_EQ(res.get_real(), 2.0);
+    EXPECT_DOUBLE_EQ(res.get_imag(), -1.0);
+    res = Complex_number<>(7, -3) / Complex_number<>(2, 5);
+    EXPECT_NEAR(res.get_real(), -1.0 / 29, 1e-15);
+    EXPECT_NEAR(res.get_imag(), -41.0 / 29, 1e-15);
+    EXPECT_THROW(big / Complex_number<>(), Zero_division);
+}
+
+TEST(ComplNumberMethodsTest, NumericTraits){
+    static_assert(Numeric_traits<int>::exact && !Numeric_traits<double>::exact);
+    static_assert(Numeric_traits<Rational_number>::exact);
+    static_assert(!Numeric_traits<Complex_number<>>::exact && Numeric_traits<Complex_number<int>>::exact);
+    static_assert(Numeric_traits<double>::is_zero(-0.005, 0.01) && !Numeric_traits<double>::is_zero(0.02, 0.01));
+
+    // exact types: only exact zero, eps is ignored
+    EXPECT_FALSE(Numeric_traits<Rational_number>::is_zero(Rational_number(1, 1000), 0.01));
+    EXPECT_TRUE(Numeric_traits<Rational_number>::is_zero(Rational_number((long) 0), 0.01));
+    EXPECT_TRUE(Numeric_traits<Complex_number<>>::is_zero(Complex_number<>(0.006, -0.007), 0.01));
+    EXPECT_FALSE(Numeric_traits<Complex_number<>>::is_zero(Complex_number<>(0.008, -0.008), 0.01));
+
+    EXPECT_EQ(Numeric_traits<Complex_number<>>::one(), Complex_number<>(1, 0));
+    EXPECT_EQ(Numeric_traits<Rational_number>::zero(), Rational_number((long) 0));
+    EXPECT_DOUBLE_EQ(Numeric_traits<int>::magnitude(-3), 3.0);
+    EXPECT_DOUBLE_EQ(Numeric_traits<Rational_number>::magnitude(Rational_number(-3, 4)), 0.75);
+    // numerator and denominator out of range of double
+    std::string huge = "1" + std::string(400, '0');
+    EXPECT_DOUBLE_EQ(Numeric_traits<Rational_number>::magnitude(Rational_number(("-2" + huge.substr(1, 399) + "1").c_str(), huge.c_str())), 2.0);
+    EXPECT_DOUBLE_EQ(Numeric_traits<Rational_number>::magnitude(Rational_number(huge.c_str(), ("3" + huge.substr(1)).c_str())), 1.0 / 3);
+    EXPECT_TRUE(std::isinf(Numeric_traits<Rational_number>::magnitude(Rational_number(huge.c_str()))));
+    EXPECT_DOUBLE_EQ(Numeric_traits<Complex_number<>>::magnitude(Complex_number<>(3, -4)), 5.0);
+    EXPECT_DOUBLE_EQ(Numeric_traits<Complex_number<Rational_number>>::magnitude(
+                     Complex_number<Rational_number>(Rational_number((long) 3), Rational_number((long) 4))), 5.0);
+}
+
+TEST(ComplNumberMethodsTest, ComplexArray){
+    // size is not multiple of SIMD width, so vector loops and scalar tail are both used
+    size_t n = 37;
+    std::vector<Complex_number<>> a_vals, b_vals;
+    for (size_t k = 0; k < n; k++){
+        a_vals.emplace_back(0.5 * k - 3, 1.0 / (k + 1));
+        b_vals.emplace_back(2.0 - k * 0.25, 0.1 * k);
+    }
+    Complex_array<> a(a_vals), b(b_vals), c(std::vector<Complex_number<>>(n, Complex_number<>(1, -1)));
+    ASSERT_EQ(a.size(), n);
+    EXPECT_EQ(a[5], a_vals[5]);
+    EXPECT_EQ(a.to_vector(), a_vals);
+
+    Complex_array<> sum = a + b, prod = a * b;
+    fma(a, b, c);
+    std::vector<double> squares = module_square(a);
+    Complex_number<> expected_dot;
+    for (size_t k = 0; k < n; k++){
+        Complex_number<> p = a_vals[k] * b_vals[k];
+        EXPECT_EQ(sum[k], a_vals[k] + b_vals[k]);
+        EXPECT_NEAR(prod[k].get_real(), p.get_real(), 1e-12);
+        EXPECT_NEAR(prod[k].get_imag(), p.get_imag(), 1e-12);
+        EXPECT_NEAR(c[k].get_real(), 1 + p.get_real(), 1e-12);
+        EXPECT_NEAR(c[k].get_imag(), -1 + p.get_imag(), 1e-12);
+        EXPECT_NEAR(squares[k], a_vals[k].module_square(), 1e-12);
+        expected_dot += Complex_number<>(a_vals[k].get_real(), -a_vals[k].get_imag()) * b_vals[k];
+    }
+    Complex_number<> res = dot(a, b);
+    EXPECT_NEAR(res.get_real(), expected_dot.get_real(), 1e-10);
+    EXPECT_NEAR(res.get_imag(), expected_dot.get_imag(), 1e-10);
+
+    // generic kernels
+    Complex_array<int> x(std::vector<Complex_number<int>>{{1, 2}, {3, -1}}), y(std::vector<Complex_number<int>>{{2, 0}, {1, 1}});
+    EXPECT_EQ((x * y)[1], Complex_number<int>(4, 2));
+    EXPECT_EQ(dot(x, y), Complex_number<int>(2, -4) + Complex_number<int>(2, 4));
+
+    EXPECT_THROW(a + Complex_array<>(n + 1), Shape_error);
+    EXPECT_THROW(fma(a, b, sum = Complex_array<>(3)), Shape_error);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file DecompositionsTest.cpp
+ * @brief Tests for exact elimination: Bareiss and sparse LU
+ */
+
+#include "../../decompositions/Bareiss.hpp"
+#include "../../decompositions/Sparse_LU.hpp"
+#include "../../exceptions/MatrixExceptions.hpp"
+#include "../../exceptions/CommonExceptions.hpp"
+#include "gtest/gtest.h"
+
+Matrix<Rational_number> make_hilbert_matrix(int n){
+    Matrix<Rational_number> matr(n, n);
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            matr(i, j) = Rational_number(1, i + j + 1);
+        }
+    }
+    return matr;
+}
+
+// first row, first column and diagonal are filled
+Matrix<Rational_number> make_arrow_matrix(int n){
+    Matrix<Rational_number> matr(n, n);
+    for (int i = 0; i < n; i++){
+        matr(i, i) = Rational_number(n + i, 2);
+        if (i > 0){
+            matr(0, i) = Rational_number(1, i + 1);
+            matr(i, 0) = Rational_number(-1, i + 2);
+        }
+    }
+    return matr;
+}
+
+TEST(DecompositionsTest, BareissTest){
+    Matrix<Rational_number> hilbert = make_hilbert_matrix(5);
+    EXPECT_EQ(bareiss_determinant(hilbert).to_string(), "<1/266716800000>");
+    EXPECT_EQ(bareiss_rank(hilbert), 5);
+
+    Matrix<Rational_number> singular(3, 3, {{{0, 0}, Rational_number(1, 2)}, {{0, 1}, Rational_number(2)},
+                                            {{1, 1}, Rational_number(3, 7)}, {{1, 2}, Rational_number(1)},
+                                            {{2, 0}, Rational_number(1, 2)}, {{2, 1}, Rational_number(17, 7)},
+                                            {{2, 2}, Rational_number(1)}});
+    EXPECT_EQ(bareiss_rank(singular), 2);
+    EXPECT_EQ(bareiss_determinant(singular).to_string(), "<0/1>");
+
+    // permutation matrix with odd number of swaps
+    Matrix<Rational_number> perm(3, 3, {{{0, 1}, Rational_number(1)}, {{1, 0}, Rational_number(1)},
+                                        {{2, 2}, Rational_number(1)}});
+    EXPECT_EQ(bareiss_determinant(perm).to_string(), "<-1/1>");
+
+    Matrix<Rational_number> matr(3, 3, {{{0, 0}, Rational_number(2)}, {{0, 2}, Rational_number(1, 3)},
+                                        {{1, 1}, Rational_number(-3, 2)}, {{2, 0}, Rational_number(5)},
+                                        {{2, 1}, Rational_number(1)}});
+    Vector<Rational_number> b(3, {{0, Rational_number(7, 3)}, {1, Rational_number(-3)}, {2, Rational_number(7)}});
+    Vector<Rational_number> x = bareiss_solve(matr, b);
+    EXPECT_EQ(x.to_dense()[0].to_string(), "<1/1>");
+    EXPECT_EQ(x.to_dense()[1].to_string(), "<2/1>");
+    EXPECT_EQ(x.to_dense()[2].to_string(), "<1/1>");
+
+    EXPECT_THROW(bareiss_solve(singular, b), Singular_matrix);
+    EXPECT_THROW(bareiss_determinant(Matrix<Rational_number>(2, 3)), Shape_error);
+}
+
+TEST(DecompositionsTest, SparseLUTest){
+    Matrix<Rational_number> hilbert = make_hilbert_matrix(4);
+    Sparse_LU<Rational_number> lu_hilbert(hilbert);
+    EXPECT_EQ(lu_hilbert.get_rank(), 4);
+    EXPECT_EQ(lu_hilbert.determinant(), bareiss_determinant(hilbert));
+    EXPECT_EQ(lu_hilbert.determinant().to_string(), "<1/6048000>");
+
+    Matrix<Rational_number> arrow = make_arrow_matrix(15);
+    Sparse_LU<Rational_number> lu(arrow);
+    EXPECT_EQ(lu.get_rank(), 15);
+    EXPECT_EQ(lu.get_fill_in(), 0);     // hub row and column are eliminated last
+    EXPECT_EQ(lu.determinant(), bareiss_determinant(arrow));
+
+    std::vector<Rational_number> solution(15), rhs(15);
+    for (int i = 0; i < 15; i++){
+        solution[i] = Rational_number(i + 1, 3);
+    }
+    Matrix_csr<Rational_number>(arrow).multiply(solution.data(), rhs.data());
+    std::vector<Rational_number> x = lu.solve(Vector<Rational_number>(rhs)).to_dense();
+    for (int i = 0; i < 15; i++){
+        EXPECT_EQ(x[i], solution[i]);
+    }
+
+    Matrix<Rational_number> singular(3, 3, {{{0, 0}, Rational_number(1)}, {{1, 0}, Rational_number(2)},
+                                            {{2, 2}, Rational_number(1)}});
+    Sparse_LU<Rational_number> lu_singular(singular);
+    EXPECT_EQ(lu_singular.get_rank(), 2);
+    EXPECT_EQ(lu_singular.determinant().to_string(), "<0/1>");
+    EXPECT_THROW(lu_singular.solve(Vector<Rational_number>(3)), Singular_matrix);
+    EXPECT_EQ(Sparse_LU<Rational_number>(Matrix<Rational_number>(2, 5, {{{1, 4}, Rational_number(3)}})).get_rank(), 1);
+}
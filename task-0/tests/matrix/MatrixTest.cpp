@@ -4,10 +4,18 @@
  */
 
 #include "../../matrix/ClassMatrix.h"
+#include "../../matrix/Matrix_power.hpp"
+#include "../../matrix/Matrix_reordering.hpp"
+#include "../../matrix/Matrix_structured.hpp"
+#include "../../matrix/Matrix_bsr.hpp"
+#include "../../matrix/Matrix_assembly.hpp"
+#include "../../matrix/Matrix_builder.hpp"
+#include "../../parsers/Matrix_market.hpp"
 #include "../../exceptions/MatrixExceptions.hpp"
 #include "../../exceptions/CommonExceptions.hpp"
 #include "../../exceptions/ParserExceptions.hpp"
 #include <filesystem>
+#include <random>
 #include "gtest/gtest.h"
 
 #ifndef __proj_path__
@@ -52,6 +60,24 @@ TEST(MatrixTest, ConstrTest){
     EXPECT_THROW(Matrix<Complex_number<>>(std::string(matrix_test_path / "matrix_bad.txt").c_str()), Parser_error);
 }
 
+TEST(MatrixTest, AccessTest){
+    Matrix<int> m(2, 3, {{{0, 1}, 4}, {{1, 2}, -1}});
+    EXPECT_EQ(m.try_get(0, 1), 4);
+    EXPECT_EQ(m.try_get(1, 1), 0);          // missing value is not inserted
+    EXPECT_EQ(m.get_values().size(), 2u);
+    EXPECT_EQ(m.try_get(2, 0), std::nullopt);
+    EXPECT_EQ(m.try_get(0, -1), std::nullopt);
+
+    m.at(1, 0) = 7;
+    EXPECT_EQ(m.try_get(1, 0), 7);
+    EXPECT_THROW(m.at(0, 3), Out_of_range);
+    EXPECT_THROW(m.at(-1, 0), Out_of_range);
+#if TASK0_BOUNDS_CHECK
+    EXPECT_THROW(m(2, 0), Out_of_range);
+    EXPECT_THROW(m({0, 3}), Out_of_range);
+#endif
+}
+
 TEST(MatrixTest, OperatorsTest){
     Matrix<int> matr1(10, 15, {{{1, 2}, 2}, {{3, 10}, 5}});
     Matrix<int> matr2(10, 15, {{{1, 2}, 7}, {{5, 3}, -3}});
@@ -77,9 +103,478 @@ TEST(MatrixTest, OperatorsTest){
     EXPECT_THROW((matr6 * matr1), Shape_error);
 }
 
+TEST(MatrixTest, ExpressionTest){
+    Matrix<int> a(3, 3, {{{0, 0}, 1}, {{0, 2}, 2}, {{1, 1}, 3}, {{2, 0}, 4}});
+    Matrix<int> b(3, 3, {{{0, 0}, 5}, {{1, 2}, 6}, {{2, 1}, 7}});
+    Matrix<int> c(3, 3, {{{0, 0}, -5}, {{0, 1}, 1}, {{2, 2}, 2}});
+
+    Matrix<int> sum(a + b - c);
+    EXPECT_EQ(sum.get_size(), 8);
+    EXPECT_EQ(sum(0, 0), 11);
+    EXPECT_EQ(sum(0, 1), -1);
+    EXPECT_EQ(sum(2, 2), -2);
+
+    // a * b + c is evaluated by fused kernel
+    Matrix<int> gemm(a * b + c);
+    EXPECT_EQ(gemm(0, 0), 0);       // 1 * 5 - 5 is filtered out
+    EXPECT_EQ(gemm(0, 1), 15);
+    EXPECT_EQ(gemm(1, 2), 18);
+    EXPECT_EQ(gemm(2, 0), 20);
+    EXPECT_EQ(gemm(2, 2), 2);
+    EXPECT_EQ(gemm.get_size(), 4);
+
+    Matrix<int> nested((a + b) * c * 2 - (-(a - b)));
+    EXPECT_EQ(nested(0, 0), -64);   // 2 * (6 * -5) + (1 - 5)
+    EXPECT_EQ(nested(0, 1), 12);    // 2 * 6 * 1
+    EXPECT_EQ(nested(2, 0), -36);   // 2 * (4 * -5) + 4
+
+    // operands may alias result
+    a = a + a * b;
+    EXPECT_EQ(a(0, 0), 6);
+    EXPECT_EQ(a(0, 1), 14);
+
+    Matrix<Rational_number> r1(2, 2, {{{0, 0}, Rational_number(1, 2)}, {{1, 1}, Rational_number(1, 3)}});
+    Matrix<Rational_number> r2(2, 2, {{{0, 0}, Rational_number(1, 2)}, {{1, 0}, Rational_number(3)}});
+    Matrix<Rational_number> r3(r1 * r2 - r2 * Rational_number(1, 2));
+    EXPECT_EQ(r3.get_size(), 1);
+    EXPECT_EQ(r3(1, 0).to_string(), "<-1/2>");
+
+    EXPECT_THROW(a + Matrix<int>(3, 4), Shape_error);
+    EXPECT_THROW((a + b) * Matrix<int>(2, 3), Shape_error);
+    EXPECT_THROW(a = a * Matrix<int>(3, 4), Shape_error);
+}
+
+TEST(MatrixTest, PowerTest){
+    // path counting: directed cycle 0 -> 1 -> 2 -> 3 -> 0 with chord 0 -> 2
+    Matrix<int> graph(4, 4, {{{0, 1}, 1}, {{1, 2}, 1}, {{2, 3}, 1}, {{3, 0}, 1}, {{0, 2}, 1}});
+    Matrix<int> expected(4, 4, true);
+    for (unsigned long long k = 0; k <= 9; k++){
+        Power_params sparse_only;
+        sparse_only.track_fill = false;
+        Matrix<int> sparse_pow = pow(graph, k, sparse_only);
+        Matrix<int> auto_pow = pow(graph, k);
+        for (int i = 0; i < 4; i++){
+            for (int j = 0; j < 4; j++){
+                EXPECT_EQ(sparse_pow(i, j), expected(i, j));
+                EXPECT_EQ(auto_pow(i, j), expected(i, j));
+            }
+        }
+        expected = expected * graph;
+    }
+
+    // powers of irreducible stochastic matrix become dense
+    Matrix<double> chain(3, 3, {{{0, 1}, 1.0}, {{1, 0}, 0.5}, {{1, 2}, 0.5}, {{2, 0}, 1.0}});
+    Matrix_power<double> chain_pow(chain);
+    Matrix<double> stationary = chain_pow.pow(200);
+    EXPECT_TRUE(chain_pow.used_dense());
+    EXPECT_NEAR(stationary(1, 0), 0.4, 1e-9);
+    EXPECT_NEAR(stationary(2, 1), 0.4, 1e-9);
+    EXPECT_NEAR(stationary(0, 2), 0.2, 1e-9);
+    Matrix<double> chain_5 = chain_pow.pow(5);     // buffers are reused
+    EXPECT_NEAR(chain_5(0, 0), 0.5, 1e-12);
+
+    EXPECT_THROW(pow(Matrix<int>(2, 3), 2), Shape_error);
+}
+
 //TEST(MatrixTest, SliceTest){
 //
 //}
 
 //TEST(MatrixTest, MethodsTest){
-//}
\ No newline at end of file
+//}
+
+TEST(MatrixTest, EpsTest){
+    matr_vals<double> vals{{{0, 0}, 1.0}, {{0, 1}, 0.005}, {{1, 1}, 1e-9}, {{1, 0}, 0.2}};
+    Matrix<double> a(2, 2, vals);
+    EXPECT_EQ(a.get_eps(), Matrix<double>::default_eps);
+    EXPECT_EQ(a.get_size(), 2);
+    // exact zeros only, then aggressive filter for same values
+    Matrix<double> exact(2, 2, vals, 0);
+    EXPECT_EQ(exact.get_size(), 4);
+    exact(0, 0) = 0.0;
+    EXPECT_EQ(exact.get_size(), 3);     // fake zero is removed with eps = 0
+    exact.set_eps(0.5);
+    EXPECT_EQ(exact.get_size(), 0);
+
+    // eps is property of instance: copied with values, kept by power
+    Matrix<double> b(2, 2, vals, 1e-12);
+    Matrix<double> c(b);
+    EXPECT_EQ(c.get_eps(), 1e-12);
+    EXPECT_EQ(c.get_size(), 4);
+    EXPECT_EQ(pow(c, 3).get_eps(), 1e-12);
+    EXPECT_EQ(pow(c, 0).get_eps(), 1e-12);
+    EXPECT_EQ(Matrix<double>(c[Matrix_row_coord(1)]).get_eps(), 1e-12);
+    EXPECT_EQ(a.get_eps(), Matrix<double>::default_eps);
+
+    // results of expressions take smallest eps of operands
+    Matrix<double> small_a(2, 2, {{{0, 0}, 0.001}, {{1, 1}, 1.0}}, 0), small_b(small_a);
+    Matrix<double> sum = small_a + small_b;
+    EXPECT_EQ(sum.get_eps(), 0);
+    EXPECT_EQ(sum.get_values(), (matr_vals<double>{{{0, 0}, 0.002}, {{1, 1}, 2.0}}));
+    Matrix<double> product = small_a * small_b;
+    EXPECT_EQ(product.get_values(), (matr_vals<double>{{{0, 0}, 0.001 * 0.001}, {{1, 1}, 1.0}}));
+    Matrix<double> nested = (small_a * small_b) * small_b * 2.0 - small_a;
+    EXPECT_EQ(nested.get_size(), 2);
+    sum = small_a * a;
+    EXPECT_EQ(sum.get_eps(), 0);
+    EXPECT_EQ((a + small_a).get_eps(), 0);
+}
+
+TEST(MatrixTest, SparsifyTest){
+    matr_vals<double> vals;
+    for (int j = 0; j < 6; j++){
+        vals[{0, j}] = j + 1.0;         // 1 2 3 4 5 6
+        vals[{1, j}] = (j % 2) ? 1.0 : -1.0;
+    }
+    vals[{2, 3}] = 10.0;
+    vals[{2, 4}] = 0.5;
+    Matrix<double> a(3, 6, vals, 0);
+
+    Matrix<double> top(a);
+    EXPECT_EQ(top(2, 0), 0.0);          // fake zeros made by reading are not counted as removed
+    EXPECT_EQ(top(0, 0), 1.0);
+    EXPECT_EQ(top.keep_top_k(2), 4 + 4 + 0);
+    EXPECT_EQ(top.get_size(), 6);
+    EXPECT_EQ(top(0, 5), 6.0);
+    EXPECT_EQ(top(0, 4), 5.0);
+    EXPECT_EQ(top(1, 0), -1.0);       // equal magnitudes: smaller columns are kept
+    EXPECT_EQ(top(1, 1), 1.0);
+    EXPECT_EQ(top(2, 4), 0.5);
+    EXPECT_THROW(top.keep_top_k(-1), Init_error);
+
+    Matrix<double> rel(a);
+    EXPECT_EQ(rel(2, 5), 0.0);
+    // ||row 0|| = sqrt(91) ~ 9.54, ||row 2|| ~ 10.01
+    EXPECT_EQ(rel.drop_relative(0.3), 2 + 0 + 1);
+    EXPECT_EQ(rel.get_size(), 11);
+    EXPECT_EQ(rel(0, 2), 3.0);
+    EXPECT_EQ(rel(2, 3), 10.0);
+    EXPECT_EQ(rel.drop_relative(0.0), 0);
+}
+
+std::filesystem::path write_mtx(const std::string& name, const std::string& text){
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream(path) << text;
+    return path;
+}
+
+TEST(MatrixTest, MatrixMarketTest){
+    // symmetric expansion, comments, exact decimals for rationals
+    std::filesystem::path sym = write_mtx("task0_sym.mtx",
+        "%%MatrixMarket matrix coordinate real symmetric\n% comment\n\n3 3 4\n"
+        "1 1 2.5\n2 1 -1.25\n3 2 4e-1\n3 3 7\n");
+    Matrix<double> a = read_matrix_market<double>(sym.c_str());
+    EXPECT_EQ(a.get_size(), 6);
+    EXPECT_EQ(a(0, 1), -1.25);
+    EXPECT_EQ(a(1, 0), -1.25);
+    EXPECT_EQ(a(1, 2), 0.4);
+    Matrix<Rational_number> r = read_matrix_market<Rational_number>(sym.c_str());
+    EXPECT_EQ(r(2, 1).to_string(), "<2/5>");
+    EXPECT_EQ(r(0, 1).to_string(), "<-5/4>");
+
+    // parallel parsing of many small parts gives the same matrix
+    Parallel_policy policy;
+    policy.threads = 4;
+    policy.chunk = 8;
+    policy.min_size = 0;
+    Matrix<double> b = read_matrix_market<double>(sym.c_str(), Matrix<double>::default_eps, policy);
+    EXPECT_EQ(b.get_values(), a.get_values());
+
+    std::filesystem::path herm = write_mtx("task0_herm.mtx",
+        "%%MatrixMarket matrix coordinate complex hermitian\n2 2 2\n1 1 1 0\n2 1 3 -2\n");
+    Matrix<Complex_number<>> c = read_matrix_market<Complex_number<>>(herm.c_str());
+    EXPECT_EQ(c(1, 0), Complex_number<>(3, -2));
+    EXPECT_EQ(c(0, 1), Complex_number<>(3, 2));
+    EXPECT_THROW(read_matrix_market<double>(herm.c_str()), Type_error);
+
+    std::filesystem::path pattern = write_mtx("task0_pattern.mtx",
+        "%%MatrixMarket matrix coordinate pattern skew-symmetric\n3 3 1\n3 1\n");
+    Matrix<int> p = read_matrix_market<int>(pattern.c_str());
+    EXPECT_EQ(p(2, 0), 1);
+    EXPECT_EQ(p(0, 2), -1);
+
+    EXPECT_THROW(read_matrix_market<double>(write_mtx("task0_bad.mtx",
+        "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n").c_str()), Parser_error);
+    EXPECT_THROW(read_matrix_market<double>(write_mtx("task0_bad.mtx",
+        "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n").c_str()), Out_of_range);
+    EXPECT_THROW(read_matrix_market<double>(write_mtx("task0_bad.mtx",
+        "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n4\n").c_str()), Parser_error);
+
+    // round trips
+    std::filesystem::path out = std::filesystem::temp_directory_path() / "task0_out.mtx";
+    write_matrix_market(a, out.c_str(), Mtx_symmetry::SYMMETRIC);
+    EXPECT_EQ(read_matrix_market_header(out.c_str()).entries, 4);
+    EXPECT_EQ(read_matrix_market<double>(out.c_str()).get_values(), a.get_values());
+    write_matrix_market(c, out.c_str());
+    EXPECT_EQ(read_matrix_market<Complex_number<>>(out.c_str()).get_values(), c.get_values());
+    Matrix<Rational_number> ints(2, 3, {{{0, 2}, Rational_number(-12)}, {{1, 0}, Rational_number(5)}});
+    write_matrix_market(ints, out.c_str());
+    EXPECT_EQ(read_matrix_market_header(out.c_str()).field, Mtx_field::INTEGER);
+    EXPECT_EQ(read_matrix_market<Rational_number>(out.c_str())(0, 2), Rational_number(-12));
+    EXPECT_THROW(write_matrix_market(p, out.c_str(), Mtx_symmetry::SYMMETRIC), Type_error);
+    // mirrored values are compared up to eps of matrix, as in Matrix_symmetric
+    Matrix<double> rounded(2, 2, {{{0, 0}, 1.0}, {{0, 1}, 0.3}, {{1, 0}, 0.1 + 0.2}}, 1e-12);
+    write_matrix_market(rounded, out.c_str(), Mtx_symmetry::SYMMETRIC);
+    EXPECT_EQ(read_matrix_market_header(out.c_str()).entries, 2);
+    rounded.set_eps(0);
+    EXPECT_THROW(write_matrix_market(rounded, out.c_str(), Mtx_symmetry::SYMMETRIC), Type_error);
+
+    for (const char* name : {"task0_sym.mtx", "task0_herm.mtx", "task0_pattern.mtx", "task0_bad.mtx", "task0_out.mtx"}){
+        std::filesystem::remove(std::filesystem::temp_directory_path() / name);
+    }
+}
+
+TEST(MatrixTest, ReorderingTest){
+    // tridiagonal matrix with scrambled numbering: RCM restores bandwidth 1
+    const int n = 60;
+    Permutation scramble(n);
+    for (int k = 0; k < n; k++) scramble[k] = k;
+    std::shuffle(scramble.begin(), scramble.end(), std::mt19937(7));
+    matr_vals<double> vals;
+    for (int k = 0; k < n; k++){
+        vals[{scramble[k], scramble[k]}] = 4.0;
+        if (k + 1 < n){
+            vals[{scramble[k], scramble[k + 1]}] = -1.0;
+            vals[{scramble[k + 1], scramble[k]}] = -2.0;
+        }
+    }
+    Matrix<double> a(n, n, vals);
+    EXPECT_GT(bandwidth(a), 1);
+    Permutation P = rcm_ordering(a);
+    Matrix<double> b = permute(a, P);
+    EXPECT_EQ(bandwidth(b), 1);
+    EXPECT_EQ(b.get_size(), a.get_size());
+    EXPECT_EQ(b.get_eps(), a.get_eps());
+    for (int i = 0; i < n; i++){
+        EXPECT_EQ(b(i, i), 4.0);
+    }
+
+    // B(i, j) = A(P[i], Q[j]), inverse permutation undoes it
+    Matrix<int> c(2, 3, {{{0, 0}, 1}, {{0, 2}, 2}, {{1, 1}, 3}});
+    Matrix<int> d = permute(c, {1, 0}, {2, 0, 1});
+    EXPECT_EQ(d(1, 0), 2);
+    EXPECT_EQ(d(1, 1), 1);
+    EXPECT_EQ(d(0, 2), 3);
+    EXPECT_EQ(permute(d, inverse_permutation({1, 0}), inverse_permutation({2, 0, 1})).get_values(), c.get_values());
+
+    Vector<int> x(std::vector<int>{5, 0, 7});
+    Vector<int> y = permute(x, {2, 0, 1});
+    EXPECT_EQ(y.to_dense(), std::vector<int>({7, 5, 0}));
+    EXPECT_EQ(y.get_storage(), x.get_storage());
+
+    // two components and isolated vertex are all numbered
+    Matrix<int> e(5, 5, {{{0, 3}, 1}, {{3, 0}, 1}, {{1, 4}, 1}});
+    Permutation Q = rcm_ordering(e);
+    std::sort(Q.begin(), Q.end());
+    EXPECT_EQ(Q, Permutation({0, 1, 2, 3, 4}));
+
+    EXPECT_THROW(rcm_ordering(c), Shape_error);
+    EXPECT_THROW(permute(c, {0, 1, 2}, {0, 1, 2}), Shape_error);
+    EXPECT_THROW(permute(c, {0, 0}, {0, 1, 2}), Init_error);
+}
+
+TEST(MatrixTest, StructuredTest){
+    // symmetric matrix from both triangles keeps lower one, products are the same as of full one
+    Matrix<double> full(4, 4, {{{0, 0}, 2}, {{0, 2}, -1}, {{2, 0}, -1}, {{1, 1}, 3}, {{3, 1}, 0.5},
+                               {{1, 3}, 0.5}, {{3, 3}, 1}, {{2, 3}, 4}, {{3, 2}, 4}});
+    Matrix_symmetric<double> sym(full);
+    EXPECT_EQ(sym.get_nnz(), 6);
+    EXPECT_EQ(sym.get_row_ptr(), std::vector<int>({0, 1, 2, 3, 6}));
+    std::vector<double> x{1, 2, 3, 4}, y(4), expected(4);
+    sym.multiply(x.data(), y.data());
+    Matrix_csr<double>(full).multiply(x.data(), expected.data());
+    EXPECT_EQ(y, expected);
+    std::vector<double> block{1, 0, 2, 1, 3, 0, 4, 1}, block_y(8);     // x and (0 1 0 1)
+    sym.multiply_block(block.data(), block_y.data(), 2);
+    EXPECT_EQ(block_y[4], expected[2]);
+    EXPECT_EQ(block_y[3], 3.5);
+    EXPECT_EQ(sym.to_matrix().get_values(), full.get_values());
+
+    // hermitian: upper values are conjugated, transpose is conjugation
+    Matrix_symmetric<Complex_number<>> herm(2, {{{0, 0}, Complex_number<>(1)}, {{0, 1}, Complex_number<>(2, 3)}}, true);
+    EXPECT_EQ(herm.get_vals()[1], Complex_number<>(2, -3));
+    std::vector<Complex_number<>> cx{Complex_number<>(1), Complex_number<>(0, 1)}, cy(2);
+    herm.multiply(cx.data(), cy.data());
+    EXPECT_EQ(cy[0], Complex_number<>(-2, 2));      // 1 + (2 + 3i) * i
+    EXPECT_EQ(cy[1], Complex_number<>(2, -3));
+    EXPECT_EQ(herm.transpose().get_vals()[1], Complex_number<>(2, 3));
+    EXPECT_THROW(Matrix_symmetric<Complex_number<>>(1, {{{0, 0}, Complex_number<>(1, 1)}}, true), Init_error);
+    EXPECT_THROW(Matrix_symmetric<double>(2, {{{0, 1}, 1.0}, {{1, 0}, 2.0}}), Init_error);
+    // rounding errors of floating point (A * A^T) are accepted up to eps
+    EXPECT_THROW(Matrix_symmetric<double>(2, {{{0, 1}, 0.3}, {{1, 0}, 0.1 + 0.2}}), Init_error);
+    EXPECT_EQ(Matrix_symmetric<double>(2, {{{0, 1}, 0.3}, {{1, 0}, 0.1 + 0.2}}, false, 1e-12).get_nnz(), 1);
+    Matrix<double> rect(3, 2, {{{0, 0}, 0.1}, {{0, 1}, 0.7}, {{1, 0}, 1.0 / 3}, {{2, 1}, 0.3}}, 0);
+    matr_vals<double> rect_t;
+    for (const auto& elem : rect.get_values()) rect_t[{elem.first.second, elem.first.first}] = elem.second;
+    Matrix<double> gram = rect * Matrix<double>(2, 3, rect_t, 0);
+    gram.set_eps(1e-12);
+    EXPECT_EQ(Matrix_symmetric<double>(gram).to_matrix(gram.get_eps()).get_values(), gram.get_values());
+    EXPECT_THROW(Matrix_symmetric<double>(Matrix<double>(2, 3)), Shape_error);
+
+    // triangular solves: L * x = b, L^T * x = b
+    Matrix<double> lower_full(3, 3, {{{0, 0}, 2}, {{1, 0}, 1}, {{1, 1}, 4}, {{2, 0}, -1}, {{2, 2}, 0.5}});
+    Matrix_triangular<double> lower(lower_full, Triangle::LOWER);
+    std::vector<double> b{2, 9, 1}, sol = lower.solve(b);
+    EXPECT_EQ(sol, std::vector<double>({1, 2, 4}));
+    Matrix_triangular<double> upper = lower.transpose();
+    EXPECT_EQ(upper.get_triangle(), Triangle::UPPER);
+    EXPECT_EQ(upper.get_col_idx(), std::vector<int>({0, 1, 2, 1, 2}));
+    std::vector<double> ub(3);
+    upper.multiply(sol.data(), ub.data());
+    EXPECT_EQ(upper.solve(ub), sol);
+    EXPECT_EQ(upper.to_matrix().get_values(), (~lower_full).get_values());
+    Matrix_triangular<double> small_lower(2, {{{0, 0}, 1.0}, {{1, 0}, 0.004}, {{1, 1}, 1.0}}, Triangle::LOWER);
+    EXPECT_EQ(small_lower.to_matrix().get_size(), 2);
+    EXPECT_EQ(small_lower.to_matrix(0).get_size(), 3);
+
+    EXPECT_THROW(Matrix_triangular<double>(full, Triangle::LOWER), Init_error);
+    Matrix_triangular<double> singular(2, {{{0, 0}, 1.0}, {{1, 0}, 1.0}}, Triangle::LOWER);
+    EXPECT_THROW(singular.solve({1, 1}), Zero_division);
+    EXPECT_THROW(lower.solve({1, 1}), Shape_error);
+}
+
+TEST(MatrixTest, BsrTest){
+    // 10 x 7 matrix of 3 x 3 blocks: last block row and column are padded
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(-4, 4);
+    matr_vals<double> vals;
+    for (int i = 0; i < 10; i++){
+        for (int j = 0; j < 7; j++){
+            if ((i / 3 + j / 3) % 2 == 0 && dist(gen) != 0) vals[{i, j}] = dist(gen);
+        }
+    }
+    Matrix<double> a(10, 7, vals);
+    Matrix_bsr<double, 3> bsr(a);
+    EXPECT_EQ(bsr.get_block_rows_number(), 4);
+    EXPECT_EQ(bsr.get_block_columns_number(), 3);
+    EXPECT_EQ(bsr.get_row_ptr(), std::vector<int>({0, 2, 3, 5, 6}));
+    EXPECT_EQ(bsr.get_col_idx(), std::vector<int>({0, 2, 1, 0, 2, 1}));
+    EXPECT_EQ(bsr.to_matrix().get_values(), a.get_values());
+    Matrix<double> small(4, 4, {{{0, 0}, 1.0}, {{3, 2}, 0.004}}, 0);
+    EXPECT_EQ((Matrix_bsr<double, 3>(small).to_matrix(0).get_values()), small.get_values());
+
+    std::vector<double> x{1, -2, 3, 0.5, 2, -1, 4}, y(10), expected(10);
+    bsr.multiply(x.data(), y.data());
+    Matrix_csr<double>(a).multiply(x.data(), expected.data());
+    EXPECT_EQ(y, expected);
+
+    // block product equals product of matrices (integer values, exact)
+    matr_vals<double> transposed;
+    for (const auto& elem : vals) transposed[{elem.first.second, elem.first.first}] = elem.second;
+    Matrix<double> b(7, 10, transposed);
+    Matrix_bsr<double, 3> product = bsr.multiply(Matrix_bsr<double, 3>(b));
+    EXPECT_EQ(product.get_rows_number(), 10);
+    EXPECT_EQ(product.to_matrix().get_values(), Matrix<double>(a * b).get_values());
+    EXPECT_THROW(bsr.multiply(bsr), Shape_error);
+
+    // 4 x 4 blocks of double use vector kernels when available
+    Matrix<double> c(8, 8);
+    for (int i = 0; i < 8; i++){
+        for (int j = 0; j < 8; j++){
+            if (i / 4 == j / 4 || (i < 4 && j >= 4)) c(i, j) = i + 2 * j + 1;
+        }
+    }
+    Matrix_bsr<double, 4> bsr4(c);
+    EXPECT_EQ(bsr4.get_blocks_number(), 3);
+    std::vector<double> x4{1, 2, 3, 4, 5, 6, 7, 8}, y4(8), expected4(8);
+    bsr4.multiply(x4.data(), y4.data());
+    Matrix_csr<double>(c).multiply(x4.data(), expected4.data());
+    EXPECT_EQ(y4, expected4);
+    EXPECT_EQ(bsr4.multiply(bsr4).to_matrix().get_values(), Matrix<double>(c * c).get_values());
+
+    EXPECT_THROW((Matrix_bsr<double, 2>(2, 2, {{{2, 0}, 1.0}})), Init_error);
+}
+
+TEST(MatrixTest, AssemblyTest){
+    Matrix<int> a(2, 2, {{{0, 0}, 1}, {{0, 1}, 2}, {{1, 1}, -1}});
+    Matrix<int> b(2, 3, {{{0, 2}, 3}, {{1, 0}, 4}});
+    Matrix_csr<int> a_csr(a), b_csr(b);
+
+    // kron(a, b)(i * 2 + r, k * 3 + l) = a(i, k) * b(r, l)
+    Matrix_csr<int> k = kron(a_csr, b_csr);
+    EXPECT_EQ(k.get_rows_number(), 4);
+    EXPECT_EQ(k.get_columns_number(), 6);
+    EXPECT_EQ(k.get_row_ptr(), std::vector<int>({0, 2, 4, 5, 6}));
+    EXPECT_EQ(k.get_col_idx(), std::vector<int>({2, 5, 0, 3, 5, 3}));
+    EXPECT_EQ(k.get_vals(), std::vector<int>({3, 6, 4, 8, -3, -4}));
+    // small products are kept with eps of operands
+    Matrix<double> small(2, 2, {{{0, 0}, 0.05}, {{1, 1}, 1.0}}, 0);
+    Matrix_csr<double> small_csr(small);
+    Matrix<double> small_k = kron(small_csr, small_csr).to_matrix(small.get_eps());
+    EXPECT_EQ(small_k.get_size(), 4);
+    EXPECT_DOUBLE_EQ(small_k(0, 0), 0.05 * 0.05);
+    EXPECT_EQ(kron(small_csr, small_csr).to_matrix().get_size(), 3);
+
+    // Hadamard product keeps common elements only
+    Matrix_csr<int> h = hadamard(a_csr, Matrix_csr<int>(Matrix<int>(2, 2, {{{0, 1}, 5}, {{1, 0}, 7}, {{1, 1}, 2}})));
+    EXPECT_EQ(h.to_matrix().get_values(), (matr_vals<int>{{{0, 1}, 10}, {{1, 1}, -2}}));
+    EXPECT_THROW(hadamard(a_csr, b_csr), Shape_error);
+
+    Matrix_csr<int> hs = hstack<int>({a_csr, b_csr});
+    EXPECT_EQ(hs.get_columns_number(), 5);
+    EXPECT_EQ(hs.to_matrix().get_values(), (matr_vals<int>{{{0, 0}, 1}, {{0, 1}, 2}, {{1, 1}, -1}, {{0, 4}, 3}, {{1, 2}, 4}}));
+    EXPECT_EQ(hs.get_col_idx(), std::vector<int>({0, 1, 4, 1, 2}));
+
+    Matrix_csr<int> vs = vstack<int>({b_csr, b_csr});
+    EXPECT_EQ(vs.get_rows_number(), 4);
+    EXPECT_EQ(vs.get_row_ptr(), std::vector<int>({0, 1, 2, 3, 4}));
+    EXPECT_EQ(vs.get_col_idx(), std::vector<int>({2, 0, 2, 0}));
+    EXPECT_THROW(vstack<int>({a_csr, b_csr}), Shape_error);
+
+    Matrix_csr<int> bd = block_diag<int>({a_csr, b_csr});
+    EXPECT_EQ(bd.get_rows_number(), 4);
+    EXPECT_EQ(bd.get_columns_number(), 5);
+    EXPECT_EQ(bd.to_matrix().get_values(), (matr_vals<int>{{{0, 0}, 1}, {{0, 1}, 2}, {{1, 1}, -1}, {{2, 4}, 3}, {{3, 2}, 4}}));
+    EXPECT_THROW(block_diag<int>({}), Init_error);
+
+    // CSR arrays are checked
+    EXPECT_THROW(Matrix_csr<int>(2, 2, {0, 1, 2}, {1, 2}, {1, 1}), Init_error);
+    EXPECT_THROW(Matrix_csr<int>(1, 2, {0, 2}, {1, 0}, {1, 1}), Init_error);
+    EXPECT_THROW(Matrix_csr<int>(1, 2, {0, 1}, {0}, {}), Init_error);
+}
+
+TEST(MatrixTest, BuilderTest){
+    Matrix_builder<int> builder(3, 300);
+    builder.add(2, 299, 1);
+    builder.add({0, 2, 1, 0}, {5, 299, 0, 5}, {4, 2, -1, 3});
+    builder.add(1, 0, 1);       // sums to zero, not stored
+    EXPECT_EQ(builder.size(), 6u);
+
+    Matrix_csr<int> sum = builder.build_csr();
+    EXPECT_EQ(sum.get_row_ptr(), std::vector<int>({0, 1, 1, 2}));
+    EXPECT_EQ(sum.get_col_idx(), std::vector<int>({5, 299}));
+    EXPECT_EQ(sum.get_vals(), std::vector<int>({7, 3}));
+    Matrix_csr<int> last = builder.build_csr(Duplicates::OVERWRITE);
+    EXPECT_EQ(last.get_vals(), std::vector<int>({3, 1, 2}));
+    EXPECT_EQ(builder.build(Duplicates::OVERWRITE).get_values(), last.to_matrix().get_values());
+
+    EXPECT_THROW(builder.add(3, 0, 1), Init_error);
+    EXPECT_THROW(builder.add({0}, {0, 1}, {1}), Shape_error);
+
+    // many chunks and radix passes: same as hash map accumulation, last duplicate wins in order of adding
+    Parallel_policy policy;
+    policy.threads = 4;
+    policy.chunk = 1000;
+    policy.min_size = 0;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> row(0, 999), column(0, 70000), value(-3, 3);
+    Matrix_builder<double> random(1000, 70001);
+    matr_vals<double> sums, lasts;
+    for (int k = 0; k < 20000; k++){
+        int i = row(gen), j = column(gen) % 50 * 1400, v = value(gen);
+        random.add(i, j, v);
+        sums[{i, j}] += v;
+        lasts[{i, j}] = v;
+    }
+    EXPECT_EQ(random.build(Duplicates::SUM, 0, policy).get_values(), Matrix<double>(1000, 70001, sums, 0).get_values());
+    Matrix_csr<double> random_last = random.build_csr(Duplicates::OVERWRITE, policy);
+    EXPECT_EQ(random_last.to_matrix().get_values(), Matrix<double>(1000, 70001, lasts).get_values());
+    EXPECT_EQ(Matrix_builder<double>(2, 2).build_csr().get_nnz(), 0);
+
+    // CSR has no eps: small values survive with eps passed to to_matrix
+    Matrix_builder<double> small(2, 2);
+    small.add(1, 0, 0.004);
+    EXPECT_EQ(small.build_csr().get_nnz(), 1);
+    EXPECT_EQ(small.build_csr().to_matrix(0).get_values(), small.build(Duplicates::SUM, 0).get_values());
+    EXPECT_EQ(small.build_csr().to_matrix().get_size(), 0);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file ModularTest.cpp
+ * @brief Tests for modular arithmetic, CRT reconstruction and modular engine
+ */
+
+#include "../../modular/Modular_arithmetic.h"
+#include "../../modular/Modular_engine.hpp"
+#include "../../decompositions/Bareiss.hpp"
+#include "../../exceptions/MatrixExceptions.hpp"
+#include "../../exceptions/CommonExceptions.hpp"
+#include "gtest/gtest.h"
+
+Matrix<Rational_number> make_hilbert_matrix(int n){
+    Matrix<Rational_number> matr(n, n);
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            matr(i, j) = Rational_number(1, i + j + 1);
+        }
+    }
+    return matr;
+}
+
+void expect_same_matrix(Matrix<Rational_number> lhs, Matrix<Rational_number> rhs){
+    ASSERT_EQ(lhs.get_rows_number(), rhs.get_rows_number());
+    ASSERT_EQ(lhs.get_columns_number(), rhs.get_columns_number());
+    for (int i = 0; i < lhs.get_rows_number(); i++){
+        for (int j = 0; j < lhs.get_columns_number(); j++){
+            EXPECT_EQ(lhs(i, j).to_string(), rhs(i, j).to_string());
+        }
+    }
+}
+
+TEST(ModularTest, ArithmeticTest){
+    std::vector<uint32_t> primes = word_primes(3);
+    ASSERT_EQ(primes.size(), 3);
+    EXPECT_EQ(primes[0], 1073741789u);  // largest prime below 2^30
+    EXPECT_GT(primes[0], primes[1]);
+    EXPECT_GT(primes[1], primes[2]);
+
+    uint32_t p = primes[0];
+    EXPECT_EQ(mul_mod(inv_mod(12345, p), 12345, p), 1u);
+    EXPECT_THROW(inv_mod(0, p), Zero_division);
+
+    Rational_number val(-7, 3);
+    auto residues = val.residues(11);
+    EXPECT_EQ(residues.first, 4u);      // -7 mod 11
+    EXPECT_EQ(residues.second, 3u);
+}
+
+TEST(ModularTest, BigUnsignedTest){
+    Big_unsigned a(4294967295ull), b(4294967297ull);
+    EXPECT_EQ((a * b).to_string(), "18446744073709551615");
+    EXPECT_EQ((a * b + Big_unsigned(1)).to_string(), "18446744073709551616");
+    EXPECT_EQ((b - a).to_string(), "2");
+    EXPECT_TRUE(a < b);
+    EXPECT_FALSE(b < a);
+
+    Big_unsigned quot, rem;
+    Big_unsigned::divmod(a * b * b + Big_unsigned(5), b, quot, rem);
+    EXPECT_EQ(quot, a * b);
+    EXPECT_EQ(rem.to_string(), "5");
+    EXPECT_THROW(Big_unsigned::divmod(a, Big_unsigned(), quot, rem), Zero_division);
+}
+
+TEST(ModularTest, ReconstructionTest){
+    std::vector<uint32_t> primes = word_primes(2);
+    Crt_basis basis(primes);
+    Rational_number res;
+
+    for (const Rational_number& val : {Rational_number(-123456789, 1000003), Rational_number(17, 5),
+                                       Rational_number(), Rational_number(-1)}){
+        uint32_t residues[2];
+        for (int i = 0; i < 2; i++){
+            auto num_den = val.residues(primes[i]);
+            residues[i] = mul_mod(num_den.first, inv_mod(num_den.second, primes[i]), primes[i]);
+        }
+        EXPECT_TRUE(basis.reconstruct(residues, res));
+        EXPECT_EQ(res.to_string(), val.to_string());
+    }
+
+    // numerator and denominator are too large for one prime
+    Crt_basis small_basis({primes[0]});
+    Rational_number big("123456789012", "7");
+    auto num_den = big.residues(primes[0]);
+    uint32_t residue = mul_mod(num_den.first, inv_mod(num_den.second, primes[0]), primes[0]);
+    EXPECT_FALSE(small_basis.reconstruct(&residue, res) && res.to_string() == big.to_string());
+}
+
+TEST(ModularTest, MultiplyTest){
+    Matrix<Rational_number> hilbert = make_hilbert_matrix(6);
+    Matrix<Rational_number> lhs(3, 4, {{{0, 0}, Rational_number(1, 3)}, {{0, 3}, Rational_number(-2, 7)},
+                                       {{1, 1}, Rational_number(5)}, {{2, 2}, Rational_number(-11, 13)},
+                                       {{2, 3}, Rational_number(1, 2)}});
+    Matrix<Rational_number> rhs(4, 2, {{{0, 0}, Rational_number(3)}, {{1, 1}, Rational_number(1, 5)},
+                                       {{2, 0}, Rational_number(13, 11)}, {{3, 0}, Rational_number(2)}});
+
+    for (bool parallel : {false, true}){
+        Modular_params params;
+        params.parallel = parallel;
+        Modular_engine engine(params);
+
+        Matrix<Rational_number> prod = engine.multiply(hilbert, hilbert);
+        expect_same_matrix(prod, hilbert * hilbert);
+
+        Matrix<Rational_number> rect = engine.multiply(lhs, rhs);
+        expect_same_matrix(rect, lhs * rhs);
+        EXPECT_EQ(rect(2, 0).to_string(), "<0/1>");     // -11/13 * 13/11 + 1/2 * 2 = 0
+
+        EXPECT_THROW(engine.multiply(lhs, lhs), Shape_error);
+    }
+}
+
+TEST(ModularTest, SolveTest){
+    Modular_engine engine;
+    Matrix<Rational_number> hilbert = make_hilbert_matrix(7);
+    Vector<Rational_number> b(7, {{0, Rational_number(1)}, {3, Rational_number(-5, 3)},
+                                  {6, Rational_number(2, 9)}});
+    Vector<Rational_number> x = engine.solve(hilbert, b);
+    Vector<Rational_number> expected = bareiss_solve(hilbert, b);
+    for (int i = 0; i < 7; i++){
+        EXPECT_EQ(x.to_dense()[i].to_string(), expected.to_dense()[i].to_string());
+    }
+
+    // 1/2 - denominator is not divisible by primes, but determinant is zero
+    Matrix<Rational_number> singular(2, 2, {{{0, 0}, Rational_number(1, 2)}, {{0, 1}, Rational_number(1)},
+                                            {{1, 0}, Rational_number(1)}, {{1, 1}, Rational_number(2)}});
+    Vector<Rational_number> rhs(2, {{0, Rational_number(1)}});
+    EXPECT_THROW(engine.solve(singular, rhs), Singular_matrix);
+    EXPECT_THROW(engine.solve(make_hilbert_matrix(2), b), Shape_error);
+}
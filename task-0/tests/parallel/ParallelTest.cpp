@@ -0,0 +1,84 @@
+/**
+ * @file ParallelTest.cpp
+ * @brief Tests for thread pool, parallel loops and reductions
+ */
+
+#include "../../parallel/Parallel.hpp"
+#include <vector>
+#include <cmath>
+#include <atomic>
+#include <stdexcept>
+#include "gtest/gtest.h"
+
+Parallel_policy make_policy(unsigned threads, size_t chunk){
+    Parallel_policy policy;
+    policy.threads = threads;
+    policy.chunk = chunk;
+    policy.min_size = 0;
+    return policy;
+}
+
+TEST(ParallelTest, ThreadPoolTest){
+    for (unsigned threads : {1u, 2u, 4u}){
+        std::vector<int> hits(1000, 0);
+        Thread_pool::instance().run(hits.size(), threads, [&](size_t t){ hits[t]++; });
+        for (int hit : hits){
+            EXPECT_EQ(hit, 1);
+        }
+    }
+    // nested call is executed by calling thread
+    std::atomic<int> count{0};
+    Thread_pool::instance().run(4, 4, [&](size_t){
+        Thread_pool::instance().run(10, 4, [&](size_t){ count++; });
+    });
+    EXPECT_EQ(count, 40);
+
+    EXPECT_THROW(Thread_pool::instance().run(100, 4, [](size_t t){
+        if (t == 37) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+    // pool is usable after exception
+    std::atomic<int> after{0};
+    Thread_pool::instance().run(100, 4, [&](size_t){ after++; });
+    EXPECT_EQ(after, 100);
+}
+
+TEST(ParallelTest, ForTest){
+    std::vector<double> vals(10007, 1.0);
+    parallel_for(vals.size(), [&](size_t begin, size_t end){
+        for (size_t k = begin; k < end; k++) vals[k] += k;
+    }, make_policy(4, 100));
+    for (size_t k = 0; k < vals.size(); k++){
+        EXPECT_EQ(vals[k], 1.0 + k);
+    }
+    parallel_for(0, [](size_t, size_t){ FAIL(); }, make_policy(4, 100));
+}
+
+TEST(ParallelTest, ReduceTest){
+    // values of very different magnitude: sum depends on order of additions
+    std::vector<double> vals(100003);
+    for (size_t k = 0; k < vals.size(); k++){
+        vals[k] = std::pow(-1.0, k) * std::exp(std::fmod(k * 0.37, 30.0)) + 1e-3 * k;
+    }
+    auto sum = [&](const Parallel_policy& policy){
+        return parallel_reduce(vals.size(), 0.0, [&](size_t begin, size_t end){
+            double res = 0;
+            for (size_t k = begin; k < end; k++) res += vals[k];
+            return res;
+        }, [](double a, double b){ return a + b; }, policy);
+    };
+    double reference = sum(make_policy(1, 1000));
+    for (unsigned threads : {2u, 3u, 4u, 8u}){
+        EXPECT_EQ(sum(make_policy(threads, 1000)), reference);     // bitwise equal
+    }
+    Parallel_policy sequential = make_policy(4, 1000);
+    sequential.min_size = vals.size() + 1;
+    EXPECT_EQ(sum(sequential), reference);
+
+    double exact = 0;
+    for (double val : vals) exact += val;
+    EXPECT_NEAR(reference, exact, 1e-9 * std::abs(exact));
+
+    EXPECT_EQ(parallel_reduce(0, 5, [](size_t, size_t){ return 5; }, [](int a, int b){ return a + b; }), 5);
+    EXPECT_EQ(parallel_reduce(1000, size_t(0), [](size_t begin, size_t end){ return end - begin; },
+                              [](size_t a, size_t b){ return a + b; }, make_policy(4, 7)), 1000);
+}
@@ -0,0 +1,310 @@
+/**
+ * @file SolversTest.cpp
+ * @brief Tests for iterative solvers and preconditioners
+ */
+
+#include "../../solvers/Iterative_solvers.hpp"
+#include "../../solvers/Eigen_solvers.hpp"
+#include "../../exceptions/CommonExceptions.hpp"
+#include "gtest/gtest.h"
+
+// tridiagonal (-1, 4, -1) matrix, symmetric positive definite
+Matrix<double> make_spd_matrix(int n){
+    Matrix<double> matr(n, n);
+    for (int i = 0; i < n; i++){
+        matr(i, i) = 4;
+        if (i > 0) matr(i, i - 1) = -1;
+        if (i + 1 < n) matr(i, i + 1) = -1;
+    }
+    return matr;
+}
+
+// diagonally dominant nonsymmetric matrix
+Matrix<double> make_nonsym_matrix(int n){
+    Matrix<double> matr(n, n);
+    for (int i = 0; i < n; i++){
+        matr(i, i) = 5;
+        if (i > 0) matr(i, i - 1) = -2;
+        if (i + 1 < n) matr(i, i + 1) = 1;
+        if (i + 3 < n) matr(i, i + 3) = 0.5;
+    }
+    return matr;
+}
+
+Vector<double> make_rhs(Matrix<double>& matr, std::vector<double>& solution){
+    int n = matr.get_rows_number();
+    solution.resize(n);
+    for (int i = 0; i < n; i++){
+        solution[i] = 1 + i % 7;
+    }
+    std::vector<double> rhs(n);
+    Matrix_csr<double>(matr).multiply(solution.data(), rhs.data());
+    return Vector<double>(rhs);
+}
+
+void expect_solution(const Vector<double>& x, const std::vector<double>& solution){
+    std::vector<double> res = x.to_dense();
+    for (size_t i = 0; i < solution.size(); i++){
+        EXPECT_NEAR(res[i], solution[i], 1e-6);
+    }
+}
+
+TEST(SolversTest, CsrTest){
+    Matrix<double> matr(3, 4, {{{0, 3}, 2}, {{0, 1}, 1}, {{2, 2}, 5}});
+    matr(1, 1);     // fake value must be skipped
+    Matrix_csr<double> csr(matr);
+    EXPECT_EQ(csr.get_nnz(), 3);
+    EXPECT_EQ(csr.get_row_ptr(), std::vector<int>({0, 2, 2, 3}));
+    EXPECT_EQ(csr.get_col_idx(), std::vector<int>({1, 3, 2}));
+    EXPECT_EQ(csr.get_diagonal(), std::vector<double>({0, 0, 5}));
+
+    std::vector<double> x{1, 2, 3, 4}, y(3);
+    csr.multiply(x.data(), y.data());
+    EXPECT_EQ(y, std::vector<double>({10, 0, 15}));
+    EXPECT_EQ(csr.to_matrix().get_size(), 3);
+}
+
+TEST(SolversTest, CGTest){
+    Matrix<double> matr = make_spd_matrix(100);
+    std::vector<double> solution;
+    Vector<double> b = make_rhs(matr, solution);
+
+    for (auto precond : {Preconditioner_type::NONE, Preconditioner_type::JACOBI, Preconditioner_type::ILU0}){
+        Vector<double> x(100);
+        Solver_result res = solve_cg(matr, b, x, precond);
+        EXPECT_TRUE(res.converged);
+        EXPECT_LE(res.residual, 1e-10);
+        expect_solution(x, solution);
+    }
+    Vector<double> x(99);
+    EXPECT_THROW(solve_cg(matr, b, x), Shape_error);
+
+    // components of solution below eps of Vector are kept
+    Matrix<double> diag(40, 40);
+    Vector<double> small_b(40);
+    for (int i = 0; i < 40; i++){
+        diag(i, i) = 4;
+        small_b(i) = (i % 2) ? 0.02 : 1.0;
+    }
+    Vector<double> small_x(40);
+    Solver_result res = solve_cg(diag, small_b, small_x);
+    EXPECT_TRUE(res.converged);
+    for (int i = 0; i < 40; i++){
+        EXPECT_DOUBLE_EQ(small_x.to_dense()[i], (i % 2) ? 0.005 : 0.25);
+    }
+}
+
+TEST(SolversTest, BiCGSTABTest){
+    Matrix<double> matr = make_nonsym_matrix(80);
+    std::vector<double> solution;
+    Vector<double> b = make_rhs(matr, solution);
+
+    for (auto precond : {Preconditioner_type::NONE, Preconditioner_type::JACOBI, Preconditioner_type::ILU0}){
+        Vector<double> x(80);
+        Solver_result res = solve_bicgstab(matr, b, x, precond);
+        EXPECT_TRUE(res.converged);
+        expect_solution(x, solution);
+    }
+}
+
+TEST(SolversTest, GMRESTest){
+    Matrix<double> matr = make_nonsym_matrix(80);
+    std::vector<double> solution;
+    Vector<double> b = make_rhs(matr, solution);
+
+    Solver_params params;
+    params.restart = 10;
+    for (auto precond : {Preconditioner_type::NONE, Preconditioner_type::JACOBI, Preconditioner_type::ILU0}){
+        Vector<double> x(80);
+        Solver_result res = solve_gmres(matr, b, x, precond, params);
+        EXPECT_TRUE(res.converged);
+        expect_solution(x, solution);
+    }
+
+    // ILU(0) of tridiagonal matrix is exact LU
+    Matrix<double> spd = make_spd_matrix(50);
+    Vector<double> b_spd = make_rhs(spd, solution);
+    Vector<double> x(50);
+    Solver_result res = solve_gmres(spd, b_spd, x, Preconditioner_type::ILU0);
+    EXPECT_TRUE(res.converged);
+    EXPECT_LE(res.iterations, 2);
+}
+
+TEST(SolversTest, ComplexTest){
+    int n = 40;
+    Matrix<Complex_number<>> herm(n, n), general(n, n);
+    for (int i = 0; i < n; i++){
+        herm(i, i) = Complex_number<>(6);
+        general(i, i) = Complex_number<>(6, 1);
+        if (i + 1 < n){
+            herm(i, i + 1) = Complex_number<>(1, 2);
+            herm(i + 1, i) = Complex_number<>(1, -2);
+            general(i, i + 1) = Complex_number<>(-1, 2);
+            general(i + 1, i) = Complex_number<>(2, 0.5);
+        }
+    }
+    std::vector<Complex_number<>> solution(n), rhs(n);
+    for (int i = 0; i < n; i++){
+        solution[i] = Complex_number<>(1 + i % 3, -1 + i % 5);
+    }
+
+    Matrix_csr<Complex_number<>>(herm).multiply(solution.data(), rhs.data());
+    Vector<Complex_number<>> x1(n);
+    EXPECT_TRUE(solve_cg(herm, Vector<Complex_number<>>(rhs), x1, Preconditioner_type::JACOBI).converged);
+
+    Matrix_csr<Complex_number<>>(general).multiply(solution.data(), rhs.data());
+    Vector<Complex_number<>> x2(n), x3(n);
+    EXPECT_TRUE(solve_bicgstab(general, Vector<Complex_number<>>(rhs), x2, Preconditioner_type::ILU0).converged);
+    EXPECT_TRUE(solve_gmres(general, Vector<Complex_number<>>(rhs), x3).converged);
+
+    std::vector<Complex_number<>> res1 = x1.to_dense(), res2 = x2.to_dense(), res3 = x3.to_dense();
+    for (int i = 0; i < n; i++){
+        EXPECT_NEAR(res1[i].get_real(), solution[i].get_real(), 1e-6);
+        EXPECT_NEAR(res1[i].get_imag(), solution[i].get_imag(), 1e-6);
+        EXPECT_NEAR(res2[i].get_real(), solution[i].get_real(), 1e-6);
+        EXPECT_NEAR(res2[i].get_imag(), solution[i].get_imag(), 1e-6);
+        EXPECT_NEAR(res3[i].get_real(), solution[i].get_real(), 1e-6);
+        EXPECT_NEAR(res3[i].get_imag(), solution[i].get_imag(), 1e-6);
+    }
+}
+
+TEST(SolversTest, PreconditionerTest){
+    Matrix<double> matr(2, 2, {{{0, 1}, 1}, {{1, 0}, 1}});
+    Matrix_csr<double> csr(matr);
+    EXPECT_THROW(Jacobi_preconditioner<double>{csr}, Zero_division);
+    EXPECT_THROW(ILU0_preconditioner<double>{csr}, Zero_division);
+
+    Matrix<double> diag(2, 2, {{{0, 0}, 2}, {{1, 1}, 4}});
+    std::vector<double> r{2, 2}, z(2);
+    make_preconditioner(Preconditioner_type::JACOBI, Matrix_csr<double>(diag))->apply(r, z);
+    EXPECT_EQ(z, std::vector<double>({1, 0.5}));
+}
+
+// ||A * x - lambda * x||
+template<class T, class V, class X>
+double eigen_residual(const Matrix<T>& matr, const V& lambda, const std::vector<X>& x){
+    int n = matr.get_rows_number();
+    std::vector<Complex_number<>> xc(n), ax(n);
+    for (int i = 0; i < n; i++) xc[i] = Complex_number<>(x[i]);
+    Matrix_csr<Complex_number<>>(Matrix<Complex_number<>>(n, n, [&](){
+        matr_vals<Complex_number<>> vals;
+        for (const auto& elem : matr.get_values()) vals[elem.first] = Complex_number<>(elem.second);
+        return vals;
+    }(), 0)).multiply(xc.data(), ax.data());
+    double sum = 0;
+    for (int i = 0; i < n; i++){
+        sum += (ax[i] - Complex_number<>(lambda) * xc[i]).module_square();
+    }
+    return std::sqrt(sum);
+}
+
+TEST(SolversTest, LanczosTest){
+    // eigenvalues of tridiagonal (-1, 4, -1): 4 - 2 * cos(pi * j / (n + 1))
+    int n = 300;
+    Matrix<double> matr = make_spd_matrix(n);
+    Eigen_params params;
+    params.count = 4;
+    params.target = Eigen_target::LARGEST_REAL;
+    Eigen_result<double, double> res = eigs_hermitian(matr, params);
+    EXPECT_TRUE(res.converged);
+    ASSERT_EQ(res.values.size(), 4u);
+    for (int c = 0; c < 4; c++){
+        EXPECT_NEAR(res.values[c], 4 - 2 * std::cos(M_PI * (n - c) / (n + 1)), 1e-8);
+        EXPECT_LT(eigen_residual(matr, res.values[c], res.vectors[c]), 1e-7);
+    }
+    EXPECT_NEAR(dot(res.vectors[0], res.vectors[1]), 0, 1e-10);
+
+    // hermitian complex matrix: real spectrum, smallest values
+    Matrix<Complex_number<>> herm(n, n);
+    for (int i = 0; i < n; i++){
+        herm(i, i) = Complex_number<>(0.1 * i);
+        if (i + 1 < n){
+            herm(i, i + 1) = Complex_number<>(0.5, 1);
+            herm(i + 1, i) = Complex_number<>(0.5, -1);
+        }
+    }
+    params.count = 3;
+    params.target = Eigen_target::SMALLEST_REAL;
+    auto herm_res = eigs_hermitian(herm, params);
+    EXPECT_TRUE(herm_res.converged);
+    EXPECT_LE(herm_res.values[0], herm_res.values[1]);
+    for (int c = 0; c < 3; c++){
+        EXPECT_LT(eigen_residual(herm, herm_res.values[c], herm_res.vectors[c]), 1e-7);
+    }
+
+    EXPECT_THROW(eigs_hermitian(Matrix<double>(3, 4), params), Shape_error);
+    params.count = 0;
+    EXPECT_THROW(eigs_hermitian(matr, params), Init_error);
+}
+
+TEST(SolversTest, ArnoldiTest){
+    // block upper triangular: 2 x 2 blocks [a, b; -b, a] give eigenvalues a +- 0.5i
+    int n = 200;
+    Matrix<double> matr(n, n);
+    for (int j = 0; j < n / 2; j++){
+        double a = 1 + 0.05 * j;
+        matr(2 * j, 2 * j) = a;
+        matr(2 * j + 1, 2 * j + 1) = a;
+        matr(2 * j, 2 * j + 1) = 0.5;
+        matr(2 * j + 1, 2 * j) = -0.5;
+    }
+    for (int i = 0; i + 2 < n; i++){
+        matr(i, i + 2) = 0.3;
+    }
+    Eigen_params params;
+    params.count = 4;
+    auto res = eigs(matr, params);
+    EXPECT_TRUE(res.converged);
+    ASSERT_EQ(res.values.size(), 4u);
+    for (int c = 0; c < 4; c++){
+        // non-normal matrix: eigenvalues are less accurate than residuals
+        EXPECT_NEAR(res.values[c].get_real(), 1 + 0.05 * (n / 2 - 1 - c / 2), 1e-6);
+        EXPECT_NEAR(std::abs(res.values[c].get_imag()), 0.5, 1e-6);
+        EXPECT_LT(eigen_residual(matr, res.values[c], res.vectors[c]), 1e-7);
+    }
+
+    // complex upper triangular: eigenvalues are diagonal
+    Matrix<Complex_number<>> general(n, n);
+    for (int i = 0; i < n; i++){
+        general(i, i) = Complex_number<>(std::cos(i), 0.01 * i);
+        if (i + 1 < n) general(i, i + 1) = Complex_number<>(0.2, -0.1);
+    }
+    params.count = 2;
+    params.target = Eigen_target::SMALLEST_REAL;
+    params.subspace = 40;
+    auto complex_res = eigs(general, params);
+    EXPECT_TRUE(complex_res.converged);
+    for (int c = 0; c < 2; c++){
+        EXPECT_LT(eigen_residual(general, complex_res.values[c], complex_res.vectors[c]), 1e-7);
+    }
+    EXPECT_LE(complex_res.values[0].get_real(), complex_res.values[1].get_real());
+    EXPECT_NEAR(complex_res.values[0].get_real(), -1, 1e-3);
+}
+
+TEST(SolversTest, InvariantSubspaceTest){
+    // repeated eigenvalues: Krylov space of any vector has dimension 3, so it breaks down
+    int n = 40;
+    Matrix<double> matr(n, n);
+    for (int i = 0; i < n; i++){
+        matr(i, i) = i < 10 ? 5 : (i < 20 ? 3 : 1);
+    }
+    Eigen_params params;
+    params.count = 3;
+    params.subspace = 10;
+    auto herm_res = eigs_hermitian(matr, params);
+    EXPECT_TRUE(herm_res.converged);
+    ASSERT_EQ(herm_res.values.size(), 3u);
+    for (int c = 0; c < 3; c++){
+        EXPECT_NEAR(herm_res.values[c], 5, 1e-8);
+        EXPECT_LT(eigen_residual(matr, herm_res.values[c], herm_res.vectors[c]), 1e-7);
+    }
+
+    auto res = eigs(matr, params);
+    EXPECT_TRUE(res.converged);
+    ASSERT_EQ(res.values.size(), 3u);
+    for (int c = 0; c < 3; c++){
+        EXPECT_NEAR(res.values[c].get_real(), 5, 1e-8);
+        EXPECT_NEAR(res.values[c].get_imag(), 0, 1e-8);
+        EXPECT_LT(eigen_residual(matr, res.values[c], res.vectors[c]), 1e-7);
+    }
+}
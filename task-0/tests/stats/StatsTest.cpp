@@ -0,0 +1,65 @@
+/**
+ * @file StatsTest.cpp
+ * @brief Tests for per-thread counters
+ */
+
+#include "../../stats/Stats.hpp"
+#include "../../parallel/Parallel.hpp"
+#include "../../matrix/ClassMatrix.h"
+#include "../../vector/ClassVector.hpp"
+#include <thread>
+#include <sstream>
+#include "gtest/gtest.h"
+
+TEST(StatsTest, MergeTest){
+    // counters of pool workers and of finished threads are summed on read
+    stats_reset();
+    Thread_pool::instance().run(1000, 4, [](size_t){ stat_add(Stat_counter::GCD_CALLS, 2); });
+    std::thread thread([](){ stat_add(Stat_counter::GCD_CALLS, 5); });
+    thread.join();
+    EXPECT_EQ(stats_read(Stat_counter::GCD_CALLS), 2005u);
+    EXPECT_EQ(stats_read(Stat_counter::BYTES_MOVED), 0u);
+
+    stats_reset();
+    EXPECT_EQ(stats_read(Stat_counter::GCD_CALLS), 0u);
+    stat_add(Stat_counter::GCD_CALLS);
+    EXPECT_EQ(stats_read(Stat_counter::GCD_CALLS), 1u);
+}
+
+TEST(StatsTest, DumpTest){
+    stats_reset();
+    stat_add(Stat_counter::FAKE_REMOVALS, 3);
+    std::ostringstream os;
+    stats_dump(os);
+    std::string dump = os.str();
+    EXPECT_NE(dump.find("allocations 0\n"), std::string::npos);
+    EXPECT_NE(dump.find("fake_removals 3\n"), std::string::npos);
+    EXPECT_EQ(dump.find("#") != std::string::npos, !stats_enabled);
+    EXPECT_STREQ(stat_name(Stat_counter::HASH_PROBES), "hash_probes");
+}
+
+TEST(StatsTest, LibraryCountersTest){
+    if (!stats_enabled){
+        GTEST_SKIP() << "library counters are disabled (TASK0_STATS)";
+    }
+    stats_reset();
+    Matrix<double> matrix(3, 3);
+    matrix(0, 0) = 1;
+    double read = matrix(1, 1);     // fake zero value
+    EXPECT_EQ(read, 0);
+    EXPECT_EQ(stats_read(Stat_counter::FAKE_INSERTS), 2u);
+    EXPECT_GE(stats_read(Stat_counter::HASH_PROBES), 2u);
+    EXPECT_EQ(matrix.get_size(), 1);
+    EXPECT_EQ(stats_read(Stat_counter::FAKE_REMOVALS), 1u);
+
+    Vector<double> vector(10);
+    vector(3) = 2;
+    vector.set_storage(Vector_storage::DENSE);
+    EXPECT_EQ(stats_read(Stat_counter::FAKE_INSERTS), 3u);
+    EXPECT_EQ(stats_read(Stat_counter::ALLOCATIONS), 1u);
+    EXPECT_EQ(stats_read(Stat_counter::BYTES_MOVED), sizeof(double));
+
+    Rational_number half(2, 4);
+    EXPECT_EQ(stats_read(Stat_counter::CANONICALIZATIONS), 1u);
+    EXPECT_GE(stats_read(Stat_counter::GCD_CALLS), 2u);
+}
@@ -4,6 +4,7 @@
  */
 
 #include "../../vector/ClassVector.hpp"
+#include "../../vector/Vector_kernels.hpp"
 #include "../../exceptions/VectorExceptions.hpp"
 #include "../../exceptions/CommonExceptions.hpp"
 #include "../../exceptions/ParserExceptions.hpp"
@@ -83,5 +84,433 @@ TEST(VectorTest, OperatorsTest){
     EXPECT_EQ(vec3(1), 10);
 }
 
+TEST(VectorTest, ExpressionTest){
+    Vector<int> x(4, {{0, 1}, {2, 3}});
+    Vector<int> y(4, {{1, 2}, {2, -9}});
+    Matrix<int> a(4, 3, {{{0, 0}, 2}, {{0, 2}, 1}, {{2, 1}, 5}, {{3, 0}, 7}});
+    Vector<int> w(3, {{0, 1}, {1, -15}});
+
+    // x * alpha + y and x * A + w are evaluated by fused kernels
+    Vector<int> axpy(x * 3 + y);
+    EXPECT_EQ(axpy.get_size(), 2);
+    EXPECT_EQ(axpy(0), 3);
+    EXPECT_EQ(axpy(1), 2);
+    EXPECT_EQ(axpy(2), 0);
+
+    Vector<int> gemv(x * a + w);
+    EXPECT_EQ(gemv.get_max_size(), 3);
+    EXPECT_EQ(gemv(0), 3);
+    EXPECT_EQ(gemv(1), 0);
+    EXPECT_EQ(gemv(2), 1);
+    EXPECT_EQ(gemv.get_size(), 2);
+
+    Vector<int> nested((x - y) * 2 * a - (-w));
+    EXPECT_EQ(nested(0), 5);        // 2 * 1 * 2 + 1
+    EXPECT_EQ(nested(1), 105);      // 2 * 12 * 5 - 15
+    EXPECT_EQ(nested(2), 2);
+
+    x = x + x * 2;
+    EXPECT_EQ(x(2), 9);
+
+    Vector<double> d(2, {{0, 0.5}, {1, 1.25}});
+    Vector<double> sum(d + Vector<int>(2, {{0, 1}}));
+    EXPECT_DOUBLE_EQ(sum(0), 1.5);
+    EXPECT_DOUBLE_EQ(sum(1), 1.25);
+
+    EXPECT_THROW(x + w, Shape_error);
+    EXPECT_THROW((x + y) * Matrix<int>(3, 3), Shape_error);
+}
+
+TEST(VectorTest, ExactTypesTest){
+    // values of exact types are kept however small they are, floating values below eps are dropped
+    Vector<Rational_number> r(4, {{0, Rational_number(1, 1000)}, {2, Rational_number((long) 0)}});
+    EXPECT_EQ(r.get_size(), 1);
+    Vector<double> d(4, {{0, 0.001}, {2, 0.5}});
+    EXPECT_EQ(d.get_size(), 1);
+    Matrix<Rational_number> m(2, 2, {{{0, 1}, Rational_number(1, 1000)}});
+    EXPECT_EQ(m.get_size(), 1);
+    Matrix<Complex_number<>> c(2, 2, {{{0, 1}, Complex_number<>(0.001, 0)}, {{1, 1}, Complex_number<>(0, 1)}});
+    EXPECT_EQ(c.get_size(), 1);
+}
+
+TEST(VectorTest, StorageTest){
+    Vector<int> tree(10, {{1, 5}, {4, -2}, {7, 4}});
+    Vector<int> sorted(tree);
+    sorted.set_storage(Vector_storage::SORTED);
+    EXPECT_EQ(tree.get_storage(), Vector_storage::TREE);
+    EXPECT_EQ(sorted.get_storage(), Vector_storage::SORTED);
+    EXPECT_EQ(sorted.to_string(), tree.to_string());
+    EXPECT_EQ(sorted.to_dense(), tree.to_dense());
+
+    EXPECT_EQ(sorted(4), -2);
+    EXPECT_EQ(sorted(5), 0);        // fake value is inserted and cleared
+    EXPECT_EQ(sorted.get_size(), 3);
+    sorted(0) = 3;
+    sorted(9) = 1;
+    EXPECT_EQ(sorted.get_size(), 5);
+    EXPECT_EQ(sorted.to_dense(), std::vector<int>({3, 5, 0, 0, -2, 0, 0, 4, 0, 1}));
+
+    // sorted + sorted is merged, result keeps storage of left operand
+    Vector<int> other(10, {{0, -3}, {2, 6}, {7, 1}});
+    other.set_storage(Vector_storage::SORTED);
+    Vector<int> sum(sorted + other);
+    EXPECT_EQ(sum.get_storage(), Vector_storage::SORTED);
+    EXPECT_EQ(sum.to_dense(), std::vector<int>({0, 5, 6, 0, -2, 0, 0, 5, 0, 1}));
+    EXPECT_EQ(sum.get_size(), 5);
+    Vector<int> diff(sorted - other);
+    EXPECT_EQ(diff.to_dense(), std::vector<int>({6, 5, -6, 0, -2, 0, 0, 3, 0, 1}));
+    Vector<int> mixed(tree + other * 2);
+    EXPECT_EQ(mixed.get_storage(), Vector_storage::TREE);
+    EXPECT_EQ(mixed.to_dense(), std::vector<int>({-6, 5, 12, 0, -2, 0, 0, 6, 0, 0}));
+
+    sum = sum - other;
+    EXPECT_EQ(sum.to_dense(), sorted.to_dense());
+    EXPECT_EQ((-sum)(7), -4);
+    EXPECT_EQ((sum + 1)(3), 1);
+
+    Matrix<int> f(10, 2, {{{1, 0}, 2}, {{7, 1}, 3}});
+    Vector<int> prod(sorted * f);
+    EXPECT_EQ(prod.get_storage(), Vector_storage::SORTED);
+    EXPECT_EQ(prod(0), 10);
+    EXPECT_EQ(prod(1), 12);
+
+    sorted.set_storage(Vector_storage::TREE);
+    EXPECT_EQ(sorted.to_string(), Vector<int>(sum).to_string());
+}
+
+TEST(VectorTest, AccessTest){
+    Vector<int> v(10, {{1, 5}, {4, -2}});
+    for (Vector_storage storage : {Vector_storage::TREE, Vector_storage::SORTED, Vector_storage::DENSE}){
+        v.set_storage(storage);
+        EXPECT_EQ(v.try_get(4), -2);
+        EXPECT_EQ(v.try_get(5), 0);         // missing value is not inserted
+        EXPECT_EQ(v.try_get(10), std::nullopt);
+        EXPECT_EQ(v.try_get(-1), std::nullopt);
+        EXPECT_EQ(v.at(1), 5);
+        EXPECT_THROW(v.at(10), Out_of_range);
+        EXPECT_THROW(v.at(-1), Out_of_range);
+#if TASK0_BOUNDS_CHECK
+        EXPECT_THROW(v(10), Out_of_range);
+#endif
+    }
+}
+
+TEST(VectorTest, KernelsTest){
+    Vector<int> a(10, {{0, 2}, {3, -1}, {7, 4}});
+    Vector<int> b(10, {{3, 5}, {5, 2}, {7, 3}, {9, 1}});
+    EXPECT_EQ(dot(a, b), 7);
+    b.set_storage(Vector_storage::SORTED);
+    EXPECT_EQ(dot(a, b), 7);
+    EXPECT_EQ(dot(b, a), 7);
+    EXPECT_EQ(dot(a, Vector<int>(10)), 0);
+    EXPECT_EQ(dot(a, std::vector<int>({1, 1, 1, 1, 1, 1, 1, 1, 1, 1})), 5);
+    EXPECT_THROW(dot(a, Vector<int>(9)), Shape_error);
+    EXPECT_THROW(dot(a, std::vector<int>(3, 1)), Shape_error);
+
+    // galloping: few non-zeros against long vector
+    int n = 1000;
+    std::vector<double> dense(n);
+    for (int i = 0; i < n; i++) dense[i] = 0.5 * (i + 1);
+    Vector<double> filled(dense);
+    filled.set_storage(Vector_storage::SORTED);
+    Vector<double> few(n, {{1, 2.0}, {500, -1.0}, {999, 4.0}});
+    EXPECT_DOUBLE_EQ(dot(few, filled), 2.0 * 1 - 250.5 + 4.0 * 500);
+    EXPECT_DOUBLE_EQ(dot(filled, few), dot(few, filled));
+    EXPECT_DOUBLE_EQ(dot(filled, dense), dot(dense, filled));
+    EXPECT_DOUBLE_EQ(dot(filled, dense), 0.25 * n * (n + 1) * (2 * n + 1) / 6);
+
+    Vector<double> x(8, {{0, 3.0}, {2, -4.0}, {5, 1.5}, {6, -0.5}, {7, 2.0}});
+    EXPECT_DOUBLE_EQ(norm1(x), 11);
+    EXPECT_DOUBLE_EQ(norm2(x), std::sqrt(31.5));
+    EXPECT_DOUBLE_EQ(norm_inf(x), 4);
+    EXPECT_DOUBLE_EQ(norm2(Vector<double>(5)), 0);
+
+    // dot of complex vectors conjugates left operand
+    using Compl = Complex_number<>;
+    std::vector<Compl> cdense(11);
+    Vector<Compl> u(11, {{1, Compl(1, 2)}, {4, Compl(0, -1)}, {6, Compl(3, 0)}, {10, Compl(1, 1)}});
+    Vector<Compl> w(11, {{1, Compl(2, 0)}, {6, Compl(1, 1)}, {8, Compl(5, 5)}, {10, Compl(0, 2)}});
+    w.for_each_value([&cdense](int idx, const Compl& val){ cdense[idx] = val; });
+    Compl expected = Compl(2, -4) + Compl(3, 3) + Compl(2, 2);
+    EXPECT_EQ(dot(u, w), expected);
+    EXPECT_EQ(dot(u, cdense), expected);
+    EXPECT_EQ(dot(w, u), conjugate(expected));
+    EXPECT_DOUBLE_EQ(norm1(u), std::sqrt(5) + 1 + 3 + std::sqrt(2));
+    EXPECT_DOUBLE_EQ(norm2(u), std::sqrt(17));
+    EXPECT_DOUBLE_EQ(norm_inf(u), 3);
+
+    // axpy in both storages, cancelled values are removed
+    for (auto mode : {Vector_storage::TREE, Vector_storage::SORTED}){
+        Vector<int> y(10, {{0, 1}, {3, 2}, {8, 5}});
+        y.set_storage(mode);
+        axpy(2, a, y);
+        EXPECT_EQ(y.get_storage(), mode);
+        EXPECT_EQ(y.to_dense(), std::vector<int>({5, 0, 0, 0, 0, 0, 0, 8, 5, 0}));
+        EXPECT_EQ(y.get_size(), 3);
+        axpy(-1, y, y);
+        EXPECT_EQ(y.get_size(), 0);
+    }
+    Vector<Compl> cy(11, {{0, Compl(1, 0)}, {6, Compl(-3, 0)}});
+    cy.set_storage(Vector_storage::SORTED);
+    axpy(Compl(0, 1), u, cy);
+    EXPECT_EQ(cy.to_dense()[1], Compl(-2, 1));
+    EXPECT_EQ(cy.to_dense()[6], Compl(-3, 3));
+    EXPECT_EQ(cy.to_dense()[10], Compl(-1, 1));
+    Vector<int> short_y(9);
+    EXPECT_THROW(axpy(1, a, short_y), Shape_error);
+}
+
+TEST(VectorTest, DenseTest){
+    int n = 100;
+    Vector<double> ones(n, true);
+    EXPECT_EQ(ones.get_storage(), Vector_storage::DENSE);
+    EXPECT_EQ(ones.get_size(), n);
+
+    // scalar shift fills all positions: result is DENSE, shift back returns to sparse storage
+    Vector<double> sparse(n, {{3, 2.0}, {40, -1.0}, {99, 4.0}});
+    Vector<double> shifted(sparse + 1.0);
+    EXPECT_EQ(shifted.get_storage(), Vector_storage::DENSE);
+    EXPECT_EQ(shifted.get_size(), n - 1);   // -1 + 1 = 0 at position 40
+    EXPECT_DOUBLE_EQ(shifted(3), 3.0);
+    EXPECT_DOUBLE_EQ(shifted(50), 1.0);
+    Vector<double> back(shifted - 1.0);
+    EXPECT_EQ(back.get_storage(), Vector_storage::TREE);
+    EXPECT_EQ(back.to_dense(), std::vector<double>(sparse.to_dense()));
+    sparse.set_storage(Vector_storage::SORTED);
+    EXPECT_EQ(((sparse + 1.0) - 1.0).get_storage(), Vector_storage::SORTED);
+
+    // assignment of dense array keeps values below eps, drops exact zeros
+    std::vector<double> below_eps(n, 0.0);
+    below_eps[5] = 0.001;
+    below_eps[7] = 2.0;
+    Vector<double> assigned(n);
+    assigned.assign_dense(below_eps);
+    EXPECT_EQ(assigned.get_storage(), Vector_storage::TREE);
+    EXPECT_EQ(assigned.to_dense(), below_eps);
+    EXPECT_THROW(assigned.assign_dense(std::vector<double>(3)), Shape_error);
+
+    // short vectors keep their storage
+    Vector<int> small(10, {{1, 2}});
+    EXPECT_EQ((small + 1).get_storage(), Vector_storage::TREE);
+
+    // expressions with DENSE leftmost operand are evaluated into dense array
+    Vector<double> sum(shifted + sparse * 2.0);
+    EXPECT_EQ(sum.get_storage(), Vector_storage::DENSE);
+    EXPECT_DOUBLE_EQ(sum(3), 7.0);
+    EXPECT_DOUBLE_EQ(sum(40), -2.0);
+    EXPECT_DOUBLE_EQ(sum(0), 1.0);
+    sum = sum - shifted;
+    EXPECT_EQ(sum.get_storage(), Vector_storage::TREE);
+    EXPECT_EQ(sum.get_size(), 3);
+    EXPECT_DOUBLE_EQ(sum(99), 8.0);
+    Vector<double> filled(sparse + ones);
+    EXPECT_EQ(filled.get_storage(), Vector_storage::DENSE);
+    EXPECT_DOUBLE_EQ(filled(40), 0.0);
+    EXPECT_EQ(filled.get_size(), n - 1);
+
+    // element access doesn't create fake values
+    filled(40) = 5.0;
+    filled(41) = 0.0;
+    EXPECT_EQ(filled.get_size(), n - 1);
+    EXPECT_EQ(filled.to_string(), Vector<double>(filled * 1.0).to_string());
+
+    std::vector<double> dense(n, 0.0);
+    dense[7] = 3.0;
+    EXPECT_EQ(Vector<double>(dense).get_storage(), Vector_storage::TREE);
+    std::fill(dense.begin(), dense.end(), 2.0);
+    Vector<double> twos(dense);
+    EXPECT_EQ(twos.get_storage(), Vector_storage::DENSE);
+
+    // kernels on DENSE vectors
+    EXPECT_DOUBLE_EQ(dot(twos, ones), 2.0 * n);
+    EXPECT_DOUBLE_EQ(dot(twos, sparse), 10.0);
+    EXPECT_DOUBLE_EQ(dot(sparse, twos), 10.0);
+    EXPECT_DOUBLE_EQ(dot(twos, dense), 4.0 * n);
+    EXPECT_DOUBLE_EQ(norm1(shifted), n - 3 + 3.0 + 5.0);
+    EXPECT_DOUBLE_EQ(norm_inf(shifted), 5.0);
+    EXPECT_DOUBLE_EQ(norm2(twos), 20.0);
+
+    axpy(-0.5, twos, ones);     // all values cancel
+    EXPECT_EQ(ones.get_storage(), Vector_storage::TREE);
+    EXPECT_EQ(ones.get_size(), 0);
+    Vector<double> y(n, {{0, 1.0}});
+    axpy(1.0, twos, y);
+    EXPECT_EQ(y.get_storage(), Vector_storage::DENSE);
+    EXPECT_DOUBLE_EQ(y(0), 3.0);
+    axpy(-1.0, sparse, y);
+    EXPECT_DOUBLE_EQ(y(3), 0.0);
+    EXPECT_DOUBLE_EQ(y(40), 3.0);
+}
+
+TEST(VectorTest, CompoundTest){
+    for (auto mode : {Vector_storage::TREE, Vector_storage::SORTED, Vector_storage::DENSE}){
+        Vector<int> v(10, {{0, 1}, {3, 2}, {8, 5}});
+        Vector<int> w(10, {{3, -2}, {5, 4}});
+        v.set_storage(mode);
+        v += w;
+        EXPECT_EQ(v.get_storage(), mode);
+        EXPECT_EQ(v.to_dense(), std::vector<int>({1, 0, 0, 0, 0, 4, 0, 0, 5, 0}));
+        EXPECT_EQ(v.get_size(), 3);
+        v -= w * 2 + w;
+        EXPECT_EQ(v.to_dense(), std::vector<int>({1, 0, 0, 6, 0, -8, 0, 0, 5, 0}));
+        v += v * 2 - w;      // operands refer to v
+        EXPECT_EQ(v.to_dense(), std::vector<int>({3, 0, 0, 20, 0, -28, 0, 0, 15, 0}));
+        v -= v;
+        EXPECT_EQ(v.get_size(), 0);
+        EXPECT_THROW(v += Vector<int>(9), Shape_error);
+    }
+
+    Vector<double> x(6, {{1, 2.0}, {4, -3.0}});
+    x *= 2;
+    EXPECT_EQ(x.to_dense(), std::vector<double>({0, 4, 0, 0, -6, 0}));
+    x /= 4;
+    EXPECT_EQ(x.to_dense(), std::vector<double>({0, 1, 0, 0, -1.5, 0}));
+    EXPECT_THROW(x /= 0, Zero_division);
+    x += 1.0;
+    EXPECT_EQ(x.to_dense(), std::vector<double>({1, 2, 1, 1, -0.5, 1}));
+    x -= 1.0;
+    EXPECT_EQ(x.get_size(), 2);
+    x *= 0.001;      // values less than eps are removed
+    EXPECT_EQ(x.get_size(), 0);
+
+    // vector / scalar returns quotient, operand is not changed
+    Vector<double> y(6, {{2, 3.0}});
+    Vector<double> q(y / 2);
+    EXPECT_DOUBLE_EQ(q(2), 1.5);
+    EXPECT_DOUBLE_EQ(y(2), 3.0);
+
+    // rvalue operands are updated in place
+    Vector<double> moved(std::move(y) + 1.0);
+    EXPECT_DOUBLE_EQ(moved(2), 4.0);
+    EXPECT_DOUBLE_EQ(moved(0), 1.0);
+    Vector<double> neg(-(q / 0.5));
+    EXPECT_DOUBLE_EQ(neg(2), -3.0);
+}
+
+TEST(VectorTest, MatrixVectorTest){
+    Matrix<int> a(3, 4, {{{0, 0}, 2}, {{0, 2}, 1}, {{2, 1}, 5}, {{2, 3}, 7}});
+    Vector<int> x(4, {{0, 1}, {2, 3}, {3, -1}});
+    Vector<int> y(3, {{0, 4}, {1, 2}});
+
+    Vector<int> ax(a * x);
+    EXPECT_EQ(ax.get_max_size(), 3);
+    EXPECT_EQ(ax.to_dense(), std::vector<int>({5, 0, -7}));
+    EXPECT_EQ(ax.get_size(), 2);
+    Vector<int> gemv(y - a * x * 2);
+    EXPECT_EQ(gemv.to_dense(), std::vector<int>({-6, 2, 14}));
+    Vector<int> nested((a + a) * (x + x));
+    EXPECT_EQ(nested.to_dense(), std::vector<int>({20, 0, -28}));
+    // A^T * y is y * A
+    Vector<int> row(y * a);
+    Vector<int> column(~a * y);
+    EXPECT_EQ(row.to_dense(), column.to_dense());
+
+    EXPECT_THROW(a * y, Shape_error);
+    EXPECT_THROW(Vector<int>(a * Vector<int>(3)), Shape_error);
+
+    // several vectors at once
+    int n = 40;
+    matr_vals<double> vals;
+    for (int i = 0; i < n; i++){
+        vals[{i, i}] = 2.0;
+        if (i + 1 < n) vals[{i, i + 1}] = -1.0;
+        vals[{i, (i * 7) % n}] += 0.5;
+    }
+    Matrix<double> b(n, n, vals);
+    std::vector<Vector<double>> xs = {Vector<double>(n, true), Vector<double>(n, {{3, 1.0}, {17, -2.0}}),
+                                      Vector<double>(n)};
+    for (int i = 0; i < n; i++) xs[2](i) = 0.25 * i;
+    std::vector<Vector<double>> ys = multiply(b, xs);
+    ASSERT_EQ(ys.size(), 3u);
+    for (int v = 0; v < 3; v++){
+        Vector<double> expected(b * xs[v]);
+        EXPECT_EQ(ys[v].get_max_size(), n);
+        EXPECT_EQ(ys[v].to_dense(), expected.to_dense());
+    }
+    xs.push_back(Vector<double>(n + 1));
+    EXPECT_THROW(multiply(b, xs), Shape_error);
+}
+
 //TEST(VectorTest, MethodsTest){
-//}
\ No newline at end of file
+//}
+TEST(VectorTest, ComplexArrayTest){
+    using Complex = Complex_number<>;
+    int n = 45;
+    matr_vals<Complex> vals;
+    std::vector<Complex> dense(n);
+    for (int i = 0; i < n; i++){
+        vals[{i, i}] = Complex(2.0, 1.0);
+        vals[{i, (i * 7 + 3) % n}] += Complex(-0.5, 0.25 * (i % 3));
+        dense[i] = Complex(1.0 + i % 4, 0.5 - i % 2);
+    }
+    Matrix<Complex> a(n, n, vals);
+    Vector<Complex> x(dense);
+
+    Complex_array<> split = to_complex_array(x);
+    EXPECT_EQ(split.to_vector(), x.to_dense());
+    EXPECT_EQ(to_vector(split).to_dense(), x.to_dense());
+
+    Complex_array<> ax = multiply(Matrix_csr<Complex>(a), split);
+    std::vector<Complex> expected = Vector<Complex>(a * x).to_dense();
+    for (int i = 0; i < n; i++){
+        EXPECT_NEAR(ax[i].get_real(), expected[i].get_real(), 1e-12);
+        EXPECT_NEAR(ax[i].get_imag(), expected[i].get_imag(), 1e-12);
+    }
+    Complex d = dot(split, split);
+    EXPECT_NEAR(d.get_real(), dot(x, x).get_real(), 1e-10);
+    EXPECT_NEAR(d.get_imag(), 0.0, 1e-12);
+
+    EXPECT_THROW(multiply(Matrix_csr<Complex>(a), Complex_array<>(n - 1)), Shape_error);
+}
+
+TEST(VectorTest, ParallelTest){
+    Parallel_policy saved = default_parallel_policy();
+    default_parallel_policy().min_size = 0;
+    default_parallel_policy().chunk = 64;
+
+    const int n = 5000;
+    std::vector<double> dense(n);
+    vect_vals<double> sparse;
+    for (int i = 0; i < n; i++){
+        dense[i] = 0.5 + std::sin(i * 0.7) * (i % 13 + 1);
+        if (i % 5 == 0) sparse.emplace_hint(sparse.end(), i, 1.0 + i % 11);
+    }
+    Vector<double> x(dense), s(n, sparse);
+    s.set_storage(Vector_storage::SORTED);
+
+    double norms[3], dots[2];
+    for (unsigned threads : {1u, 2u, 4u}){
+        default_parallel_policy().threads = threads;
+        double cur_norms[3] = {norm1(x), norm2(x), norm_inf(x)};
+        double cur_dots[2] = {dot(x, x), dot(s, x)};
+        for (int k = 0; k < 3; k++){
+            if (threads == 1) norms[k] = cur_norms[k]; else EXPECT_EQ(cur_norms[k], norms[k]);
+        }
+        for (int k = 0; k < 2; k++){
+            if (threads == 1) dots[k] = cur_dots[k]; else EXPECT_EQ(cur_dots[k], dots[k]);
+        }
+    }
+    EXPECT_NEAR(dots[0], norms[1] * norms[1], 1e-9 * dots[0]);
+
+    // elementwise operations and compaction of both array storages
+    Vector<double> y = -x;
+    y *= 2.0;
+    y += 1.0;
+    Vector<double> t(s * 3.0);
+    t.set_storage(Vector_storage::SORTED);
+    t -= s * 2.99;       // values 0.01 * s, those below eps are removed in parallel
+    for (int i = 0; i < n; i++){
+        double expected = -2.0 * x(i) + 1.0;
+        EXPECT_EQ(y(i), std::abs(expected) < 0.01 ? 0.0 : expected);
+    }
+    int kept = 0;
+    for (int i = 0; i < n; i += 5){
+        if (i % 11 == 0) continue;      // 3 - 2.99 is slightly less than eps
+        EXPECT_NEAR(t(i), 0.01 * (1.0 + i % 11), 1e-9);
+        kept++;
+    }
+    t.set_storage(Vector_storage::SORTED);
+    EXPECT_EQ(t.get_size(), kept);
+
+    default_parallel_policy() = saved;
+}
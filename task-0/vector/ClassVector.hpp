@@ -4,28 +4,64 @@
 #include<map>
 #include<set>
 #include<string>
+#include<vector>
+#include<cmath>
+#include<algorithm>
+#include<iterator>
+#include<optional>
 
 #include"../rational/ClassRationalNumber.h"
 #include"../complex/ClassComplex.h"
+#include"../complex/Numeric_traits.hpp"
 #include"../matrix/ClassMatrix.h"
+#include"Vector_expressions.hpp"
+#include"Vector_storage.hpp"
+#include"../parallel/Parallel.hpp"
 
 #include"../exceptions/CommonExceptions.hpp"
 #include"../exceptions/VectorExceptions.hpp"
 
-template<class T>
-using vect_vals = std::map<int, T>;
-
 template<class T>
 class Vector{
 private:
     int max_size;
     constexpr static double eps = 0.01;
-    vect_vals<T> values;
+    Vector_storage storage = Vector_storage::TREE;
+    Vector_storage sparse_storage = Vector_storage::TREE;   // storage to return to from DENSE
+    vect_vals<T> values;        // TREE storage
+    Sorted_entries<T> packed;   // SORTED storage
+    std::vector<T> dense_vals;  // DENSE storage, max_size values
+    // sparse -> DENSE when more than dense_threshold of elements are stored, DENSE -> sparse when
+    // less than sparse_threshold are non-zero (the gap prevents switching back and forth)
+    constexpr static double dense_threshold = 0.5;
+    constexpr static double sparse_threshold = 0.25;
+    constexpr static int auto_storage_min_size = 32;     // shorter vectors keep their storage
+    void _convert(Vector_storage new_storage);
+    void _update_storage();
+    size_t _stored_count() const;
     void _clear_fake_vals();    // operator() creates members of unordered_set if key is missing
+    static bool _is_fake(const T& val);     // Numeric_traits<T>::is_zero(val, eps)
+    template<class Pred>
+    void _erase_if(Pred pred);
+    template<class E>
+    static bool _evaluate_sorted_merge(const E& expr, Sorted_entries<T>& res);
+    template<class F>
+    void _for_each_stored(F f);     // f(value&) for all stored values (zeros of DENSE included), in parallel for arrays
+    // non-zero elements as sorted arrays: packed for SORTED vector, copy in scratch otherwise
+    const Sorted_entries<T>& _entries(Sorted_entries<T>& scratch) const;
+    void _add_scaled(const Vector& x, const Linear_scale<T>& scale);    // *this += scale * x in place
+    template<class E>
+    void _add_expression(const E& expr, const Linear_scale<T>& scale);
+    template<class S>
+    void _shift(const S& scalar, bool subtract);                         // scalar +- to all elements
+    template<class U>
+    friend class Vector;
+    friend struct Vector_kernels;
     bool same_shape(const Vector& other) const;
-    vect_vals<T> key_union(const Vector& other) const;
     std::ofstream _open_write_file(const char* filename, bool append = false) const;
 public:
+    using value_type = T;
+
     Vector(int _max_size, bool fill_one = false);
     Vector(int _max_size, const vect_vals<T>&  _values);
     Vector(const Vector& other);
@@ -33,38 +69,53 @@ public:
 
     explicit Vector(const Matrix_proxy<T>& proxy);
 
+    // Constructor from dense array, max_size is dense.size()
+    explicit Vector(const std::vector<T>& dense);
+
     // Constructor from filename
     explicit Vector(const char* file_path);
 
+    // Evaluation of lazy expression (v + w, v * A, v * 2 + w, ...)
+    template<class E, class = std::enable_if_t<is_vector_expression<E>::value>>
+    Vector(const E& expr);
+
+    // missing element is inserted as fake zero value; bounds are checked if TASK0_BOUNDS_CHECK
     T& operator()(int i);
+    // same as operator(), always throws Out_of_range for wrong index
+    T& at(int i);
+    // value (zero if missing) or nullopt if out of range: no insertion, no exceptions
+    std::optional<T> try_get(int i) const;
     Vector& operator=(const Vector& other);
     Vector& operator=(Vector&& other);
+    template<class E, class = std::enable_if_t<is_vector_expression<E>::value>>
+    Vector& operator=(const E& expr);
 
-    template<typename TValueLeft, typename TValueRight>
-    friend Vector<TValueLeft> operator+(Vector<TValueLeft> lhs, Vector<TValueRight> rhs); // return type of left operand
-
-    template<typename TValueLeft, typename TValueRight>
-    friend Vector<TValueLeft> operator-(Vector<TValueLeft> lhs, Vector<TValueRight> rhs); // return type of left operand
+    // vector + vector, vector - vector, vector * scalar, vector * matrix, matrix * vector are lazy (Vector_expressions.hpp)
 
-    Vector operator-();   //unar -
+    Vector operator-() const&;  //unar -
+    Vector operator-() &&;      // negates in place
 
     bool operator==(const Vector& other);       // not implemented
     bool operator!=(const Vector& other);       // not implemented
 
-    template<typename TValueLeft, typename TValueRight>
-    friend Vector<TValueLeft> operator+(Vector<TValueLeft> lhs, TValueRight& rhs);
-
-    template<typename TValueLeft, typename TValueRight>
-    friend Vector<TValueLeft> operator-(Vector<TValueLeft> lhs, const TValueRight& rhs);
-
-    template<typename TValueLeft, typename TValueRight>
-    friend Vector<TValueLeft> operator*(Vector<TValueLeft> lhs, const TValueRight& rhs);
-
-    template<typename TValueLeft, typename TValueRight>
-    friend Vector<TValueLeft> operator/(Vector<TValueLeft> lhs, const TValueRight& rhs);
-
-    // only vector(1xM) * matrix (MxN)
-    Vector<T> operator*(Matrix<T>& rhs);
+    // In-place arithmetic. Vector operand is merged into current storage, lazy expression is
+    // accumulated into it directly (evaluated first if it refers to *this or vector is SORTED).
+    template<class E>
+    std::enable_if_t<is_vector_expression<E>::value || std::is_same<E, Vector>::value, Vector&>
+    operator+=(const E& rhs);
+    template<class E>
+    std::enable_if_t<is_vector_expression<E>::value || std::is_same<E, Vector>::value, Vector&>
+    operator-=(const E& rhs);
+
+    // scalar is added to all max_size elements
+    template<class S>
+    std::enable_if_t<!is_vector_operand_v<S>, Vector&> operator+=(const S& scalar);
+    template<class S>
+    std::enable_if_t<!is_vector_operand_v<S>, Vector&> operator-=(const S& scalar);
+    template<class S>
+    Vector& operator*=(const S& scalar);
+    template<class S>
+    Vector& operator/=(const S& scalar);
 
     std::string to_string();
     static void set_eps(double new_eps);
@@ -72,6 +123,25 @@ public:
 
     int get_max_size() const;
 
+    // Storage is TREE after construction (except evaluation of expression with SORTED
+    // leftmost operand). Vector which is built once and read many times should be SORTED.
+    // Construction, evaluation of expression, scalar +/- and axpy switch vector to DENSE
+    // when more than half of elements are non-zero and back to last sparse storage when
+    // less than quarter is (vectors shorter than 32 elements are not switched automatically).
+    void set_storage(Vector_storage new_storage);
+    Vector_storage get_storage() const;
+
+    // f(index, value) for stored values in increasing order of indices
+    // (may include fake zero values created by operator())
+    template<class F>
+    void for_each_value(F f) const;
+
+    // all max_size values as dense array (missing values are zero)
+    std::vector<T> to_dense() const;
+    // replaces values by dense array of max_size values without eps filtering (only exact
+    // zeros are dropped), e.g. for results of solvers; throws Shape_error if sizes differ
+    void assign_dense(std::vector<T> dense);
+
     //non-zero elements
     int get_size();
 
@@ -84,10 +154,14 @@ public:
 template<class T>
 Vector<T>::Vector(int _max_size, bool fill_one):
     max_size(_max_size){
-    if (fill_one){
-        for (int i = 0; i < max_size; i++)
-            values[i] = std::move(T(1));
+    if (!fill_one) return;
+    if (max_size >= auto_storage_min_size){
+        storage = Vector_storage::DENSE;
+        dense_vals.assign(max_size, T(1));
+        return;
     }
+    for (int i = 0; i < max_size; i++)
+        values[i] = std::move(T(1));
 }
 
 template<class T>
@@ -98,36 +172,31 @@ Vector<T>::Vector(int _max_size, const vect_vals<T>&  _values):
         if (!(pos < max_size)){
             throw Init_error("Position in vector must be less than max_size, got: ", std::to_string((pos)));
         }
-        if (!(abs(elem.second) < eps)){
+        if (!Numeric_traits<T>::is_zero(elem.second, eps)){
             values[pos] = elem.second;
         }
     }
-}
-
-template<>
-Vector<Complex_number<>>::Vector(int _max_size, const vect_vals<Complex_number<>>&  _values):
-    max_size(_max_size){
-    for (const auto& elem : _values){
-        int pos = elem.first;
-        if (!(pos < max_size)){
-            throw Init_error("Position in vector must be less than max_size, got: ", std::to_string((pos)));
-        }
-        if (!(elem.second.module_square() < eps * eps)){
-            values[elem.first] = elem.second;
-        }
-    }
+    _update_storage();
 }
 
 template<class T>
 Vector<T>::Vector(const Vector& other){
     max_size = other.max_size;
+    storage = other.storage;
+    sparse_storage = other.sparse_storage;
     values = other.values;
+    packed = other.packed;
+    dense_vals = other.dense_vals;
 }
 
 template<class T>
 Vector<T>::Vector(Vector&& other){
     max_size = std::move(other.max_size);
+    storage = other.storage;
+    sparse_storage = other.sparse_storage;
     values = std::move(other.values);
+    packed = std::move(other.packed);
+    dense_vals = std::move(other.dense_vals);
 }
 
 template<class T>
@@ -138,6 +207,48 @@ Vector<T>::Vector(const Matrix_proxy<T>& proxy){
     max_size = std::max(proxy.get_dim().first, proxy.get_dim().second);
     values = proxy.get_values_as_map();
     _clear_fake_vals();     // since precision in vector and matrix can differ;
+    _update_storage();
+}
+
+template<class T>
+Vector<T>::Vector(const std::vector<T>& dense):
+    max_size(dense.size()){
+    if (max_size >= auto_storage_min_size){
+        storage = Vector_storage::DENSE;
+        dense_vals = dense;
+        _clear_fake_vals();
+        _update_storage();
+        return;
+    }
+    const T zero((long) 0);
+    for (int i = 0; i < max_size; i++){
+        if (!(dense[i] == zero)){
+            values.emplace_hint(values.end(), i, dense[i]);
+        }
+    }
+    _clear_fake_vals();
+}
+
+template<class T>
+template<class E, class>
+Vector<T>::Vector(const E& expr):
+    max_size(expr.get_max_size()), storage(expr.get_storage()){
+    if (storage == Vector_storage::SORTED){
+        sparse_storage = Vector_storage::SORTED;
+    }
+    if (storage == Vector_storage::SORTED && _evaluate_sorted_merge(expr, packed)){
+        // merged in place
+    } else if (storage == Vector_storage::DENSE){
+        dense_vals = _evaluate_vector_expression_dense<T>(expr);
+    } else {
+        values = _evaluate_vector_expression<T>(expr);
+        if (storage == Vector_storage::SORTED){
+            storage = Vector_storage::TREE;
+            _convert(Vector_storage::SORTED);
+        }
+    }
+    _clear_fake_vals();
+    _update_storage();
 }
 
 template<class T>
@@ -161,10 +272,11 @@ Vector<Rational_number>::Vector(const char* file_path){
             throw Init_error("Position in vector must be less than max_size, got: ", std::to_string((pos)));
         }
         Rational_number val(elem.second.first, elem.second.second);
-        if (!(abs(val) < eps)){
+        if (!Numeric_traits<Rational_number>::is_zero(val, eps)){
             values[pos] = val;
         }
     }
+    _update_storage();
 }
 
 template<>
@@ -183,10 +295,11 @@ Vector<Complex_number<>>::Vector(const char* file_path){
             throw Init_error("Position in vector must be less than max_size, got: ", std::to_string((pos)));
         }
         Complex_number<> val(std::stod(elem.second.first), std::stod(elem.second.second));
-        if (!(val.module_square() < eps * eps)){
+        if (!Numeric_traits<Complex_number<>>::is_zero(val, eps)){
             values[pos] = val;
         }
     }
+    _update_storage();
 }
 
 //////////////////////////////////
@@ -200,10 +313,44 @@ Vector<Complex_number<>>::Vector(const char* file_path){
 // They are cleared internally with call of some methods.
 template<class T>
 T& Vector<T>::operator()(int i){
-    if (!(0<= i < max_size)){
-        throw Out_of_range("Trying to access element by out of range index: ", std::to_string(i));
-    } 
-    return values[i];
+#if TASK0_BOUNDS_CHECK
+    if (static_cast<unsigned>(i) >= static_cast<unsigned>(max_size)){
+        _throw_out_of_range(i);
+    }
+#endif
+    if (storage == Vector_storage::SORTED){
+        return packed.get_or_insert(i);     // binary search, insertion shifts tail
+    }
+    if (storage == Vector_storage::DENSE){
+        return dense_vals[i];
+    }
+    auto res = values.try_emplace(i);
+    TASK0_STAT(FAKE_INSERTS, res.second);
+    return res.first->second;
+}
+
+template<class T>
+T& Vector<T>::at(int i){
+    if (static_cast<unsigned>(i) >= static_cast<unsigned>(max_size)){
+        _throw_out_of_range(i);
+    }
+    return this->operator()(i);
+}
+
+template<class T>
+std::optional<T> Vector<T>::try_get(int i) const{
+    if (static_cast<unsigned>(i) >= static_cast<unsigned>(max_size)){
+        return std::nullopt;
+    }
+    if (storage == Vector_storage::DENSE){
+        return dense_vals[i];
+    }
+    if (storage == Vector_storage::SORTED){
+        long pos = packed.find(i);
+        return pos < 0 ? T((long) 0) : packed.vals[pos];
+    }
+    auto it = values.find(i);
+    return it == values.end() ? T((long) 0) : it->second;
 }
 
 template<class T>
@@ -211,7 +358,11 @@ Vector<T>& Vector<T>::operator=(const Vector& other){
     if (!same_shape(other)){
         throw Shape_error("Wrong shapes for operator '-': ", max_size, other.max_size);
     }
+    storage = other.storage;
+    sparse_storage = other.sparse_storage;
     values = other.values;
+    packed = other.packed;
+    dense_vals = other.dense_vals;
     return *this;
 }
 
@@ -220,163 +371,198 @@ Vector<T>& Vector<T>::operator=(Vector&& other){
     if (!same_shape(other)){
         throw Shape_error("Wrong shapes for operator '-': ", max_size, other.max_size);
     }
+    storage = other.storage;
+    sparse_storage = other.sparse_storage;
     values = std::move(other.values);
+    packed = std::move(other.packed);
+    dense_vals = std::move(other.dense_vals);
     return *this;
 }
 
-// return type of left operand
-template<typename TValueLeft, typename TValueRight>
-Vector<TValueLeft> operator+(Vector<TValueLeft> lhs, Vector<TValueRight> rhs){ // return type of left operand{
-    if (!lhs.same_shape(rhs)){
-        throw Shape_error("Wrong shapes for operator '+': ", lhs.max_size, rhs.max_size);
-    }
-    decltype(lhs.values) tmp_vals = lhs.key_union(rhs);
-    for (const auto& elem : tmp_vals){
-        tmp_vals[elem.first] = lhs.values[elem.first] + rhs.values[elem.first];
+template<class T>
+template<class E, class>
+Vector<T>& Vector<T>::operator=(const E& expr){
+    if (max_size != expr.get_max_size()){
+        throw Shape_error("Wrong shapes for operator '=': ", max_size, expr.get_max_size());
+    }
+    // operands may alias *this, so values are replaced at once
+    Vector_storage target = storage;
+    Sorted_entries<T> merged;
+    if (target == Vector_storage::SORTED && _evaluate_sorted_merge(expr, merged)){
+        packed = std::move(merged);
+    } else if (target == Vector_storage::DENSE){
+        dense_vals = _evaluate_vector_expression_dense<T>(expr);
+    } else {
+        values = _evaluate_vector_expression<T>(expr);
+        storage = Vector_storage::TREE;
+        _convert(target);
     }
-    Vector<TValueLeft> res(lhs.max_size, tmp_vals);
-
-    return res;
+    _clear_fake_vals();
+    _update_storage();
+    return *this;
 }
 
-// return type of left operand
-template<typename TValueLeft, typename TValueRight>
-Vector<TValueLeft> operator-(Vector<TValueLeft> lhs, Vector<TValueRight> rhs){
-    if (!lhs.same_shape(rhs)){
-        throw Shape_error("Wrong shapes for operator '-': ", lhs.max_size, rhs.max_size);
-    }
-    decltype(lhs.values) tmp_vals = lhs.key_union(rhs);
-    for (const auto& elem : tmp_vals){
-        tmp_vals[elem.first] = lhs.values[elem.first] - rhs.values[elem.first];
-    }
-    Vector<TValueLeft> res(lhs.max_size, tmp_vals);
+// unar -
+template<class T>
+Vector<T> Vector<T>::operator-() const&{
+    Vector<T> copy(*this);
+    copy._for_each_stored([](T& val){ val = -val; });
+    return copy;
+}
 
-    return res;
+template<class T>
+Vector<T> Vector<T>::operator-() &&{
+    _for_each_stored([](T& val){ val = -val; });
+    return std::move(*this);
 }
 
-// unar -
 template<class T>
-Vector<T> Vector<T>::operator-(){
-    Vector<T> copy(*this);
-    for(auto& elem : copy.values){
-        elem.second = -elem.second;
+template<class E>
+std::enable_if_t<is_vector_expression<E>::value || std::is_same<E, Vector<T>>::value, Vector<T>&>
+Vector<T>::operator+=(const E& rhs){
+    if (max_size != rhs.get_max_size()){
+        throw Shape_error("Wrong shapes for operator '+=': ", max_size, rhs.get_max_size());
     }
-    return copy;
+    _add_expression(rhs, Linear_scale<T>());
+    return *this;
 }
 
-template<typename TValueLeft, typename TValueRight>
-Vector<TValueLeft> operator+(Vector<TValueLeft> lhs, const TValueRight& rhs){
-    Vector<TValueLeft> res(lhs);
-    for (int i = 0; i < res.max_size; i ++) {
-        res.values[i] += rhs;
+template<class T>
+template<class E>
+std::enable_if_t<is_vector_expression<E>::value || std::is_same<E, Vector<T>>::value, Vector<T>&>
+Vector<T>::operator-=(const E& rhs){
+    if (max_size != rhs.get_max_size()){
+        throw Shape_error("Wrong shapes for operator '-=': ", max_size, rhs.get_max_size());
     }
+    _add_expression(rhs, Linear_scale<T>().negated());
+    return *this;
+}
 
-    res._clear_fake_vals();
-    return res;
+template<class T>
+template<class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>&> Vector<T>::operator+=(const S& scalar){
+    _shift(scalar, false);
+    return *this;
 }
 
-template<typename TValueLeft, typename TValueRight>
-Vector<TValueLeft> operator-(Vector<TValueLeft> lhs, const TValueRight& rhs){
-    Vector<TValueLeft> res(lhs);
-    for (int i = 0; i < res.max_size; i ++) {
-        res.values[i] -= rhs;
-    }
-    res._clear_fake_vals();
-    return res;
+template<class T>
+template<class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>&> Vector<T>::operator-=(const S& scalar){
+    _shift(scalar, true);
+    return *this;
 }
 
-template<typename TValueLeft, typename TValueRight>
-Vector<TValueLeft> operator*(Vector<TValueLeft> lhs, const TValueRight& rhs){
-    if (rhs == TValueRight((int) 0)){
-        return Vector<TValueLeft>(lhs);
-    }
-    Vector<TValueLeft> res(lhs);
-    for (auto& elem : res.values) {
-        elem.second *= rhs;
+template<class T>
+template<class S>
+Vector<T>& Vector<T>::operator*=(const S& scalar){
+    _for_each_stored([&scalar](T& val){ val *= scalar; });
+    _clear_fake_vals();
+    _update_storage();
+    return *this;
+}
+
+template<class T>
+template<class S>
+Vector<T>& Vector<T>::operator/=(const S& scalar){
+    if (scalar == S((int) 0)){
+        throw Zero_division("Zero division (vector / number)!");
     }
+    _for_each_stored([&scalar](T& val){ val /= scalar; });
+    _clear_fake_vals();
+    _update_storage();
+    return *this;
+}
 
-    res._clear_fake_vals();
+// vector + scalar: scalar is added to all max_size elements
+template<class T, class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>> operator+(const Vector<T>& lhs, const S& rhs){
+    Vector<T> res(lhs);
+    res += rhs;
     return res;
 }
 
-template<typename TValueLeft, typename TValueRight>
-Vector<TValueLeft> operator/(Vector<TValueLeft> lhs, const TValueRight& rhs){
-    if (rhs == TValueRight((int) 0)){
-        throw Zero_division("Zero division (vector / number)!");
-    }
-    Vector<TValueLeft> res(lhs);
-    for (auto& elem : res.values) {
-        elem.second /= rhs;
-    }
-    return lhs;
+// storage of temporary vector is reused: (v * 2 + w) + 1, std::move(v) + 1
+template<class T, class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>> operator+(Vector<T>&& lhs, const S& rhs){
+    lhs += rhs;
+    return std::move(lhs);
 }
 
-// vector (1xM) * matrix (MxN), res is linear sum of matrix rows
-template<class T>
-Vector<T> Vector<T>::operator*(Matrix<T>& matrix){
-    if (max_size != matrix.get_rows_number()){
-        std::pair<int, int> matr_shape(matrix.get_rows_number(), matrix.get_columns_number());
-        throw Shape_error("Wrong shapes for (vector * matrix): ", {1, max_size}, matr_shape);
-    }
-    Vector<T> res(matrix.get_columns_number());    // 1xN
-    for(const auto& vec_val : values){                  
-        int row_number = vec_val.first;
-        T val = vec_val.second;
-        Vector<T> tmp_vec(matrix[Matrix_row_coord(row_number)]);
-        res = res + (tmp_vec * val);
-    }
+template<class T, class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>> operator-(const Vector<T>& lhs, const S& rhs){
+    Vector<T> res(lhs);
+    res -= rhs;
+    return res;
+}
+
+template<class T, class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>> operator-(Vector<T>&& lhs, const S& rhs){
+    lhs -= rhs;
+    return std::move(lhs);
+}
 
-    res._clear_fake_vals();
+template<class T, class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>> operator/(const Vector<T>& lhs, const S& rhs){
+    Vector<T> res(lhs);
+    res /= rhs;
     return res;
 }
 
+template<class T, class S>
+std::enable_if_t<!is_vector_operand_v<S>, Vector<T>> operator/(Vector<T>&& lhs, const S& rhs){
+    lhs /= rhs;
+    return std::move(lhs);
+}
+
 //////////////////////////////////
 
 // Methods
 //////////////////////////////////
 
-// operator() creates members of map if key is missing.
-// We need to return reference to any value (even if missing) since we can't 
-// predict if we read or set an element, so we sometimes create fake elements.
-// This function removes them.
+// remove values with pred(value) == true from current storage
 template<class T>
-void Vector<T>::_clear_fake_vals(){
-    std::set<int> to_delete;
-    for(auto it = values.begin(); it != values.end(); it++){
-        if (abs(it->second) < eps)
-            to_delete.insert(it->first);
-    }
-
-    for (auto& key : to_delete) {
-        values.erase(key);
+template<class Pred>
+void Vector<T>::_erase_if(Pred pred){
+    if (storage == Vector_storage::SORTED){
+        packed.erase_if(pred);
+        return;
+    }
+    if (storage == Vector_storage::DENSE){
+        const T zero((long) 0);
+        parallel_for(dense_vals.size(), [&](size_t begin, size_t end){
+            for (size_t k = begin; k < end; k++){
+                dense_vals[k] = pred(dense_vals[k]) ? zero : dense_vals[k];    // select, no branch
+            }
+        });
+        return;
+    }
+    for(auto it = values.begin(); it != values.end(); ){
+        if (pred(it->second)){
+            it = values.erase(it);
+        } else {
+            it++;
+        }
     }
 }
 
-template<>
-void Vector<Complex_number<>>::_clear_fake_vals(){
-    std::set<int> to_delete;
-    for(auto it = values.begin(); it != values.end(); it++){
-        if (it->second.module_square() < eps * eps)
-            to_delete.insert(it->first);
-    }
-
-    for (auto& key : to_delete) {
-        values.erase(key);
-    }
+template<class T>
+bool Vector<T>::_is_fake(const T& val){
+    return Numeric_traits<T>::is_zero(val, eps);
 }
 
-template<>
-void Vector<Rational_number>::_clear_fake_vals(){
-    Rational_number rat_eps = Rational_number::from_double(eps);
-    std::set<int> to_delete;
-    for(auto it = values.begin(); it != values.end(); it++){
-        if (abs(it->second) < rat_eps){
-            to_delete.insert(it->first);
-        }
-    }
-    for (auto& key : to_delete) {
-        values.erase(key);
+// operator() creates members of map if key is missing.
+// We need to return reference to any value (even if missing) since we can't 
+// predict if we read or set an element, so we sometimes create fake elements.
+// This function removes them.
+// exact types have no fake values in DENSE storage: values are zero or not
+template<class T>
+void Vector<T>::_clear_fake_vals(){
+    if constexpr (Numeric_traits<T>::exact){
+        if (storage == Vector_storage::DENSE) return;
     }
+    [[maybe_unused]] size_t before = stats_enabled ? _stored_count() : 0;
+    _erase_if(_is_fake);
+    TASK0_STAT(FAKE_REMOVALS, before - _stored_count());
 }
 
 template<class T>
@@ -384,9 +570,9 @@ std::string Vector<T>::to_string(){
     _clear_fake_vals();
     std::string res("vector ");
     res = res + typeid(T).name() + " " + std::to_string(max_size) + "\n";
-    for (const auto& elem: values){
-        res = res + "\n" + std::to_string(elem.first) + " " + std::to_string(elem.second);
-    }
+    for_each_value([&res](int idx, const T& val){
+        res = res + "\n" + std::to_string(idx) + " " + std::to_string(val);
+    });
     return res;
 }
 
@@ -395,9 +581,9 @@ std::string Vector<Rational_number>::to_string(){
     _clear_fake_vals();
     std::string res("vector rational ");
     res = res + std::to_string(max_size) + "\n";
-    for (const auto& elem: values){
-        res = res + "\n" + std::to_string(elem.first) + " " + elem.second.to_string();
-    }
+    for_each_value([&res](int idx, const auto& val){
+        res = res + "\n" + std::to_string(idx) + " " + val.to_string();
+    });
     return res;
 }
 
@@ -406,9 +592,9 @@ std::string Vector<Complex_number<>>::to_string(){
     _clear_fake_vals();
     std::string res("matrix complex ");
     res = res + std::to_string(max_size) + "\n";
-    for (const auto& elem: values){
-        res = res + "\n" + std::to_string(elem.first) + " " + elem.second.to_string();
-    }
+    for_each_value([&res](int idx, const auto& val){
+        res = res + "\n" + std::to_string(idx) + " " + val.to_string();
+    });
     return res;
 }
 
@@ -417,6 +603,284 @@ int Vector<T>::get_max_size() const{
     return max_size;
 }
 
+template<class T>
+void Vector<T>::set_storage(Vector_storage new_storage){
+    if (new_storage != Vector_storage::DENSE){
+        sparse_storage = new_storage;
+    }
+    _convert(new_storage);
+}
+
+template<class T>
+void Vector<T>::_convert(Vector_storage new_storage){
+    if (new_storage == storage) return;
+    TASK0_STAT(ALLOCATIONS, 1);
+    TASK0_STAT(BYTES_MOVED, _stored_count() * sizeof(T));
+    if (new_storage == Vector_storage::DENSE){
+        dense_vals.assign(max_size, T((long) 0));
+        for_each_value([this](int idx, const T& val){
+            dense_vals[idx] = val;
+        });
+        values.clear();
+        packed.clear();
+    } else if (storage == Vector_storage::DENSE){
+        const T zero((long) 0);
+        for (int i = 0; i < max_size; i++){
+            if (dense_vals[i] == zero) continue;
+            if (new_storage == Vector_storage::SORTED){
+                packed.push_back(i, std::move(dense_vals[i]));
+            } else {
+                values.emplace_hint(values.end(), i, std::move(dense_vals[i]));
+            }
+        }
+        std::vector<T>().swap(dense_vals);
+    } else if (new_storage == Vector_storage::SORTED){
+        packed.clear();
+        packed.indices.reserve(values.size());
+        packed.vals.reserve(values.size());
+        for (auto& elem : values){
+            packed.push_back(elem.first, std::move(elem.second));
+        }
+        values.clear();
+    } else {
+        for (size_t k = 0; k < packed.size(); k++){
+            values.emplace_hint(values.end(), packed.indices[k], std::move(packed.vals[k]));
+        }
+        packed.clear();
+    }
+    storage = new_storage;
+}
+
+template<class T>
+size_t Vector<T>::_stored_count() const{
+    if (storage == Vector_storage::SORTED) return packed.size();
+    if (storage == Vector_storage::TREE) return values.size();
+    const T zero((long) 0);
+    return parallel_reduce(dense_vals.size(), size_t(0), [&](size_t begin, size_t end){
+        return static_cast<size_t>(std::count_if(dense_vals.begin() + begin, dense_vals.begin() + end,
+                                                 [&zero](const T& val){ return !(val == zero); }));
+    }, [](size_t a, size_t b){ return a + b; });
+}
+
+template<class T>
+void Vector<T>::_update_storage(){
+    if (max_size < auto_storage_min_size) return;
+    size_t stored = _stored_count();
+    if (storage != Vector_storage::DENSE && stored > dense_threshold * max_size){
+        _convert(Vector_storage::DENSE);
+    } else if (storage == Vector_storage::DENSE && stored < sparse_threshold * max_size){
+        _convert(sparse_storage);
+    }
+}
+
+template<class T>
+template<class F>
+void Vector<T>::_for_each_stored(F f){
+    for (auto& elem : values){
+        f(elem.second);
+    }
+    for (std::vector<T>* arr : {&packed.vals, &dense_vals}){
+        parallel_for(arr->size(), [&](size_t begin, size_t end){
+            for (size_t k = begin; k < end; k++){
+                f((*arr)[k]);
+            }
+        });
+    }
+}
+
+template<class T>
+const Sorted_entries<T>& Vector<T>::_entries(Sorted_entries<T>& scratch) const{
+    if (storage == Vector_storage::SORTED){
+        return packed;
+    }
+    scratch.clear();
+    scratch.indices.reserve(_stored_count());
+    scratch.vals.reserve(_stored_count());
+    for_each_value([&scratch](int idx, const T& val){
+        scratch.push_back(idx, val);
+    });
+    return scratch;
+}
+
+// TREE: values of x are inserted with hints (indices are increasing).
+// SORTED: x is merged into arrays from the end, arrays are reallocated only if they grow.
+// DENSE (or DENSE x): values are added in place.
+// Values which become less than eps are removed.
+template<class T>
+void Vector<T>::_add_scaled(const Vector& x, const Linear_scale<T>& scale){
+    if (&x == this){
+        Vector<T> copy(x);
+        _add_scaled(copy, scale);
+        return;
+    }
+    const T zero((long) 0);
+    if (x.storage == Vector_storage::DENSE){
+        _convert(Vector_storage::DENSE);    // result is dense as well
+    }
+    if (storage == Vector_storage::DENSE){
+        x.for_each_value([&](int idx, const T& val){
+            T& dst = dense_vals[idx];
+            scale.add_to(dst, val);
+            if (_is_fake(dst)) dst = zero;
+        });
+        if (x.storage == Vector_storage::DENSE) _update_storage();
+        return;
+    }
+    if (storage == Vector_storage::TREE){
+        auto hint = values.begin();
+        x.for_each_value([&](int idx, const T& val){
+            hint = values.try_emplace(hint, idx, zero);  // indices are increasing, no node for existing key
+            scale.add_to(hint->second, val);
+            hint = _is_fake(hint->second) ? values.erase(hint) : std::next(hint);
+        });
+        _update_storage();
+        return;
+    }
+
+    Sorted_entries<T> scratch;
+    const Sorted_entries<T>& xs = x._entries(scratch);
+    // number of indices of x missing in *this
+    size_t missing = 0, j = 0;
+    for (size_t i = 0; i < xs.size(); i++){
+        j = _gallop(packed.indices.data(), j, packed.size(), xs.indices[i]);
+        if (j == packed.size() || packed.indices[j] != xs.indices[i]) missing++;
+    }
+    // merge from the end into grown arrays: every element is moved at most once
+    size_t i = xs.size(), k = packed.size(), out = packed.size() + missing;
+    packed.indices.resize(out);
+    packed.vals.resize(out, zero);
+    while (i > 0){
+        out--;
+        if (k > 0 && packed.indices[k - 1] >= xs.indices[i - 1]){
+            k--;
+            packed.indices[out] = packed.indices[k];
+            packed.vals[out] = std::move(packed.vals[k]);
+            if (packed.indices[out] == xs.indices[i - 1]){
+                i--;
+                scale.add_to(packed.vals[out], xs.vals[i]);
+            }
+        } else {
+            i--;
+            packed.indices[out] = xs.indices[i];
+            packed.vals[out] = zero;
+            scale.add_to(packed.vals[out], xs.vals[i]);
+        }
+    }
+    packed.erase_if(_is_fake);
+    _update_storage();
+}
+
+template<class T>
+template<class E>
+void Vector<T>::_add_expression(const E& expr, const Linear_scale<T>& scale){
+    if constexpr (is_vector<E>::value){
+        _add_scaled(expr, scale);
+    } else {
+        // insertion into sorted arrays shifts tail, and accumulation into *this must not
+        // change operands: expression is evaluated first
+        if (storage == Vector_storage::SORTED || expr.depends_on(this)){
+            _add_scaled(Vector<T>(expr), scale);
+            return;
+        }
+        if (storage == Vector_storage::DENSE){
+            _accumulate(expr, dense_vals, scale);
+        } else {
+            _accumulate(expr, values, scale);
+        }
+        _clear_fake_vals();
+        _update_storage();
+    }
+}
+
+template<class T>
+template<class S>
+void Vector<T>::_shift(const S& scalar, bool subtract){
+    Vector_storage mode = storage;
+    _convert(Vector_storage::DENSE);        // all positions are filled
+    parallel_for(dense_vals.size(), [&](size_t begin, size_t end){
+        for (size_t k = begin; k < end; k++){
+            if (subtract) dense_vals[k] -= scalar; else dense_vals[k] += scalar;
+        }
+    });
+    _clear_fake_vals();
+    if (max_size < auto_storage_min_size){
+        _convert(mode);
+    } else {
+        _update_storage();
+    }
+}
+
+// lhs +- rhs for two SORTED vectors is evaluated by linear merge, false for other expressions
+template<class T>
+template<class E>
+bool Vector<T>::_evaluate_sorted_merge(const E& expr, Sorted_entries<T>& res){
+    if constexpr (is_vector_sum<E>::value){
+        const auto& lhs = expr.get_lhs();
+        const auto& rhs = expr.get_rhs();
+        if constexpr (is_vector<std::decay_t<decltype(lhs)>>::value && is_vector<std::decay_t<decltype(rhs)>>::value){
+            if (lhs.storage == Vector_storage::SORTED && rhs.storage == Vector_storage::SORTED){
+                Sorted_entries<T>::merge(lhs.packed, rhs.packed, expr.is_subtraction(), res);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template<class T>
+Vector_storage Vector<T>::get_storage() const{
+    return storage;
+}
+
+template<class T>
+template<class F>
+void Vector<T>::for_each_value(F f) const{
+    if (storage == Vector_storage::SORTED){
+        const int* indices = packed.indices.data();
+        const T* vals = packed.vals.data();
+        for (size_t k = 0; k < packed.size(); k++){
+            f(indices[k], vals[k]);
+        }
+    } else if (storage == Vector_storage::DENSE){
+        const T zero((long) 0);
+        for (int i = 0; i < max_size; i++){
+            if (!(dense_vals[i] == zero)) f(i, dense_vals[i]);
+        }
+    } else {
+        for (const auto& elem : values){
+            f(elem.first, elem.second);
+        }
+    }
+}
+
+template<class T>
+std::vector<T> Vector<T>::to_dense() const{
+    if (storage == Vector_storage::DENSE){
+        return dense_vals;
+    }
+    std::vector<T> dense(max_size, T((long) 0));
+    for_each_value([&dense](int idx, const T& val){
+        dense[idx] = val;
+    });
+    return dense;
+}
+
+template<class T>
+void Vector<T>::assign_dense(std::vector<T> dense){
+    if (static_cast<int>(dense.size()) != max_size){
+        throw Shape_error("Wrong shapes for dense assignment: ", max_size, (int) dense.size());
+    }
+    values.clear();
+    packed.clear();
+    dense_vals = std::move(dense);
+    storage = Vector_storage::DENSE;
+    if (max_size < auto_storage_min_size){
+        _convert(sparse_storage);
+    } else {
+        _update_storage();
+    }
+}
+
 template<class T>
 double Vector<T>::get_eps(){
     return eps;
@@ -425,7 +889,7 @@ double Vector<T>::get_eps(){
 template<class T>
 int Vector<T>::get_size(){
     _clear_fake_vals();
-    return values.size();
+    return _stored_count();
 }
 
 template<class T>
@@ -438,16 +902,6 @@ bool Vector<T>::same_shape(const Vector& other) const{
     return max_size == other.max_size;
 }
 
-// union of keys, values are "random"
-template<class T>
-vect_vals<T> Vector<T>::key_union(const Vector& other) const{
-    vect_vals<T> tmp_vals = values;
-    for (const auto& elem: other.values){
-        tmp_vals[elem.first] = elem.second;
-    }
-    return tmp_vals;
-}
-
 template<class T>
 std::ofstream Vector<T>::_open_write_file(const char* filename, bool append) const{
     std::ofstream file_data;
@@ -469,9 +923,9 @@ void Vector<T>::to_file(const char* filename, bool append){
 
     std::string res("vector ");
     res = res + typeid(T).name() + " " + std::to_string(max_size) + "\n";
-    for (const auto& elem: values){
-        res = res + "\n" + std::to_string(elem.first + 1) + "  " + std::to_string(elem.second);
-    }
+    for_each_value([&res](int idx, const T& val){
+        res = res + "\n" + std::to_string(idx + 1) + "  " + std::to_string(val);
+    });
 
     file_data << res;
     //if (file_data.fail()) throw 12; //todo: exceptions
@@ -485,9 +939,9 @@ void Vector<Rational_number>::to_file(const char* filename, bool append){
 
     std::string res("vector rational ");
     res = res + std::to_string(max_size) + "\n";
-    for (const auto& elem: values){
-        res = res + "\n" + std::to_string(elem.first + 1) + "  " + elem.second.to_string();
-    }
+    for_each_value([&res](int idx, const auto& val){
+        res = res + "\n" + std::to_string(idx + 1) + "  " + val.to_string();
+    });
 
     file_data << res;
     //if (file_data.fail()) throw 12; //todo: exceptions
@@ -501,9 +955,9 @@ void Vector<Complex_number<>>::to_file(const char* filename, bool append){
 
     std::string res("vector complex ");
     res = res + std::to_string(max_size) + "\n";
-    for (const auto& elem: values){
-        res = res + "\n" + std::to_string(elem.first + 1) + "  " + elem.second.to_string();
-    }
+    for_each_value([&res](int idx, const auto& val){
+        res = res + "\n" + std::to_string(idx + 1) + "  " + val.to_string();
+    });
 
     file_data << res;
     //if (file_data.fail()) throw 12; //todo: exceptions
@@ -0,0 +1,395 @@
+/**
+ * @file Vector_expressions.hpp
+ * @brief Lazy (expression template) arithmetic for Vector
+ */
+
+#ifndef __VectorExpressions_H__
+#define __VectorExpressions_H__
+
+#include <map>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+#include "../matrix/Matrix_expressions.hpp"
+#include "Vector_storage.hpp"
+#include "../exceptions/CommonExceptions.hpp"
+
+template<class T>
+class Vector;
+
+template<class T>
+using vect_vals = std::map<int, T>;
+
+/**
+ * @brief Base of all lazy vector expressions (CRTP).
+ *
+ * Same scheme as for matrices (Matrix_expressions.hpp): vector + vector, vector - vector,
+ * vector * scalar, vector * matrix, matrix * vector build nodes, which are accumulated into one map
+ * (or one dense array, if result is DENSE) on assignment. Leaves are stored by reference.
+ *
+ * Every node provides value_type, get_max_size(), get_storage() (storage of leftmost leaf,
+ * it is storage of evaluated vector), depends_on(vec) (vec is one of leaves) and
+ * accumulate(acc, scale): acc += scale * node, acc is vect_vals<U> or std::vector<U>
+ * of max_size values.
+ */
+template<class E>
+struct Vector_expression{
+    const E& derived() const{
+        return static_cast<const E&>(*this);
+    }
+};
+
+template<class E>
+struct is_vector: std::false_type {};
+
+template<class T>
+struct is_vector<Vector<T>>: std::true_type {};
+
+template<class E>
+struct is_vector_expression: std::is_base_of<Vector_expression<E>, E> {};
+
+template<class E>
+constexpr bool is_vector_operand_v = is_vector<E>::value || is_vector_expression<E>::value;
+
+template<class E>
+using vector_operand_t = std::conditional_t<is_vector<E>::value, const E&, const E>;
+
+// Accumulation of operands
+//////////////////////////////////
+
+template<class U, class T>
+void _accumulate(const Vector<T>& vec, vect_vals<U>& acc, const Linear_scale<U>& scale){
+    auto hint = acc.begin();
+    vec.for_each_value([&](int idx, const T& val){
+        hint = acc.try_emplace(hint, idx, U((long) 0));    // indices are increasing, no node for existing key
+        scale.add_to(hint->second, val);
+        hint++;
+    });
+}
+
+template<class U, class T>
+void _accumulate(const Vector<T>& vec, std::vector<U>& acc, const Linear_scale<U>& scale){
+    vec.for_each_value([&](int idx, const T& val){
+        scale.add_to(acc[idx], val);
+    });
+}
+
+// copy of vector values (start of accumulation)
+template<class T>
+vect_vals<T> _vector_values(const Vector<T>& vec){
+    vect_vals<T> res;
+    vec.for_each_value([&res](int idx, const T& val){
+        res.emplace_hint(res.end(), idx, val);
+    });
+    return res;
+}
+
+template<class Acc, class U, class E, class = std::enable_if_t<is_vector_expression<E>::value>>
+void _accumulate(const E& expr, Acc& acc, const Linear_scale<U>& scale){
+    expr.accumulate(acc, scale);
+}
+
+template<class T>
+bool _depends_on(const Vector<T>& vec, const void* target){
+    return static_cast<const void*>(&vec) == target;
+}
+
+template<class E, class = std::enable_if_t<is_vector_expression<E>::value>>
+bool _depends_on(const E& expr, const void* target){
+    return expr.depends_on(target);
+}
+
+template<class T>
+const Vector<T>& _materialize_vector(const Vector<T>& vec){
+    return vec;
+}
+
+template<class E, class = std::enable_if_t<is_vector_expression<E>::value>>
+Vector<typename E::value_type> _materialize_vector(const E& expr){
+    return Vector<typename E::value_type>(expr);
+}
+
+//////////////////////////////////
+
+// Expression nodes
+//////////////////////////////////
+
+// lhs + rhs or lhs - rhs, value type of left operand
+template<class L, class R>
+class Vector_sum: public Vector_expression<Vector_sum<L, R>>{
+private:
+    vector_operand_t<L> lhs;
+    vector_operand_t<R> rhs;
+    bool subtract;
+public:
+    using value_type = typename L::value_type;
+
+    Vector_sum(const L& _lhs, const R& _rhs, bool _subtract): lhs(_lhs), rhs(_rhs), subtract(_subtract) {};
+
+    int get_max_size() const { return lhs.get_max_size(); }
+    Vector_storage get_storage() const { return lhs.get_storage(); }
+    const L& get_lhs() const { return lhs; }
+    const R& get_rhs() const { return rhs; }
+    bool is_subtraction() const { return subtract; }
+    bool depends_on(const void* target) const { return _depends_on(lhs, target) || _depends_on(rhs, target); }
+
+    template<class Acc, class U>
+    void accumulate(Acc& acc, const Linear_scale<U>& scale) const{
+        _accumulate(lhs, acc, scale);
+        _accumulate(rhs, acc, subtract ? scale.negated() : scale);
+    }
+};
+
+// -expr (unary minus of a leaf is computed eagerly by Vector::operator-)
+template<class E>
+class Vector_negate: public Vector_expression<Vector_negate<E>>{
+private:
+    vector_operand_t<E> expr;
+public:
+    using value_type = typename E::value_type;
+
+    explicit Vector_negate(const E& _expr): expr(_expr) {};
+
+    int get_max_size() const { return expr.get_max_size(); }
+    Vector_storage get_storage() const { return expr.get_storage(); }
+    bool depends_on(const void* target) const { return _depends_on(expr, target); }
+
+    template<class Acc, class U>
+    void accumulate(Acc& acc, const Linear_scale<U>& scale) const{
+        _accumulate(expr, acc, scale.negated());
+    }
+};
+
+// expr * scalar
+template<class E, class S>
+class Vector_scaled: public Vector_expression<Vector_scaled<E, S>>{
+private:
+    vector_operand_t<E> expr;
+    S scalar;
+public:
+    using value_type = typename E::value_type;
+
+    Vector_scaled(const E& _expr, const S& _scalar): expr(_expr), scalar(_scalar) {};
+
+    int get_max_size() const { return expr.get_max_size(); }
+    Vector_storage get_storage() const { return expr.get_storage(); }
+    bool depends_on(const void* target) const { return _depends_on(expr, target); }
+
+    template<class Acc, class U>
+    void accumulate(Acc& acc, const Linear_scale<U>& scale) const{
+        U factor = scale.factor ? *scale.factor * U(scalar) : U(scalar);
+        _accumulate(expr, acc, Linear_scale<U>{scale.negative, &factor});
+    }
+};
+
+// vector (1xM) * matrix (MxN): linear combination of matrix rows
+template<class V, class M>
+class Vector_matrix_product: public Vector_expression<Vector_matrix_product<V, M>>{
+private:
+    vector_operand_t<V> vec;
+    matrix_operand_t<M> matrix;
+public:
+    using value_type = typename V::value_type;
+
+    Vector_matrix_product(const V& _vec, const M& _matrix): vec(_vec), matrix(_matrix) {};
+
+    int get_max_size() const { return matrix.get_columns_number(); }
+    Vector_storage get_storage() const { return vec.get_storage(); }
+    bool depends_on(const void* target) const { return _depends_on(vec, target); }
+
+    template<class Acc, class U>
+    void accumulate(Acc& acc, const Linear_scale<U>& scale) const{
+        using T = value_type;
+        Matrix_csr<typename M::value_type> csr(_materialize_matrix(matrix));
+        const std::vector<int>& row_ptr = csr.get_row_ptr();
+        const std::vector<int>& col_idx = csr.get_col_idx();
+
+        const auto& x = _materialize_vector(vec);     // temporary (if any) lives until return
+
+        std::vector<T> dense(get_max_size(), T((long) 0));
+        std::vector<char> touched(get_max_size(), false);
+        x.for_each_value([&](int idx, const T& val){
+            for (int k = row_ptr[idx]; k < row_ptr[idx + 1]; k++){
+                dense[col_idx[k]] += val * csr.get_vals()[k];
+                touched[col_idx[k]] = true;
+            }
+        });
+        if constexpr (std::is_same<Acc, std::vector<U>>::value){
+            for (int j = 0; j < get_max_size(); j++){
+                if (touched[j]) scale.add_to(acc[j], dense[j]);
+            }
+        } else {
+            auto hint = acc.begin();
+            for (int j = 0; j < get_max_size(); j++){
+                if (!touched[j]) continue;
+                hint = acc.try_emplace(hint, j, U((long) 0));
+                scale.add_to(hint->second, dense[j]);
+                hint++;
+            }
+        }
+    }
+};
+
+// matrix (NxM) * vector (Mx1): vector is column
+template<class M, class V>
+class Matrix_vector_product: public Vector_expression<Matrix_vector_product<M, V>>{
+private:
+    matrix_operand_t<M> matrix;
+    vector_operand_t<V> vec;
+public:
+    using value_type = typename M::value_type;
+
+    Matrix_vector_product(const M& _matrix, const V& _vec): matrix(_matrix), vec(_vec) {};
+
+    int get_max_size() const { return matrix.get_rows_number(); }
+    Vector_storage get_storage() const { return vec.get_storage(); }
+    bool depends_on(const void* target) const { return _depends_on(vec, target); }
+
+    template<class Acc, class U>
+    void accumulate(Acc& acc, const Linear_scale<U>& scale) const{
+        using T = value_type;
+        Matrix_csr<T> csr(_materialize_matrix(matrix));
+        const std::vector<int>& row_ptr = csr.get_row_ptr();
+        const std::vector<int>& col_idx = csr.get_col_idx();
+        const std::vector<T>& vals = csr.get_vals();
+
+        const auto& x = _materialize_vector(vec);
+        const auto dense = x.to_dense();
+        auto hint = acc.begin();
+        for (int i = 0; i < get_max_size(); i++){
+            if (row_ptr[i] == row_ptr[i + 1]) continue;
+            T sum((long) 0);
+            for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+                sum += vals[k] * dense[col_idx[k]];
+            }
+            if constexpr (std::is_same<Acc, std::vector<U>>::value){
+                scale.add_to(acc[i], sum);
+            } else {
+                hint = acc.try_emplace(hint, i, U((long) 0));
+                scale.add_to(hint->second, sum);
+                hint++;
+            }
+        }
+    }
+};
+
+//////////////////////////////////
+
+// Evaluation
+//////////////////////////////////
+
+template<class E>
+struct is_vector_sum: std::false_type {};
+
+template<class L, class R>
+struct is_vector_sum<Vector_sum<L, R>>: std::true_type {};
+
+/**
+ * @brief Values of expression (eps filter is not applied)
+ *
+ * Fused kernel for y + expr, expr + y, y - expr (y is vector): result starts as copy of y,
+ * so x * A + y (gemv) and x * alpha + y (axpy) are computed in one pass over x.
+ */
+template<class T, class E>
+vect_vals<T> _evaluate_vector_expression(const E& expr){
+    vect_vals<T> acc;
+    Linear_scale<T> unit;
+    if constexpr (is_vector_sum<E>::value){
+        using L = std::decay_t<decltype(expr.get_lhs())>;
+        using R = std::decay_t<decltype(expr.get_rhs())>;
+        if constexpr (std::is_same<L, Vector<T>>::value){
+            acc = _vector_values(expr.get_lhs());
+            _accumulate(expr.get_rhs(), acc, expr.is_subtraction() ? unit.negated() : unit);
+            return acc;
+        } else if constexpr (std::is_same<R, Vector<T>>::value){
+            if (!expr.is_subtraction()){
+                acc = _vector_values(expr.get_rhs());
+                _accumulate(expr.get_lhs(), acc, unit);
+                return acc;
+            }
+        }
+    }
+    _accumulate(expr, acc, unit);
+    return acc;
+}
+
+// Values of expression as dense array of max_size values (same fused kernels)
+template<class T, class E>
+std::vector<T> _evaluate_vector_expression_dense(const E& expr){
+    Linear_scale<T> unit;
+    if constexpr (is_vector_sum<E>::value){
+        using L = std::decay_t<decltype(expr.get_lhs())>;
+        using R = std::decay_t<decltype(expr.get_rhs())>;
+        if constexpr (std::is_same<L, Vector<T>>::value){
+            std::vector<T> acc = expr.get_lhs().to_dense();
+            _accumulate(expr.get_rhs(), acc, expr.is_subtraction() ? unit.negated() : unit);
+            return acc;
+        } else if constexpr (std::is_same<R, Vector<T>>::value){
+            if (!expr.is_subtraction()){
+                std::vector<T> acc = expr.get_rhs().to_dense();
+                _accumulate(expr.get_lhs(), acc, unit);
+                return acc;
+            }
+        }
+    }
+    std::vector<T> acc(expr.get_max_size(), T((long) 0));
+    _accumulate(expr, acc, unit);
+    return acc;
+}
+
+//////////////////////////////////
+
+// Operators
+//////////////////////////////////
+
+template<class L, class R, class = std::enable_if_t<is_vector_operand_v<L> && is_vector_operand_v<R>>>
+Vector_sum<L, R> operator+(const L& lhs, const R& rhs){
+    if (lhs.get_max_size() != rhs.get_max_size()){
+        throw Shape_error("Wrong shapes for operator '+': ", lhs.get_max_size(), rhs.get_max_size());
+    }
+    return Vector_sum<L, R>(lhs, rhs, false);
+}
+
+template<class L, class R, class = std::enable_if_t<is_vector_operand_v<L> && is_vector_operand_v<R>>>
+Vector_sum<L, R> operator-(const L& lhs, const R& rhs){
+    if (lhs.get_max_size() != rhs.get_max_size()){
+        throw Shape_error("Wrong shapes for operator '-': ", lhs.get_max_size(), rhs.get_max_size());
+    }
+    return Vector_sum<L, R>(lhs, rhs, true);
+}
+
+template<class E, class = std::enable_if_t<is_vector_expression<E>::value>>
+Vector_negate<E> operator-(const E& expr){
+    return Vector_negate<E>(expr);
+}
+
+template<class E, class S, class = std::enable_if_t<is_vector_operand_v<E> && !is_vector_operand_v<S> &&
+                                                    std::is_convertible<S, typename E::value_type>::value>>
+Vector_scaled<E, S> operator*(const E& expr, const S& scalar){
+    return Vector_scaled<E, S>(expr, scalar);
+}
+
+// only vector(1xM) * matrix (MxN)
+template<class V, class M, class = std::enable_if_t<is_vector_operand_v<V> && is_matrix_operand_v<M>>>
+Vector_matrix_product<V, M> operator*(const V& vec, const M& matrix){
+    if (vec.get_max_size() != matrix.get_rows_number()){
+        std::pair<int, int> matr_shape(matrix.get_rows_number(), matrix.get_columns_number());
+        throw Shape_error("Wrong shapes for (vector * matrix): ", {1, vec.get_max_size()}, matr_shape);
+    }
+    return Vector_matrix_product<V, M>(vec, matrix);
+}
+
+// matrix (NxM) * column vector (Mx1)
+template<class M, class V, class = std::enable_if_t<is_matrix_operand_v<M> && is_vector_operand_v<V>>>
+Matrix_vector_product<M, V> operator*(const M& matrix, const V& vec){
+    if (matrix.get_columns_number() != vec.get_max_size()){
+        std::pair<int, int> matr_shape(matrix.get_rows_number(), matrix.get_columns_number());
+        throw Shape_error("Wrong shapes for (matrix * vector): ", matr_shape, {vec.get_max_size(), 1});
+    }
+    return Matrix_vector_product<M, V>(matrix, vec);
+}
+
+//////////////////////////////////
+
+#endif // __VectorExpressions_H__
@@ -0,0 +1,450 @@
+/**
+ * @file Vector_kernels.hpp
+ * @brief Dot products, norms and axpy for sparse Vector
+ */
+
+#ifndef __VectorKernels_H__
+#define __VectorKernels_H__
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+#include "ClassVector.hpp"
+#include "../matrix/Matrix_csr.hpp"
+#include "Vector_storage.hpp"
+#include "Vector_simd.hpp"
+#include "../complex/ClassComplex.h"
+#include "../complex/Scalar_functions.hpp"
+#include "../complex/Complex_array.hpp"
+#include "../parallel/Parallel.hpp"
+
+#include "../exceptions/CommonExceptions.hpp"
+
+// SIMD kernels read arrays of Complex_number<double> as interleaved doubles
+static_assert(sizeof(Complex_number<double>) == 2 * sizeof(double) &&
+              std::is_standard_layout<Complex_number<double>>::value,
+              "Complex_number<double> must be laid out as two doubles");
+
+// Kernels on arrays of stored values
+//////////////////////////////////
+
+// one side of sparse dot is galloped when it is this many times shorter than the other
+constexpr size_t gallop_ratio = 8;
+
+/**
+ * @brief sum of conj(x_i) * y_i over common indices of two sorted index arrays
+ *
+ * Arrays of similar length are merged linearly. If one array is much shorter, its indices are
+ * searched in the longer one by galloping from the last found position: O(m log(n / m))
+ * instead of O(m + n), e.g. for a few non-zeros against a filled vector.
+ */
+template<class T>
+T _sparse_dot(const int* x_idx, const T* x_vals, size_t nx, const int* y_idx, const T* y_vals, size_t ny){
+    T sum((long) 0);
+    if (nx * gallop_ratio < ny){
+        size_t j = 0;
+        for (size_t i = 0; i < nx && j < ny; i++){
+            j = _gallop(y_idx, j, ny, x_idx[i]);
+            if (j < ny && y_idx[j] == x_idx[i]) sum += conjugate(x_vals[i]) * y_vals[j];
+        }
+    } else if (ny * gallop_ratio < nx){
+        size_t i = 0;
+        for (size_t j = 0; j < ny && i < nx; j++){
+            i = _gallop(x_idx, i, nx, y_idx[j]);
+            if (i < nx && x_idx[i] == y_idx[j]) sum += conjugate(x_vals[i]) * y_vals[j];
+        }
+    } else {
+        size_t i = 0, j = 0;
+        while (i < nx && j < ny){
+            if (x_idx[i] < y_idx[j]){
+                i++;
+            } else if (y_idx[j] < x_idx[i]){
+                j++;
+            } else {
+                sum += conjugate(x_vals[i]) * y_vals[j];
+                i++;
+                j++;
+            }
+        }
+    }
+    return sum;
+}
+
+// sum of conj(x[k]) * y[k]
+template<class T>
+T _dense_dot(const T* x, const T* y, size_t n){
+    T sum((long) 0);
+    for (size_t k = 0; k < n; k++){
+        sum += conjugate(x[k]) * y[k];
+    }
+    return sum;
+}
+
+inline double _dense_dot(const double* x, const double* y, size_t n){
+    return simd_dot(x, y, n);
+}
+
+inline Complex_number<double> _dense_dot(const Complex_number<double>* x, const Complex_number<double>* y, size_t n){
+    double re, im;
+    simd_dot_complex(reinterpret_cast<const double*>(x), reinterpret_cast<const double*>(y), n, re, im);
+    return Complex_number<double>(re, im);
+}
+
+// sum of conj(vals[k]) * dense[idx[k]]
+template<class T>
+T _gather_dot(const int* idx, const T* vals, size_t n, const T* dense){
+    T sum((long) 0);
+    for (size_t k = 0; k < n; k++){
+        sum += conjugate(vals[k]) * dense[idx[k]];
+    }
+    return sum;
+}
+
+inline double _gather_dot(const int* idx, const double* vals, size_t n, const double* dense){
+    return simd_gather_dot(idx, vals, n, dense);
+}
+
+inline Complex_number<double> _gather_dot(const int* idx, const Complex_number<double>* vals, size_t n,
+                                          const Complex_number<double>* dense){
+    double re, im;
+    simd_gather_dot_complex(idx, reinterpret_cast<const double*>(vals), n,
+                            reinterpret_cast<const double*>(dense), re, im);
+    return Complex_number<double>(re, im);
+}
+
+template<class T>
+double _norm1(const T* vals, size_t n){
+    double sum = 0;
+    for (size_t k = 0; k < n; k++){
+        sum += magnitude(vals[k]);
+    }
+    return sum;
+}
+
+inline double _norm1(const double* vals, size_t n){
+    return simd_sum_abs(vals, n);
+}
+
+inline double _norm1(const Complex_number<double>* vals, size_t n){
+    return simd_sum_modules(reinterpret_cast<const double*>(vals), n);
+}
+
+// sum of |x_k|^2 (square of euclidean norm)
+template<class T>
+double _sum_squares(const T* vals, size_t n){
+    double sum = 0;
+    for (size_t k = 0; k < n; k++){
+        double tmp = magnitude(vals[k]);
+        sum += tmp * tmp;
+    }
+    return sum;
+}
+
+inline double _sum_squares(const double* vals, size_t n){
+    return simd_sum_squares(vals, n);
+}
+
+inline double _sum_squares(const Complex_number<double>* vals, size_t n){
+    return simd_sum_squares(reinterpret_cast<const double*>(vals), 2 * n);
+}
+
+template<class T>
+double _norm_inf(const T* vals, size_t n){
+    double res = 0;
+    for (size_t k = 0; k < n; k++){
+        res = std::max(res, magnitude(vals[k]));
+    }
+    return res;
+}
+
+inline double _norm_inf(const double* vals, size_t n){
+    return simd_max_abs(vals, n);
+}
+
+inline double _norm_inf(const Complex_number<double>* vals, size_t n){
+    return std::sqrt(simd_max_module_square(reinterpret_cast<const double*>(vals), n));
+}
+
+/**
+ * Reductions of long arrays: kernels above on chunks of default_parallel_policy().chunk
+ * elements in parallel, partial results are summed by fixed tree (see parallel_reduce),
+ * so results don't depend on number of threads.
+ */
+
+template<class T>
+T _parallel_dense_dot(const T* x, const T* y, size_t n){
+    return parallel_reduce(n, T((long) 0), [&](size_t begin, size_t end){
+        return _dense_dot(x + begin, y + begin, end - begin);
+    }, [](const T& a, const T& b){ return a + b; });
+}
+
+template<class T>
+T _parallel_gather_dot(const int* idx, const T* vals, size_t n, const T* dense){
+    return parallel_reduce(n, T((long) 0), [&](size_t begin, size_t end){
+        return _gather_dot(idx + begin, vals + begin, end - begin, dense);
+    }, [](const T& a, const T& b){ return a + b; });
+}
+
+template<class T>
+double _parallel_norm1(const T* vals, size_t n){
+    return parallel_reduce(n, 0.0, [&](size_t begin, size_t end){
+        return _norm1(vals + begin, end - begin);
+    }, [](double a, double b){ return a + b; });
+}
+
+template<class T>
+double _parallel_norm2(const T* vals, size_t n){
+    return std::sqrt(parallel_reduce(n, 0.0, [&](size_t begin, size_t end){
+        return _sum_squares(vals + begin, end - begin);
+    }, [](double a, double b){ return a + b; }));
+}
+
+template<class T>
+double _parallel_norm_inf(const T* vals, size_t n){
+    return parallel_reduce(n, 0.0, [&](size_t begin, size_t end){
+        return _norm_inf(vals + begin, end - begin);
+    }, [](double a, double b){ return std::max(a, b); });
+}
+
+//////////////////////////////////
+
+/**
+ * @brief Access to storage of Vector for kernels (friend of Vector).
+ *
+ * SORTED and DENSE vectors are read in place. Values of TREE vector are copied to scratch
+ * arrays first: one pass over the tree, then kernel works on contiguous memory.
+ * In-place update y += alpha * x is Vector::_add_scaled (also used by operator+=).
+ */
+struct Vector_kernels{
+    // non-zero elements as sorted arrays
+    template<class T>
+    static const Sorted_entries<T>& entries(const Vector<T>& vec, Sorted_entries<T>& scratch){
+        return vec._entries(scratch);
+    }
+
+    // stored values (with zeros for DENSE vector), for kernels which don't need indices
+    template<class T>
+    static const std::vector<T>& stored_values(const Vector<T>& vec, Sorted_entries<T>& scratch){
+        if (vec.storage == Vector_storage::DENSE){
+            return vec.dense_vals;
+        }
+        return vec._entries(scratch).vals;
+    }
+
+    // all max_size values for DENSE vector, nullptr for sparse
+    template<class T>
+    static const T* dense_data(const Vector<T>& vec){
+        return vec.storage == Vector_storage::DENSE ? vec.dense_vals.data() : nullptr;
+    }
+
+    template<class T>
+    static void axpy(const T& alpha, const Vector<T>& x, Vector<T>& y){
+        y._add_scaled(x, Linear_scale<T>{false, &alpha});
+    }
+};
+
+// Dot products
+//////////////////////////////////
+
+/**
+ * @brief sum of conj(x_i) * y_i over non-zero elements of both vectors
+ *
+ * Products with DENSE vector are computed in parallel for long vectors,
+ * merge of two sparse vectors is sequential.
+ *
+ * @throw Shape_error if max sizes differ
+ */
+template<class T>
+T dot(const Vector<T>& x, const Vector<T>& y){
+    if (x.get_max_size() != y.get_max_size()){
+        throw Shape_error("Wrong shapes for dot product: ", x.get_max_size(), y.get_max_size());
+    }
+    const T* x_dense = Vector_kernels::dense_data(x);
+    const T* y_dense = Vector_kernels::dense_data(y);
+    if (x_dense && y_dense){
+        return _parallel_dense_dot(x_dense, y_dense, x.get_max_size());
+    }
+    Sorted_entries<T> x_scratch, y_scratch;
+    if (y_dense){
+        const Sorted_entries<T>& xs = Vector_kernels::entries(x, x_scratch);
+        return _parallel_gather_dot(xs.indices.data(), xs.vals.data(), xs.size(), y_dense);
+    }
+    if (x_dense){
+        const Sorted_entries<T>& ys = Vector_kernels::entries(y, y_scratch);
+        return conjugate(_parallel_gather_dot(ys.indices.data(), ys.vals.data(), ys.size(), x_dense));
+    }
+    const Sorted_entries<T>& xs = Vector_kernels::entries(x, x_scratch);
+    const Sorted_entries<T>& ys = Vector_kernels::entries(y, y_scratch);
+    return _sparse_dot(xs.indices.data(), xs.vals.data(), xs.size(), ys.indices.data(), ys.vals.data(), ys.size());
+}
+
+/**
+ * @brief sum of conj(x_i) * y[i], work is proportional to non-zeros of sparse x
+ *
+ * @throw Shape_error if y.size() != x.get_max_size()
+ */
+template<class T>
+T dot(const Vector<T>& x, const std::vector<T>& y){
+    if (static_cast<size_t>(x.get_max_size()) != y.size()){
+        throw Shape_error("Wrong shapes for dot product: ", x.get_max_size(), (int) y.size());
+    }
+    if (const T* x_dense = Vector_kernels::dense_data(x)){
+        return _parallel_dense_dot(x_dense, y.data(), y.size());
+    }
+    Sorted_entries<T> scratch;
+    const Sorted_entries<T>& xs = Vector_kernels::entries(x, scratch);
+    return _parallel_gather_dot(xs.indices.data(), xs.vals.data(), xs.size(), y.data());
+}
+
+// sum of conj(x[i]) * y_i
+template<class T>
+T dot(const std::vector<T>& x, const Vector<T>& y){
+    return conjugate(dot(y, x));
+}
+
+//////////////////////////////////
+
+// Norms (modules of values are taken as double)
+//////////////////////////////////
+
+// sum of |x_i|
+template<class T>
+double norm1(const Vector<T>& x){
+    Sorted_entries<T> scratch;
+    const std::vector<T>& vals = Vector_kernels::stored_values(x, scratch);
+    return _parallel_norm1(vals.data(), vals.size());
+}
+
+// euclidean norm
+template<class T>
+double norm2(const Vector<T>& x){
+    Sorted_entries<T> scratch;
+    const std::vector<T>& vals = Vector_kernels::stored_values(x, scratch);
+    return _parallel_norm2(vals.data(), vals.size());
+}
+
+// max of |x_i|
+template<class T>
+double norm_inf(const Vector<T>& x){
+    Sorted_entries<T> scratch;
+    const std::vector<T>& vals = Vector_kernels::stored_values(x, scratch);
+    return _parallel_norm_inf(vals.data(), vals.size());
+}
+
+//////////////////////////////////
+
+/**
+ * @brief y += a * x in place
+ *
+ * TREE y: values of x are inserted with hints (indices are increasing).
+ * SORTED y: x is merged into arrays of y from the end, y is reallocated only if it grows.
+ * DENSE y (or DENSE x): values are added in place.
+ * Values which become less than eps are removed.
+ *
+ * @throw Shape_error if max sizes differ
+ */
+template<class T>
+void axpy(const T& a, const Vector<T>& x, Vector<T>& y){
+    if (x.get_max_size() != y.get_max_size()){
+        throw Shape_error("Wrong shapes for axpy: ", x.get_max_size(), y.get_max_size());
+    }
+    Vector_kernels::axpy(a, x, y);
+}
+
+// Matrix times block of vectors
+//////////////////////////////////
+
+/**
+ * @brief A * x for several column vectors at once (SpMM)
+ *
+ * Vectors are packed into one dense row-major block, so every element of A is read once
+ * for all of them (Matrix_csr::multiply_block) instead of once per vector.
+ *
+ * @throw Shape_error if size of some vector != columns of A
+ */
+template<class T>
+std::vector<Vector<T>> multiply(const Matrix_csr<T>& A, const std::vector<Vector<T>>& xs){
+    int count = xs.size();
+    int rows = A.get_rows_number(), columns = A.get_columns_number();
+    std::vector<T> x_block(static_cast<size_t>(columns) * count, T((long) 0));
+    for (int v = 0; v < count; v++){
+        if (xs[v].get_max_size() != columns){
+            throw Shape_error("Wrong shapes for (matrix * vector): ", {rows, columns}, {xs[v].get_max_size(), 1});
+        }
+        xs[v].for_each_value([&](int idx, const T& val){
+            x_block[static_cast<size_t>(idx) * count + v] = val;
+        });
+    }
+    std::vector<T> y_block(static_cast<size_t>(rows) * count);
+    A.multiply_block(x_block.data(), y_block.data(), count);
+
+    std::vector<Vector<T>> res;
+    res.reserve(count);
+    std::vector<T> column(rows);
+    for (int v = 0; v < count; v++){
+        for (int i = 0; i < rows; i++){
+            column[i] = y_block[static_cast<size_t>(i) * count + v];
+        }
+        res.emplace_back(column);
+    }
+    return res;
+}
+
+template<class T>
+std::vector<Vector<T>> multiply(const Matrix<T>& A, const std::vector<Vector<T>>& xs){
+    return multiply(Matrix_csr<T>(A), xs);
+}
+
+//////////////////////////////////
+
+// Complex vectors as split arrays (Complex_array)
+//////////////////////////////////
+
+// all max_size values of x
+template<class R>
+Complex_array<R> to_complex_array(const Vector<Complex_number<R>>& x){
+    Complex_array<R> res(x.get_max_size());
+    x.for_each_value([&res](int idx, const Complex_number<R>& val){
+        res.set(idx, val);
+    });
+    return res;
+}
+
+template<class R>
+Vector<Complex_number<R>> to_vector(const Complex_array<R>& x){
+    return Vector<Complex_number<R>>(x.to_vector());
+}
+
+/**
+ * @brief A * x for complex CSR matrix and split vector
+ *
+ * Values of A are split once, every row is a gather dot product of split arrays
+ * (vectorized for R = double), rows are processed in parallel for large matrices.
+ *
+ * @throw Shape_error if x.size() != columns of A
+ */
+template<class R>
+Complex_array<R> multiply(const Matrix_csr<Complex_number<R>>& A, const Complex_array<R>& x){
+    int rows = A.get_rows_number(), columns = A.get_columns_number();
+    if (x.size() != static_cast<size_t>(columns)){
+        throw Shape_error("Wrong shapes for (matrix * vector): ", {rows, columns}, {(int) x.size(), 1});
+    }
+    Complex_array<R> vals(A.get_vals());
+    const std::vector<int>& row_ptr = A.get_row_ptr();
+    const int* col_idx = A.get_col_idx().data();
+    Complex_array<R> res(rows);
+    parallel_for(rows, [&](size_t begin, size_t end){
+        for (size_t i = begin; i < end; i++){
+            size_t from = row_ptr[i], len = row_ptr[i + 1] - row_ptr[i];
+            res.set(i, _complex_gather_dot(col_idx + from, vals.real_data() + from, vals.imag_data() + from,
+                                           x.real_data(), x.imag_data(), len));
+        }
+    });
+    return res;
+}
+
+//////////////////////////////////
+
+#endif // __VectorKernels_H__
@@ -0,0 +1,283 @@
+/**
+ * @file Vector_simd.hpp
+ * @brief Vectorized BLAS-1 kernels on raw arrays of double and interleaved complex values
+ */
+
+#ifndef __VectorSimd_H__
+#define __VectorSimd_H__
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define TASK0_AVX2 1
+#endif
+
+// Kernels used by Vector_kernels.hpp for Vector<double> and Vector<Complex_number<double>>.
+// With AVX2 + FMA (build with -DTASK0_NATIVE=ON or -mavx2 -mfma) 4 doubles are processed
+// per instruction and gathered by index. Otherwise loops with 4 independent accumulators
+// are used: they break dependency chain of additions and are auto-vectorized by compiler.
+// Complex arrays are interleaved: re0, im0, re1, im1, ... (layout of Complex_number<double>).
+// Summation order differs from sequential loop, results may differ in last bits.
+
+#ifdef TASK0_AVX2
+inline double _simd_hsum(__m256d x){
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+inline double _simd_hmax(__m256d x){
+    __m128d res = _mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(res, _mm_unpackhi_pd(res, res)));
+}
+#endif
+
+// sum of x[k] * y[k]
+inline double simd_dot(const double* x, const double* y, size_t n){
+    size_t k = 0;
+    double acc[4] = {0, 0, 0, 0};
+#ifdef TASK0_AVX2
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; k + 8 <= n; k += 8){
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + k), _mm256_loadu_pd(y + k), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + k + 4), _mm256_loadu_pd(y + k + 4), acc1);
+    }
+    acc[0] = _simd_hsum(_mm256_add_pd(acc0, acc1));
+#endif
+    for (; k + 4 <= n; k += 4){
+        acc[0] += x[k] * y[k];
+        acc[1] += x[k + 1] * y[k + 1];
+        acc[2] += x[k + 2] * y[k + 2];
+        acc[3] += x[k + 3] * y[k + 3];
+    }
+    for (; k < n; k++){
+        acc[0] += x[k] * y[k];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// sum of conj(x[k]) * y[k] for n interleaved complex values, result in (re, im)
+inline void simd_dot_complex(const double* x, const double* y, size_t n, double& re, double& im){
+    // same scheme as in simd_gather_dot_complex
+    size_t k = 0;
+    double acc_re[2] = {0, 0}, acc_im[2] = {0, 0};
+#ifdef TASK0_AVX2
+    __m256d sum_re = _mm256_setzero_pd(), sum_im = _mm256_setzero_pd();
+    for (; k + 2 <= n; k += 2){
+        __m256d a = _mm256_loadu_pd(x + 2 * k);
+        __m256d b = _mm256_loadu_pd(y + 2 * k);
+        sum_re = _mm256_fmadd_pd(a, b, sum_re);
+        sum_im = _mm256_fmadd_pd(a, _mm256_permute_pd(b, 0x5), sum_im);
+    }
+    alignas(32) double lanes_re[4], lanes_im[4];
+    _mm256_store_pd(lanes_re, sum_re);
+    _mm256_store_pd(lanes_im, sum_im);
+    acc_re[0] = lanes_re[0] + lanes_re[2];
+    acc_re[1] = lanes_re[1] + lanes_re[3];
+    acc_im[0] = lanes_im[0] + lanes_im[2];
+    acc_im[1] = lanes_im[1] + lanes_im[3];
+#endif
+    for (; k < n; k++){
+        const double* a = x + 2 * k;
+        const double* b = y + 2 * k;
+        acc_re[0] += a[0] * b[0];
+        acc_re[1] += a[1] * b[1];
+        acc_im[0] += a[0] * b[1];
+        acc_im[1] += a[1] * b[0];
+    }
+    re = acc_re[0] + acc_re[1];
+    im = acc_im[0] - acc_im[1];
+}
+
+// sum of x[k] * y[idx[k]]
+inline double simd_gather_dot(const int* idx, const double* x, size_t n, const double* y){
+    size_t k = 0;
+    double acc[4] = {0, 0, 0, 0};
+#ifdef TASK0_AVX2
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; k + 8 <= n; k += 8){
+        __m128i i0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + k));
+        __m128i i1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + k + 4));
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + k), _mm256_i32gather_pd(y, i0, 8), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + k + 4), _mm256_i32gather_pd(y, i1, 8), acc1);
+    }
+    acc[0] = _simd_hsum(_mm256_add_pd(acc0, acc1));
+#endif
+    for (; k + 4 <= n; k += 4){
+        acc[0] += x[k] * y[idx[k]];
+        acc[1] += x[k + 1] * y[idx[k + 1]];
+        acc[2] += x[k + 2] * y[idx[k + 2]];
+        acc[3] += x[k + 3] * y[idx[k + 3]];
+    }
+    for (; k < n; k++){
+        acc[0] += x[k] * y[idx[k]];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// sum of conj(x[k]) * y[idx[k]] for complex arrays, result in (re, im)
+inline void simd_gather_dot_complex(const int* idx, const double* x, size_t n, const double* y,
+                                    double& re, double& im){
+    // conj(a) * b = (ar * br + ai * bi) + i * (ar * bi - ai * br):
+    // acc_re accumulates (ar * br, ai * bi), acc_im accumulates (ar * bi, ai * br)
+    size_t k = 0;
+    double acc_re[2] = {0, 0}, acc_im[2] = {0, 0};
+#ifdef TASK0_AVX2
+    __m256d sum_re = _mm256_setzero_pd(), sum_im = _mm256_setzero_pd();
+    for (; k + 2 <= n; k += 2){
+        __m256d a = _mm256_loadu_pd(x + 2 * k);
+        __m256d b = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(y + 2 * idx[k])),
+                                         _mm_loadu_pd(y + 2 * idx[k + 1]), 1);
+        sum_re = _mm256_fmadd_pd(a, b, sum_re);
+        sum_im = _mm256_fmadd_pd(a, _mm256_permute_pd(b, 0x5), sum_im);
+    }
+    alignas(32) double lanes_re[4], lanes_im[4];
+    _mm256_store_pd(lanes_re, sum_re);
+    _mm256_store_pd(lanes_im, sum_im);
+    acc_re[0] = lanes_re[0] + lanes_re[2];
+    acc_re[1] = lanes_re[1] + lanes_re[3];
+    acc_im[0] = lanes_im[0] + lanes_im[2];
+    acc_im[1] = lanes_im[1] + lanes_im[3];
+#endif
+    for (; k < n; k++){
+        const double* a = x + 2 * k;
+        const double* b = y + 2 * idx[k];
+        acc_re[0] += a[0] * b[0];
+        acc_re[1] += a[1] * b[1];
+        acc_im[0] += a[0] * b[1];
+        acc_im[1] += a[1] * b[0];
+    }
+    re = acc_re[0] + acc_re[1];
+    im = acc_im[0] - acc_im[1];
+}
+
+// sum of |x[k]|
+inline double simd_sum_abs(const double* x, size_t n){
+    size_t k = 0;
+    double acc[4] = {0, 0, 0, 0};
+#ifdef TASK0_AVX2
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; k + 8 <= n; k += 8){
+        acc0 = _mm256_add_pd(acc0, _mm256_andnot_pd(sign, _mm256_loadu_pd(x + k)));
+        acc1 = _mm256_add_pd(acc1, _mm256_andnot_pd(sign, _mm256_loadu_pd(x + k + 4)));
+    }
+    acc[0] = _simd_hsum(_mm256_add_pd(acc0, acc1));
+#endif
+    for (; k + 4 <= n; k += 4){
+        acc[0] += std::fabs(x[k]);
+        acc[1] += std::fabs(x[k + 1]);
+        acc[2] += std::fabs(x[k + 2]);
+        acc[3] += std::fabs(x[k + 3]);
+    }
+    for (; k < n; k++){
+        acc[0] += std::fabs(x[k]);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// sum of x[k]^2 (also squared norm of complex array of n / 2 elements)
+inline double simd_sum_squares(const double* x, size_t n){
+    size_t k = 0;
+    double acc[4] = {0, 0, 0, 0};
+#ifdef TASK0_AVX2
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; k + 8 <= n; k += 8){
+        __m256d a = _mm256_loadu_pd(x + k);
+        __m256d b = _mm256_loadu_pd(x + k + 4);
+        acc0 = _mm256_fmadd_pd(a, a, acc0);
+        acc1 = _mm256_fmadd_pd(b, b, acc1);
+    }
+    acc[0] = _simd_hsum(_mm256_add_pd(acc0, acc1));
+#endif
+    for (; k + 4 <= n; k += 4){
+        acc[0] += x[k] * x[k];
+        acc[1] += x[k + 1] * x[k + 1];
+        acc[2] += x[k + 2] * x[k + 2];
+        acc[3] += x[k + 3] * x[k + 3];
+    }
+    for (; k < n; k++){
+        acc[0] += x[k] * x[k];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// max of |x[k]|, 0 for empty array
+inline double simd_max_abs(const double* x, size_t n){
+    size_t k = 0;
+    double res[4] = {0, 0, 0, 0};
+#ifdef TASK0_AVX2
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d max0 = _mm256_setzero_pd();
+    for (; k + 4 <= n; k += 4){
+        max0 = _mm256_max_pd(max0, _mm256_andnot_pd(sign, _mm256_loadu_pd(x + k)));
+    }
+    res[0] = _simd_hmax(max0);
+#endif
+    for (; k + 4 <= n; k += 4){
+        res[0] = std::max(res[0], std::fabs(x[k]));
+        res[1] = std::max(res[1], std::fabs(x[k + 1]));
+        res[2] = std::max(res[2], std::fabs(x[k + 2]));
+        res[3] = std::max(res[3], std::fabs(x[k + 3]));
+    }
+    for (; k < n; k++){
+        res[0] = std::max(res[0], std::fabs(x[k]));
+    }
+    return std::max(std::max(res[0], res[1]), std::max(res[2], res[3]));
+}
+
+// sum of modules of n interleaved complex values
+inline double simd_sum_modules(const double* x, size_t n){
+    size_t k = 0;
+    double acc[2] = {0, 0};
+#ifdef TASK0_AVX2
+    __m256d acc0 = _mm256_setzero_pd();
+    for (; k + 4 <= n; k += 4){
+        __m256d a = _mm256_loadu_pd(x + 2 * k);
+        __m256d b = _mm256_loadu_pd(x + 2 * k + 4);
+        // (re0^2 + im0^2, re2^2 + im2^2, re1^2 + im1^2, re3^2 + im3^2), order doesn't matter for sum
+        __m256d squares = _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+        acc0 = _mm256_add_pd(acc0, _mm256_sqrt_pd(squares));
+    }
+    acc[0] = _simd_hsum(acc0);
+#endif
+    for (; k + 2 <= n; k += 2){
+        const double* a = x + 2 * k;
+        acc[0] += std::sqrt(a[0] * a[0] + a[1] * a[1]);
+        acc[1] += std::sqrt(a[2] * a[2] + a[3] * a[3]);
+    }
+    for (; k < n; k++){
+        const double* a = x + 2 * k;
+        acc[0] += std::sqrt(a[0] * a[0] + a[1] * a[1]);
+    }
+    return acc[0] + acc[1];
+}
+
+// max of squared modules of n interleaved complex values, 0 for empty array
+inline double simd_max_module_square(const double* x, size_t n){
+    size_t k = 0;
+    double res[2] = {0, 0};
+#ifdef TASK0_AVX2
+    __m256d max0 = _mm256_setzero_pd();
+    for (; k + 4 <= n; k += 4){
+        __m256d a = _mm256_loadu_pd(x + 2 * k);
+        __m256d b = _mm256_loadu_pd(x + 2 * k + 4);
+        max0 = _mm256_max_pd(max0, _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b)));
+    }
+    res[0] = _simd_hmax(max0);
+#endif
+    for (; k + 2 <= n; k += 2){
+        const double* a = x + 2 * k;
+        res[0] = std::max(res[0], a[0] * a[0] + a[1] * a[1]);
+        res[1] = std::max(res[1], a[2] * a[2] + a[3] * a[3]);
+    }
+    for (; k < n; k++){
+        const double* a = x + 2 * k;
+        res[0] = std::max(res[0], a[0] * a[0] + a[1] * a[1]);
+    }
+    return std::max(res[0], res[1]);
+}
+
+#endif // __VectorSimd_H__
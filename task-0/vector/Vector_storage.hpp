@@ -0,0 +1,164 @@
+/**
+ * @file Vector_storage.hpp
+ * @brief Storage modes of Vector and sorted struct-of-arrays storage
+ */
+
+#ifndef __VectorStorage_H__
+#define __VectorStorage_H__
+
+#include <vector>
+#include <algorithm>
+
+#include "../parallel/Parallel.hpp"
+#include "../stats/Stats.hpp"
+
+enum class Vector_storage {
+    TREE,       // std::map: cheap insertion at random positions (building)
+    SORTED,     // sorted arrays of indices and values: cheap scans, merges and point lookup (reading)
+    DENSE,      // array of all max_size values (zeros included): vectors with most elements non-zero
+};
+
+// first position in [from, n) with idx[pos] >= target (exponential, then binary search)
+inline size_t _gallop(const int* idx, size_t from, size_t n, int target){
+    size_t step = 1, lo = from, hi = from;
+    while (hi < n && idx[hi] < target){
+        lo = hi + 1;
+        hi = from + step;
+        step *= 2;
+    }
+    return std::lower_bound(idx + lo, idx + std::min(hi, n), target) - idx;
+}
+
+/**
+ * @brief Non-zero elements as two parallel arrays sorted by index.
+ *
+ * Contiguous arrays are scanned without pointer chasing (one tree node per element in
+ * std::map), binary search gives O(log nnz) point access and two vectors are added
+ * by linear merge. Insertion of new index shifts the tail: O(nnz).
+ */
+template<class T>
+struct Sorted_entries{
+    std::vector<int> indices;   // strictly increasing
+    std::vector<T> vals;
+
+    size_t size() const{
+        return indices.size();
+    }
+
+    void clear(){
+        indices.clear();
+        vals.clear();
+    }
+
+    // position of idx or -1
+    long find(int idx) const{
+        auto it = std::lower_bound(indices.begin(), indices.end(), idx);
+        if (it == indices.end() || *it != idx) return -1;
+        return it - indices.begin();
+    }
+
+    // value at idx, zero value is inserted if idx is missing
+    T& get_or_insert(int idx){
+        auto it = std::lower_bound(indices.begin(), indices.end(), idx);
+        size_t pos = it - indices.begin();
+        if (it == indices.end() || *it != idx){
+            TASK0_STAT(FAKE_INSERTS, 1);
+            TASK0_STAT(BYTES_MOVED, (indices.size() - pos) * (sizeof(int) + sizeof(T)));
+            indices.insert(it, idx);
+            vals.insert(vals.begin() + pos, T((long) 0));
+        }
+        return vals[pos];
+    }
+
+    // idx must be greater than all stored indices
+    void push_back(int idx, const T& val){
+        indices.push_back(idx);
+        vals.push_back(val);
+    }
+
+    /**
+     * @brief remove elements with pred(value) == true keeping order
+     *
+     * Long arrays are compacted in parallel (pred must be thread-safe): kept elements are
+     * counted per chunk, offsets of chunks are prefix sums of counts and chunks are copied
+     * to new arrays independently. Arrays are not touched if nothing is removed.
+     */
+    template<class Pred>
+    void erase_if(Pred pred, const Parallel_policy& policy = default_parallel_policy()){
+        size_t n = indices.size();
+        if (n < policy.min_size){
+            _erase_if_sequential(pred);
+            return;
+        }
+        size_t chunk = std::max<size_t>(policy.chunk, 1);
+        size_t chunks = (n + chunk - 1) / chunk;
+        std::vector<size_t> offsets(chunks + 1, 0);
+        Thread_pool::instance().run(chunks, policy.threads, [&](size_t c){
+            size_t kept = 0;
+            for (size_t k = c * chunk; k < std::min(n, (c + 1) * chunk); k++){
+                if (!pred(vals[k])) kept++;
+            }
+            offsets[c + 1] = kept;
+        });
+        for (size_t c = 0; c < chunks; c++){
+            offsets[c + 1] += offsets[c];
+        }
+        if (offsets[chunks] == n) return;
+
+        TASK0_STAT(ALLOCATIONS, 2);
+        TASK0_STAT(BYTES_MOVED, offsets[chunks] * (sizeof(int) + sizeof(T)));
+        std::vector<int> new_indices(offsets[chunks]);
+        std::vector<T> new_vals(offsets[chunks]);
+        Thread_pool::instance().run(chunks, policy.threads, [&](size_t c){
+            size_t pos = offsets[c];
+            for (size_t k = c * chunk; k < std::min(n, (c + 1) * chunk); k++){
+                if (pred(vals[k])) continue;
+                new_indices[pos] = indices[k];
+                new_vals[pos] = std::move(vals[k]);
+                pos++;
+            }
+        });
+        indices.swap(new_indices);
+        vals.swap(new_vals);
+    }
+
+    template<class Pred>
+    void _erase_if_sequential(Pred pred){
+        size_t kept = 0;
+        for (size_t k = 0; k < indices.size(); k++){
+            if (pred(vals[k])) continue;
+            if (kept != k){
+                indices[kept] = indices[k];
+                vals[kept] = std::move(vals[k]);
+            }
+            kept++;
+        }
+        indices.resize(kept);
+        vals.resize(kept);
+    }
+
+    // res = lhs + rhs (or lhs - rhs) by linear merge of indices
+    template<class U>
+    static void merge(const Sorted_entries<T>& lhs, const Sorted_entries<U>& rhs, bool subtract,
+                      Sorted_entries<T>& res){
+        res.clear();
+        res.indices.reserve(lhs.size() + rhs.size());
+        res.vals.reserve(lhs.size() + rhs.size());
+        size_t i = 0, j = 0;
+        while (i < lhs.size() || j < rhs.size()){
+            if (j == rhs.size() || (i < lhs.size() && lhs.indices[i] < rhs.indices[j])){
+                res.push_back(lhs.indices[i], lhs.vals[i]);
+                i++;
+            } else if (i == lhs.size() || rhs.indices[j] < lhs.indices[i]){
+                res.push_back(rhs.indices[j], subtract ? T((long) 0) - rhs.vals[j] : T(rhs.vals[j]));
+                j++;
+            } else {
+                res.push_back(lhs.indices[i], subtract ? lhs.vals[i] - rhs.vals[j] : lhs.vals[i] + rhs.vals[j]);
+                i++;
+                j++;
+            }
+        }
+    }
+};
+
+#endif // __VectorStorage_H__